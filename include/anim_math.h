@@ -0,0 +1,83 @@
+#pragma once
+#ifndef ANIM_MATH_H
+#define ANIM_MATH_H
+
+#include <cstddef>
+
+// Fast polynomial approximations for per-frame animation. Error bounds are the worst
+// case measured over the stated input range (see runAnimMathBenchmark):
+//   fastSin / fastCos     |error| < 1e-7          for |x| <= 8192
+//   fastAtan2             |error| < 3e-7 rad      any finite input; signed zeros as std::atan2
+//                         ((+-0, -0) -> +-pi, (+-0, +0) -> +-0)
+//   fastExp2              relative error < 1e-7   for -126 <= x <= 127 (clamped outside)
+//   fastLog2              |error| < 1e-7 * max(1, |log2 x|) for normal x > 0: absolute for
+//                         0.5 <= x <= 2, relative elsewhere (up to 4e-6 absolute near the
+//                         ends of the float range)
+//   fastPow               relative error < 8e-6   for base > 0, |exponent * log2(base)| <= 126;
+//                         non-positive bases return 0
+// The array versions run 8 (AVX2) or 4 (SSE) values per instruction and match the
+// scalar functions.
+
+float fastSin(float x);
+float fastCos(float x);
+void fastSinCos(float x, float& sine, float& cosine);
+float fastAtan2(float y, float x);
+float fastExp2(float x);
+float fastLog2(float x);
+float fastPow(float base, float exponent);
+
+void sinArray(const float* x, float* out, size_t count);
+void cosArray(const float* x, float* out, size_t count);
+void sinCosArray(const float* x, float* sines, float* cosines, size_t count);
+void atan2Array(const float* y, const float* x, float* out, size_t count);
+void exp2Array(const float* x, float* out, size_t count);
+void powArray(const float* base, const float* exponent, float* out, size_t count);
+
+// Evaluates sin/cos(start + k * step) for k = 0, 1, 2, ... by rotating a unit vector
+// instead of calling sin/cos each step: four multiplies per advance() instead of two
+// polynomial evaluations. Every 16 steps the vector is renormalized so long series do
+// not drift; the error grows by less than 1e-8 per step.
+class PhaseSeries {
+public:
+    PhaseSeries(float start, float step) : steps(0) {
+        fastSinCos(start, s, c);
+        fastSinCos(step, stepSin, stepCos);
+    }
+
+    float sin() const { return s; }
+    float cos() const { return c; }
+
+    void advance() {
+        float nextS = s * stepCos + c * stepSin;
+        float nextC = c * stepCos - s * stepSin;
+        s = nextS;
+        c = nextC;
+
+        if ((++steps & 15) == 0) {
+            // First-order renormalization pulls the vector back onto the unit circle
+            float correction = 1.5f - 0.5f * (s * s + c * c);
+            s *= correction;
+            c *= correction;
+        }
+    }
+
+private:
+    float s, c;
+    float stepSin, stepCos;
+    unsigned int steps;
+};
+
+// Geometric series base^k for k = 0, 1, 2, ... (replaces pow(base, k) in loops)
+class GeometricSeries {
+public:
+    GeometricSeries(float start, float factor) : value(start), ratio(factor) {}
+
+    float get() const { return value; }
+    void advance() { value *= ratio; }
+
+private:
+    float value;
+    float ratio;
+};
+
+#endif // ANIM_MATH_H
@@ -73,6 +73,14 @@ public:
             Position -= Up * velocity;
     }
 
+    // Points the camera along a new front vector (e.g. one transported by the geodesic camera)
+    void SetFront(const glm::vec3& front) {
+        Pitch = glm::degrees(asin(glm::clamp(front.y, -1.0f, 1.0f)));
+        Pitch = glm::clamp(Pitch, -89.0f, 89.0f);
+        Yaw = glm::degrees(atan2(front.z, front.x));
+        updateCameraVectors();
+    }
+
     // Processes input received from a mouse input system. Expects the offset value in both the x and y direction.
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true) {
         xoffset *= MouseSensitivity;
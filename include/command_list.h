@@ -0,0 +1,162 @@
+#pragma once
+#ifndef COMMAND_LIST_H
+#define COMMAND_LIST_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "shader.h"
+#include "render_queue.h"
+
+// Camera data that differs between the main view and each portal view. Every program
+// used by a command list gets these as its "view", "projection" and "viewPos" uniforms.
+struct ViewParams {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos;
+};
+
+// Records the draws of one frame's scene once so every view can replay them. A draw
+// captures program, VAO, vertex/instance range, polygon mode and the value every uniform
+// of its program had when it was recorded, so views may replay the draws in any order.
+// Uniforms are written with glProgramUniform*, so they don't depend on which program is
+// bound. Recording happens on the GL thread (uniform locations are looked up there and
+// cached across frames).
+class CommandList {
+public:
+    enum UniformType {
+        UNIFORM_INT,
+        UNIFORM_FLOAT,
+        UNIFORM_VEC3,
+        UNIFORM_VEC4,
+        UNIFORM_MAT4
+    };
+
+    struct UniformCommand {
+        unsigned int program;
+        GLint location;
+        UniformType type;
+        float values[16];
+    };
+
+    struct DrawCommand {
+        unsigned int program;
+        unsigned int vao;
+        GLenum primitive;
+        bool indexed;               // 16-bit indices from the VAO's element buffer
+        GLint first;                // First vertex, or first index when indexed
+        GLsizei count;
+        GLint baseVertex;
+        GLsizei instanceCount;  // 0 = non-instanced glDrawArrays
+        unsigned int feedback;      // Transform feedback object whose capture is drawn, or 0
+        GLenum polygonMode;
+        unsigned int viewBinding;   // Also the program's sort index
+        unsigned int material;      // Sort index of the VAO
+        bool hasCenter;
+        glm::vec3 center;           // World-space point used for depth sorting
+        unsigned int uniformBegin;  // Range in getDrawUniforms()
+        unsigned int uniformCount;
+    };
+
+    // Locations of the view-dependent uniforms of one program (-1 when unused)
+    struct ViewBinding {
+        unsigned int program;
+        GLint view;
+        GLint projection;
+        GLint viewPos;
+    };
+
+    // Drop the recorded draws; cached uniform locations are kept
+    void reset();
+
+    // Uniforms stay set for every later draw of their program, as with glUniform*
+    void setInt(const Shader& shader, const std::string& name, int value);
+    void setBool(const Shader& shader, const std::string& name, bool value);
+    void setFloat(const Shader& shader, const std::string& name, float value);
+    void setVec3(const Shader& shader, const std::string& name, const glm::vec3& value);
+    void setVec4(const Shader& shader, const std::string& name, const glm::vec4& value);
+    void setMat4(const Shader& shader, const std::string& name, const glm::mat4& value);
+
+    void draw(const Shader& shader, unsigned int vao, GLenum primitive, GLint first, GLsizei count,
+        GLsizei instanceCount = 0, GLenum polygonMode = GL_FILL);
+    void drawIndexed(const Shader& shader, unsigned int vao, GLenum primitive, GLint firstIndex, GLsizei indexCount,
+        GLint baseVertex, GLsizei instanceCount = 0, GLenum polygonMode = GL_FILL);
+
+    // Draw whatever the transform feedback object captured last, as many vertices as it
+    // wrote; the count never comes back to the CPU
+    void drawFeedback(const Shader& shader, unsigned int vao, GLenum primitive, unsigned int feedback,
+        GLenum polygonMode = GL_FILL);
+
+    // Depth-sort the next draw by this world-space point; draws without one sort first
+    void setDepthCenter(const glm::vec3& center);
+
+    size_t getDrawCount() const { return draws.size(); }
+    const std::vector<DrawCommand>& getDraws() const { return draws; }
+    const std::vector<UniformCommand>& getUniforms() const { return uniforms; }
+    const std::vector<unsigned int>& getDrawUniforms() const { return drawUniforms; }
+    const ViewBinding& getViewBinding(unsigned int index) const { return viewBindings[index]; }
+
+private:
+    // Latest write to one uniform location
+    struct LiveUniform {
+        unsigned int program;
+        GLint location;
+        unsigned int index;
+    };
+
+    std::vector<DrawCommand> draws;
+    std::vector<UniformCommand> uniforms;
+    std::vector<unsigned int> drawUniforms;  // Uniform indices each draw needs, by draw
+    std::vector<LiveUniform> liveUniforms;
+    std::vector<unsigned int> materials;     // VAOs in order of first use
+    bool pendingHasCenter = false;
+    glm::vec3 pendingCenter;
+
+    std::vector<ViewBinding> viewBindings;
+    std::map<std::pair<unsigned int, std::string>, GLint> locationCache;
+
+    GLint locate(unsigned int program, const std::string& name);
+    unsigned int findViewBinding(unsigned int program);
+    void pushUniform(const Shader& shader, const std::string& name, UniformType type, const float* values, int count);
+};
+
+// One view's replay of a CommandList: the recorded draws sorted by RenderQueue key for
+// this view, with redundant program, VAO, polygon mode and uniform changes removed and
+// the view uniforms bound once per program. build() only reads the source list, so the
+// lists of several views can be built on separate threads; execute() issues the GL calls
+// on the GL thread.
+class ViewCommandList {
+public:
+    ViewCommandList() : source(nullptr) {}
+
+    void build(const CommandList& commands, const ViewParams& viewParams);
+    void execute() const;
+
+    size_t getOpCount() const { return ops.size(); }
+    const ViewParams& getParams() const { return params; }
+
+private:
+    enum OpType {
+        OP_PROGRAM,       // value = program
+        OP_VIEW,          // value = view binding index
+        OP_VAO,           // value = VAO
+        OP_POLYGON_MODE,  // value = GL_FILL / GL_LINE
+        OP_UNIFORM,       // value = uniform index
+        OP_DRAW           // value = draw index
+    };
+
+    struct Op {
+        OpType type;
+        unsigned int value;
+    };
+
+    const CommandList* source;
+    ViewParams params;
+    std::vector<Op> ops;
+    RenderQueue queue;
+};
+
+#endif // COMMAND_LIST_H
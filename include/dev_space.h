@@ -0,0 +1,44 @@
+#pragma once
+#ifndef DEV_SPACE_H
+#define DEV_SPACE_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "command_list.h"
+#include "mesh_library.h"
+#include "shader.h"
+
+// The development space objects (grid cubes, bent walls and orbiting cubes of areas A
+// and B). Each object is a static instance record; v_dev_space.glsl derives its model
+// matrix from the record plus the time and nonEuclideanFactor uniforms, so the whole
+// space is one instanced draw and its animation costs no CPU time.
+class DevSpace {
+public:
+    DevSpace();
+    ~DevSpace();
+
+    // Upload one instance record per object and draw them with the library's cube (GL thread)
+    void initialize(const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh,
+        const glm::vec3& portalAOffset, const glm::vec3& portalBOffset);
+
+    // Record one instanced draw of every object with a shader built on v_dev_space.glsl
+    void record(const Shader& shader, float nonEuclideanFactor, bool applyNonEuclidean, float time,
+        CommandList& out) const;
+
+    size_t getInstanceCount() const;
+
+private:
+    // Matches the layout(location = 3/4) inputs of v_dev_space.glsl
+    struct Instance {
+        glm::vec4 params;  // x = kind, y/z = grid or wall coordinates
+        glm::vec3 origin;  // Area offset
+    };
+
+    unsigned int VAO;
+    unsigned int instanceVBO;
+    MeshLibrary::Mesh cube;
+    std::vector<Instance> instances;
+};
+
+#endif // DEV_SPACE_H
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include "room.h"
+
+// Time content generation for every psychedelic room, serially and on the job system,
+// verify both paths produce identical output and print how generation scales with the
+// number of worker threads. Results go to stdout.
+void runGenerationBenchmark(RoomManager& roomManager, float time);
+
+// Compare the batch TRS kernel against chained glm::translate/rotate/scale at 1K, 100K
+// and 1M instances, reporting time and the largest element difference
+void runTransformBenchmark();
+
+// Check the fast animation math against libm over each function's documented range and
+// measure throughput of the array versions and the phase recurrence
+void runAnimMathBenchmark();
+
+#endif // DIAGNOSTICS_H
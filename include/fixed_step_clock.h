@@ -0,0 +1,54 @@
+#pragma once
+#ifndef FIXED_STEP_CLOCK_H
+#define FIXED_STEP_CLOCK_H
+
+// Fixed-timestep accumulator. Each frame the real elapsed time is added and the caller
+// runs step() once per whole step that fits, so the simulation advances by the same
+// increments at any frame rate. alpha() is how far the clock is between the last two
+// simulated states, used to interpolate what gets rendered.
+class FixedStepClock {
+public:
+    FixedStepClock(float stepSize, int maxStepsPerFrame)
+        : step(stepSize), maxSteps(maxStepsPerFrame), accumulator(0.0f), simulatedTime(0.0f), lastTime(-1.0) {}
+
+    // Feed the current wall-clock time; returns the number of steps to run this frame.
+    // After a stall (debugger, window drag, a very slow frame) at most maxSteps are run
+    // and the rest of the backlog is dropped instead of snowballing into later frames.
+    int advance(double now) {
+        float frameTime = lastTime < 0.0 ? 0.0f : static_cast<float>(now - lastTime);
+        lastTime = now;
+
+        accumulator += frameTime;
+        int steps = static_cast<int>(accumulator / step);
+        if (steps > maxSteps) {
+            steps = maxSteps;
+            accumulator = step * maxSteps;
+        }
+        accumulator -= steps * step;
+        simulatedTime += steps * step;
+        return steps;
+    }
+
+    float stepSize() const { return step; }
+
+    // Simulated time of the newest state
+    float time() const { return simulatedTime; }
+
+    // 0 = previous state, 1 = newest state
+    float alpha() const { return accumulator / step; }
+
+    // Time matching the interpolated state
+    float interpolatedTime() const {
+        float t = simulatedTime - step + accumulator;
+        return t > 0.0f ? t : 0.0f;
+    }
+
+private:
+    float step;
+    int maxSteps;
+    float accumulator;
+    float simulatedTime;
+    double lastTime;
+};
+
+#endif // FIXED_STEP_CLOCK_H
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef FRACTAL_HIERARCHY_H
+#define FRACTAL_HIERARCHY_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "command_list.h"
+#include "mesh_library.h"
+#include "shader.h"
+
+// Recursive cube fractal (a cube with a smaller copy at each of its eight corners) drawn
+// in one instanced call with the transforms composed on the GPU. The topology never
+// changes, so each node is uploaded once as
+//   texel 2n      child offset (in units of the parent's size), scale relative to parent
+//   texel 2n + 1  parent index (-1 for the root), level
+// to a texture buffer in breadth-first order. v_fractal_hierarchy.glsl walks each
+// instance's parent chain to find its centre and size; only the root centre, root size
+// and the time uniform change per frame.
+//
+// Levels below the screen-size cut-off are skipped twice: on the CPU the draw stops after
+// the deepest level that can still reach the cut-off from the camera (breadth-first
+// order makes that a prefix of the nodes), and the vertex shader collapses any remaining
+// node that projects smaller than the cut-off.
+class FractalHierarchy {
+public:
+    // Depth the shader can walk; deeper hierarchies are clamped to it
+    static const int MAX_DEPTH = 8;
+
+    // Texture unit the node buffer stays bound to
+    static const int TEXTURE_UNIT = 1;
+
+    struct Node {
+        int parent;
+        int level;
+        glm::vec3 childOffset;
+        float relativeScale;
+    };
+
+    FractalHierarchy();
+    ~FractalHierarchy();
+
+    // Build and upload the topology for this depth (GL thread)
+    void initialize(const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh, int depth,
+        float childScale = 0.3f, float childOffset = 0.7f);
+
+    // Record the draw of the levels that are visible from this view; the shader's "time"
+    // uniform drives the rotation. minScreenSize is the smallest node height, as a
+    // fraction of the viewport height, that is still drawn.
+    void record(const Shader& shader, const glm::vec3& rootCenter, float rootSize,
+        const ViewParams& view, float minScreenSize, CommandList& out) const;
+
+    int getDepth() const { return depth; }
+    size_t getNodeCount() const { return nodes.size(); }
+
+    // Nodes drawn by the last record() call
+    size_t getDrawnNodeCount() const { return drawnNodes; }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<size_t> levelEnd;    // Node count up to and including each level
+    std::vector<float> levelScale;   // Size of each level relative to the root
+    float boundRadius;               // Extent of the whole fractal relative to the root size
+    int depth;
+
+    unsigned int VAO;
+    MeshLibrary::Mesh cube;
+    unsigned int nodeBuffer;
+    unsigned int nodeTexture;
+
+    mutable size_t drawnNodes;
+};
+
+#endif // FRACTAL_HIERARCHY_H
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Linear allocator for data that only lives for a frame: allocation bumps a pointer,
+// nothing is freed individually and reset() makes all memory available again. When a
+// frame needs more than the current block a new block is chained on; reset() then
+// replaces the chain with one block of the combined size, so steady-state frames run
+// out of a single block without touching the heap.
+class FrameArena {
+public:
+    static const size_t BLOCK_SIZE = 256 * 1024;
+
+    FrameArena();
+    ~FrameArena();
+
+    void* allocate(size_t size, size_t alignment);
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Forget every allocation; records the frame's usage in the high-water mark
+    void reset();
+
+    size_t getUsed() const { return used; }
+    size_t getHighWater() const { return highWater; }
+    size_t getCapacity() const { return capacity; }
+
+private:
+    struct Block {
+        char* memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current;    // Block being bumped
+    size_t offset;     // Next free byte in that block
+    size_t used;       // Bytes handed out this frame (including alignment padding)
+    size_t highWater;
+    size_t capacity;
+
+    FrameArena(const FrameArena&);
+    FrameArena& operator=(const FrameArena&);
+};
+
+// The simulation and the renderer each have their own frame numbering. Every thread
+// holds two arenas per pipeline: advancing a pipeline's frame makes each thread switch
+// to its other arena (and reset it) on its next allocation for that pipeline. Memory
+// handed out in frame N therefore stays valid until that pipeline reaches frame N + 2,
+// which covers data still in flight to the render thread. Job system workers serve both
+// pipelines, so the pipelines must never share arenas.
+enum FramePipeline {
+    FRAME_SIMULATION = 0,
+    FRAME_RENDER = 1,
+    FRAME_PIPELINE_COUNT = 2
+};
+
+// Start a new frame of a pipeline (called by the thread driving it)
+void advanceFrame(FramePipeline pipeline);
+
+// The calling thread's arena for the pipeline's current frame
+FrameArena& frameArena(FramePipeline pipeline);
+
+// Print per-pipeline arena usage of every thread: peak frame usage and reserved memory
+void reportFrameArenaStats();
+
+// STL allocator drawing from the calling thread's frame arena; deallocate does nothing.
+// Only for containers that die within the frame (see advanceFrame for the exact lifetime).
+template <typename T, FramePipeline Pipeline>
+class FrameAllocator {
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef FrameAllocator<U, Pipeline> other;
+    };
+
+    FrameAllocator() {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U, Pipeline>&) {}
+
+    T* allocate(size_t count) {
+        return frameArena(Pipeline).template allocateArray<T>(count);
+    }
+
+    void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U, FramePipeline Pipeline>
+bool operator==(const FrameAllocator<T, Pipeline>&, const FrameAllocator<U, Pipeline>&) { return true; }
+
+template <typename T, typename U, FramePipeline Pipeline>
+bool operator!=(const FrameAllocator<T, Pipeline>&, const FrameAllocator<U, Pipeline>&) { return false; }
+
+template <typename T, FramePipeline Pipeline>
+using FrameVector = std::vector<T, FrameAllocator<T, Pipeline>>;
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "instancing.h"
+#include "particle_system.h"
+
+// Camera for rendering the scene through one portal, computed by the simulation thread
+struct PortalViewPacket {
+    bool visible;
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+
+// Everything the render thread needs to draw one frame. Filled by the simulation thread,
+// published through a TripleBuffer and treated as read-only once the renderer acquires it.
+struct FramePacket {
+    // GPU buffers the packets write into (instances, hyperbolic tiles) have this many
+    // regions, used in turn by frame index whatever TripleBuffer slot the packet is in.
+    // A region is rewritten INSTANCE_REGIONS frames after it was last drawn from.
+    static const int INSTANCE_REGIONS = 3;
+    static int instanceRegionOf(unsigned long long frameIndex) {
+        return (int)(frameIndex % INSTANCE_REGIONS);
+    }
+
+    unsigned long long frameIndex;
+    int instanceRegion;  // instanceRegionOf(frameIndex)
+    float time;
+
+    int roomIndex;
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 cameraPosition;
+
+    // One entry per portal, in the same order as the portal list
+    std::vector<PortalViewPacket> portalViews;
+
+    // Dev space animation parameters; the objects themselves are animated on the GPU
+    float nonEuclideanFactor;
+    bool applyNonEuclidean;
+
+    // Room shaders sample the noise and Mandelbulb volumes instead of computing them
+    bool usePrecomputedVolumes;
+
+    // Room 1 draws its Mandelbulb as the extracted triangle mesh instead of raymarching it
+    bool meshMandelbulb;
+
+    // Room 3 is drawn as the hyperbolic tiling, seen through this camera-relative isometry
+    bool hyperbolicGeometry;
+    glm::mat4 hyperbolicView;
+
+    // Room 8 is drawn on the 3-sphere, seen through this camera-relative rotation
+    bool sphericalGeometry;
+    glm::mat4 sphericalView;
+
+    // Room instances are frustum culled on the GPU per view instead of all drawn
+    bool gpuInstanceCulling;
+
+    InstanceBatch roomContent;
+
+    // The room's particle emitters this frame; the particles live on the GPU
+    std::vector<ParticleEmitter> particleEmitters;
+
+    FramePacket() : frameIndex(0), instanceRegion(0), time(0.0f), roomIndex(0), view(1.0f), projection(1.0f), cameraPosition(0.0f),
+        nonEuclideanFactor(0.0f), applyNonEuclidean(false), usePrecomputedVolumes(true),
+        meshMandelbulb(false), hyperbolicGeometry(false), hyperbolicView(1.0f),
+        sphericalGeometry(false), sphericalView(1.0f), gpuInstanceCulling(true) {}
+};
+
+#endif // FRAME_PACKET_H
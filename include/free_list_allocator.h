@@ -0,0 +1,33 @@
+#pragma once
+#ifndef FREE_LIST_ALLOCATOR_H
+#define FREE_LIST_ALLOCATOR_H
+
+#include <cstddef>
+#include <map>
+
+// Hands out ranges of a fixed-size space (offsets only, the memory lives elsewhere, e.g.
+// in a GPU buffer). First fit over an offset-ordered free list; released ranges merge
+// with free neighbours so the space doesn't fragment into unusable slivers.
+class FreeListAllocator {
+public:
+    static const size_t INVALID_OFFSET = (size_t)-1;
+
+    explicit FreeListAllocator(size_t capacity);
+
+    // Offset of a free range of the given size, or INVALID_OFFSET when none is large enough
+    size_t allocate(size_t size);
+
+    // Return a range obtained from allocate()
+    void release(size_t offset, size_t size);
+
+    size_t getCapacity() const { return capacity; }
+    size_t getFreeSize() const { return freeSize; }
+    size_t getLargestFreeRange() const;
+
+private:
+    size_t capacity;
+    size_t freeSize;
+    std::map<size_t, size_t> freeRanges; // offset -> size
+};
+
+#endif // FREE_LIST_ALLOCATOR_H
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <GL/glew.h>
+
+// Shadow copy of the GL state the renderer changes, so calls that would set what is
+// already set are dropped before they reach the driver. Every bind, enable and mode
+// change of the tracked state must go through here; after direct GL calls that touch it
+// (or deleting a bound object) call invalidate(). GL thread only.
+class GLStateCache {
+public:
+    static const int TEXTURE_UNITS = 16;
+
+    struct Counters {
+        unsigned int issued;        // State changes passed on to GL
+        unsigned int filtered;      // Redundant calls dropped
+        unsigned int unitSwitches;  // glActiveTexture calls made by texture binds, not in issued
+    };
+
+    GLStateCache();
+
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vao);
+    void bindTexture2D(int unit, unsigned int texture);
+    void bindTexture3D(int unit, unsigned int texture);
+    void bindTextureBuffer(int unit, unsigned int texture);
+    void bindFramebuffer(unsigned int framebuffer);
+    void setBlend(bool enabled);
+    void blendFunc(GLenum source, GLenum destination);
+    void setDepthTest(bool enabled);
+    void polygonMode(GLenum mode);
+    void viewport(int x, int y, int width, int height);
+
+    // Current viewport (x, y, width, height), asked from GL when not known
+    void getViewport(int rect[4]);
+
+    // Forget the shadow state; the next call of each kind is always issued
+    void invalidate();
+
+    // Latch this frame's counters and start counting the next frame
+    void endFrame();
+
+    const Counters& getFrameCounters() const { return lastFrame; }
+
+private:
+    // Tracked values; known == false means the GL value is not known
+    struct Tracked {
+        bool known;
+        unsigned int value;
+    };
+
+    Tracked program;
+    Tracked vertexArray;
+    Tracked activeUnit;
+    Tracked textures[TEXTURE_UNITS];
+    Tracked textures3D[TEXTURE_UNITS];
+    Tracked textureBuffers[TEXTURE_UNITS];
+    Tracked framebuffer;
+    Tracked blend;
+    Tracked blendSource;
+    Tracked blendDestination;
+    Tracked depthTest;
+    Tracked polygon;
+    bool viewportKnown;
+    int viewportRect[4];
+
+    Counters current;
+    Counters lastFrame;
+
+    // True (and counted as issued) when the value changes, false (counted as filtered) otherwise
+    bool change(Tracked& state, unsigned int value);
+    void bindTexture(Tracked& binding, GLenum target, int unit, unsigned int texture);
+};
+
+// The cache of the window's GL context
+GLStateCache& glState();
+
+#endif // GL_STATE_H
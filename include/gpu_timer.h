@@ -0,0 +1,52 @@
+#pragma once
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <GL/glew.h>
+
+// GPU time of a span of GL commands, measured with GL_TIME_ELAPSED queries. Results
+// arrive a few frames late, so every query carries a caller-chosen tag that comes back
+// with its result. Never blocks: when all queries are still in flight the span is simply
+// not measured. GL thread only.
+class GpuTimer {
+public:
+    static const int QUERY_COUNT = 4;
+
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin(int tag);
+    void end();
+
+    // Call fn(tag, milliseconds) for every query whose result is available
+    template <typename Fn>
+    void collect(Fn fn) {
+        for (Query& query : queries) {
+            if (!query.pending) continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &nanoseconds);
+            query.pending = false;
+            fn(query.tag, nanoseconds / 1.0e6);
+        }
+    }
+
+private:
+    struct Query {
+        unsigned int id;
+        int tag;
+        bool pending;
+    };
+
+    Query queries[QUERY_COUNT];
+    int active;  // Query between begin() and end(), -1 if none
+};
+
+#endif // GPU_TIMER_H
@@ -0,0 +1,153 @@
+#pragma once
+#ifndef HYPERBOLIC_SPACE_H
+#define HYPERBOLIC_SPACE_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+#include "command_list.h"
+#include "mesh_library.h"
+#include "shader.h"
+#include "stream_buffer.h"
+
+// Hyperbolic space in the hyperboloid model: points are the 4-vectors (x, y, z, w) with
+// w^2 - x^2 - y^2 - z^2 = 1 (curvature -1) and isometries are the 4x4 matrices preserving
+// the Minkowski product x.x' + y.y' + z.z' - w.w'. The floor is the hyperbolic plane y = 0,
+// tiled by regular p-gons meeting q at every vertex.
+//
+// Rendering puts the camera at the origin and divides by w, which lands in the Beltrami-Klein
+// model: geodesics come out as straight lines, so an ordinary perspective projection of
+// (x, y, z) / w is exactly what the camera sees, flat polygons need no subdivision and the
+// whole space fits in the unit ball. The vertex shader therefore only multiplies by the
+// camera-relative isometry of the tile and hands (x, y, z, w) to the projection as a
+// homogeneous point.
+
+// The {p,q} tiling, generated once and cached: a breadth-first walk over the group generated
+// by the reflections in the central tile's edges. Every tile reached is identified by its
+// centre, which a spatial hash on the hyperboloid's (x, z) checks against the tiles already
+// found, and the walk stops at cacheRadius from the origin. Tiles keep an orientation-
+// preserving isometry from the central tile (a reflection is followed by the central tile's
+// own mirror symmetry), so the tiling's symmetries never turn the camera inside out.
+class HyperbolicTiling {
+public:
+    struct Settings {
+        int p, q;             // (p - 2)(q - 2) > 4
+        float scale;          // World units per unit of hyperbolic distance
+        float cacheRadius;    // Tiles are generated this far from the central tile
+        float viewRadius;     // and drawn this far from the camera (at most cacheRadius - circumradius)
+        int maxVisibleTiles;
+    };
+
+    struct Tile {
+        glm::dmat4 isometry;  // Central tile to this one
+        glm::dvec4 center;    // isometry * origin
+    };
+
+    static Settings defaultSettings();
+
+    // Minkowski product and the isometries used to build the tiling and move the camera
+    static double minkowskiDot(const glm::dvec4& a, const glm::dvec4& b);
+    static double distance(const glm::dvec4& a, const glm::dvec4& b);
+    static glm::dmat4 translation(const glm::dvec3& displacement);  // Along a geodesic through the origin
+    static glm::dmat4 reflection(const glm::dvec4& normal);          // In the plane normal to a spacelike unit vector
+    static glm::dmat4 inverse(const glm::dmat4& isometry);           // eta * M^T * eta
+    static void renormalize(glm::dmat4& isometry);                   // Minkowski Gram-Schmidt against drift
+
+    HyperbolicTiling();
+
+    // Walk the reflection group out to settings.cacheRadius (any thread, before the tiling is read)
+    void build(const Settings& settings);
+
+    const Settings& getSettings() const { return settings; }
+    const std::vector<Tile>& getTiles() const { return tiles; }
+    double getInradius() const { return inradius; }
+    double getCircumradius() const { return circumradius; }
+    double getBuildMilliseconds() const { return buildMilliseconds; }
+
+    // Tile of the central tile's neighbours whose centre is nearest to point, or -1 when the
+    // central tile's is nearer
+    int nearestNeighbour(const glm::dvec4& point) const;
+
+private:
+    Settings settings;
+    std::vector<Tile> tiles;      // In the order the walk found them, so by growing distance
+    std::vector<int> neighbours;  // Tiles sharing an edge or a vertex with the central one
+    double inradius, circumradius;
+    double buildMilliseconds;
+};
+
+// The player's position in hyperbolic space, driven by the Euclidean camera: every frame the
+// camera's horizontal displacement becomes a hyperbolic translation in the floor plane, in the
+// player's own frame, and its height above the floor a translation along the floor's normal.
+// Going round a loop therefore turns the player against the tiling, as it does in real
+// hyperbolic space. Whenever the player leaves the central tile the tiling symmetry carrying
+// the neighbouring tile back to the centre is applied, which changes nothing on screen but
+// keeps the isometry (and its float precision) bounded however far the player walks.
+// Used on the simulation thread.
+class HyperbolicCamera {
+public:
+    HyperbolicCamera();
+
+    // Forget the last position; the next update starts at the centre of the central tile
+    void reset();
+
+    // Follow the Euclidean camera to worldPosition, standing on a floor at floorHeight
+    void update(const HyperbolicTiling& tiling, const glm::vec3& worldPosition, float floorHeight);
+
+    // Hyperboloid to camera-relative hyperboloid coordinates, as the renderer expects
+    glm::mat4 getView() const;
+
+    int getRecenterCount() const { return recenterCount; }
+
+private:
+    bool started;
+    glm::vec3 lastPosition;
+    glm::dmat4 floor;  // Isometry of the floor plane carrying the origin to the point under the player
+    double height;     // Above the floor, in hyperbolic units
+    int recenterCount;
+};
+
+// Draws the cached tiles within viewRadius of the camera: one instanced draw for the floor
+// tiles and one per decoration, with each visible tile's camera-relative isometry streamed
+// as a per-instance matrix (attributes 3-6). Decorations must share the tiles' p-fold
+// symmetry, since recentering the camera swaps tiles for rotated copies of themselves.
+// The matrices go through a StreamBuffer with a ring of regions indexed like InstanceStream's
+// (FramePacket::instanceRegion), so a frame never waits for the driver to give up last
+// frame's buffer.
+class HyperbolicRenderer {
+public:
+    HyperbolicRenderer();
+    ~HyperbolicRenderer();
+
+    // Create the tile mesh and instance regions (GL thread); the tiling must outlive this
+    void initialize(const HyperbolicTiling& tiling, MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh,
+        int regionCount);
+
+    // Wait until the GPU no longer reads the region, before it is written again
+    void waitForRegion(int region);
+
+    // Cull the tiles against the camera, write their isometries into the region and
+    // record their draws
+    void record(int region, const Shader& shader, const glm::mat4& cameraView, float time, CommandList& out);
+
+    // Fence the region after the frame's draws have been issued
+    void fenceRegion(int region);
+
+    size_t getVisibleTiles() const { return visibleCount; }
+    void reportStats() const;
+
+private:
+    const HyperbolicTiling* tiling;
+    MeshLibrary::Mesh tileMesh;
+    MeshLibrary::Mesh cube;
+
+    StreamBuffer instanceBuffer;
+    std::vector<unsigned int> VAOs;  // One per region
+
+    std::vector<std::pair<double, int> > candidates;  // cosh(distance), tile
+    std::vector<glm::mat4> instances;                 // Staging without persistent mapping
+    size_t visibleCount;
+};
+
+#endif // HYPERBOLIC_SPACE_H
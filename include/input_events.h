@@ -0,0 +1,102 @@
+#pragma once
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <vector>
+#include "spsc_queue.h"
+
+// GLFW callbacks run on the main thread; they only record events for the simulation
+struct InputEvent {
+    enum Type {
+        KEY,
+        CURSOR,
+        SCROLL
+    };
+
+    Type type;
+    int key;      // KEY: GLFW key code
+    int action;   // KEY: GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+    double x;     // CURSOR: position, SCROLL: offset
+    double y;
+};
+
+typedef SpscQueue<InputEvent, 1024> InputQueue;
+
+// Producer side of the input queue (main thread). Cursor and scroll events recorded between
+// two flushes merge into one each; key events are never dropped: those that find the queue
+// full wait, in order, for the next flush.
+class InputSender {
+public:
+    explicit InputSender(InputQueue& queue) : queue(queue), cursorPending(false), scrollPending(false),
+        cursorX(0.0), cursorY(0.0), scrollX(0.0), scrollY(0.0) {}
+
+    void key(int key, int action) {
+        InputEvent event = { InputEvent::KEY, key, action, 0.0, 0.0 };
+        if (!pendingKeys.empty() || !queue.push(event)) pendingKeys.push_back(event);
+    }
+
+    // Absolute position: only the latest one matters
+    void cursor(double x, double y) {
+        cursorX = x;
+        cursorY = y;
+        cursorPending = true;
+    }
+
+    // Offsets add up
+    void scroll(double x, double y) {
+        scrollX += x;
+        scrollY += y;
+        scrollPending = true;
+    }
+
+    // Hand over everything held back; whatever still does not fit waits for the next call
+    void flush() {
+        size_t sent = 0;
+        while (sent < pendingKeys.size() && queue.push(pendingKeys[sent])) sent++;
+        pendingKeys.erase(pendingKeys.begin(), pendingKeys.begin() + sent);
+
+        if (cursorPending) {
+            InputEvent event = { InputEvent::CURSOR, 0, 0, cursorX, cursorY };
+            cursorPending = !queue.push(event);
+        }
+        if (scrollPending) {
+            InputEvent event = { InputEvent::SCROLL, 0, 0, scrollX, scrollY };
+            if (queue.push(event)) {
+                scrollX = scrollY = 0.0;
+                scrollPending = false;
+            }
+        }
+    }
+
+private:
+    InputQueue& queue;
+    std::vector<InputEvent> pendingKeys;  // Did not fit, or arrived behind ones that did not
+    bool cursorPending, scrollPending;
+    double cursorX, cursorY;
+    double scrollX, scrollY;
+};
+
+// Key state rebuilt by the simulation thread from the event stream
+class InputState {
+public:
+    InputState() {
+        std::fill(keys, keys + GLFW_KEY_LAST + 1, false);
+    }
+
+    void apply(const InputEvent& event) {
+        if (event.type == InputEvent::KEY && event.key >= 0 && event.key <= GLFW_KEY_LAST) {
+            keys[event.key] = event.action != GLFW_RELEASE;
+        }
+    }
+
+    bool isDown(int key) const {
+        return key >= 0 && key <= GLFW_KEY_LAST && keys[key];
+    }
+
+private:
+    bool keys[GLFW_KEY_LAST + 1];
+};
+
+#endif // INPUT_EVENTS_H
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef INSTANCE_CULLER_H
+#define INSTANCE_CULLER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "command_list.h"
+#include "shader.h"
+
+// Frustum culling of instanced cubes on the GPU, once per view. Each batch is an
+// InstanceStream VAO (one mat4 at attributes 3-6 per instance); the cull program reads
+// its instances as points with rasterization discarded, and its geometry shader passes
+// on only those whose bounding sphere touches the view frustum, so transform feedback
+// writes the survivors packed into the batch's output buffer. The
+// recorded draws read that buffer as points, which the draw program's geometry shader
+// expands into cubes, with the count transform feedback wrote: nothing is read back.
+//
+// The outputs are overwritten by every cull, so each view is culled right before its
+// draws are replayed. GL thread only.
+class InstanceCuller {
+public:
+    InstanceCuller();
+    ~InstanceCuller();
+
+    InstanceCuller(const InstanceCuller&) = delete;
+    InstanceCuller& operator=(const InstanceCuller&) = delete;
+
+    // The cull program (v_instance_cull.glsl, g_instance_cull.glsl) runs for every view
+    void initialize(const Shader& cullShader);
+
+    // Drop the batches of the last frame
+    void clear();
+
+    // Cull this many instances of the VAO from now on; drawn with this polygon mode
+    void addBatch(unsigned int sourceVAO, GLsizei count, GLenum polygonMode = GL_FILL);
+
+    // Record one draw of each batch's survivors (v_room_culled.glsl, g_room_culled.glsl)
+    void record(const Shader& drawShader, CommandList& out) const;
+
+    // Cull every batch against this view's frustum, replacing the previous view's survivors
+    void cull(const ViewParams& view);
+
+    // Survivors of the last cull; waits for the GPU, so only called for diagnostics
+    void reportStats() const;
+
+private:
+    struct Batch {
+        unsigned int sourceVAO;
+        GLsizei count;
+        GLenum polygonMode;
+    };
+
+    // Survivor storage of one batch, reused across frames
+    struct Output {
+        unsigned int buffer;
+        unsigned int feedback;  // Transform feedback object capturing into buffer
+        unsigned int vao;       // Reads buffer as one instance per vertex
+        unsigned int query;     // Survivors written by the last cull
+        GLsizei capacity;       // Instances buffer holds
+    };
+
+    const Shader* cullShader;
+    GLint planesLocation;         // "frustumPlanes" of the cull program
+    std::vector<Batch> batches;
+    std::vector<Output> outputs;  // At least as many as batches
+    int viewsCulled;              // Since the last clear
+
+    void reserve(Output& output, GLsizei count);
+};
+
+#endif // INSTANCE_CULLER_H
@@ -0,0 +1,83 @@
+#pragma once
+#ifndef INSTANCE_STREAM_H
+#define INSTANCE_STREAM_H
+
+#include <GL/glew.h>
+#include <vector>
+#include "command_list.h"
+#include "instance_culler.h"
+#include "instancing.h"
+#include "mesh_library.h"
+#include "shader.h"
+#include "stream_buffer.h"
+
+// Generated room instances on their way to the GPU. Each frame writes one region of a
+// solid and a wireframe StreamBuffer, the next one in the ring (FramePacket::instanceRegion);
+// with persistent mapping the packet's InstanceBatch writes straight into its region, so
+// nothing is copied. Every region has
+// its own VAO whose attributes 3-6 read one mat4 per instance (v_room_instanced.glsl).
+//
+// A room's StaticRoomContent is uploaded once, when the room is entered, to a separate
+// static buffer.
+class InstanceStream {
+public:
+    // Matrices per region; larger batches are truncated with a warning
+    static const size_t SOLID_CAPACITY = 16384;
+    static const size_t WIREFRAME_CAPACITY = 1024;
+
+    InstanceStream();
+    ~InstanceStream();
+
+    // Create the buffers and VAOs, drawing the library's cube per instance (GL thread)
+    void initialize(const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh, int regionCount);
+
+    // Let a batch write into a region's mapped memory (no-op without persistent mapping).
+    // Any thread; clears the batch.
+    void bindBatch(int region, InstanceBatch& batch) const;
+
+    // Wait until the GPU no longer reads the region, before it goes back to the writer
+    void waitForRegion(int region);
+
+    // Replace the static instances with this room's (GL thread)
+    void uploadStatic(const StaticRoomContent& content);
+
+    // Copy whatever is not already in the region's mapped memory (GL thread)
+    void prepare(int region, const InstanceBatch& batch);
+
+    // Record the instanced draws of a prepared batch
+    void record(int region, const InstanceBatch& batch, const Shader& shader, CommandList& out) const;
+
+    // Record the static instances
+    void recordStatic(const Shader& shader, CommandList& out) const;
+
+    // Hand the same instances to the culler instead of recording them: a prepared batch's
+    // solid and wireframe instances, then the static ones
+    void addCullBatches(int region, const InstanceBatch& batch, InstanceCuller& culler) const;
+
+    // Fence the region after the frame's draws have been issued
+    void fenceRegion(int region);
+
+    // Print and reset the stall and upload counters
+    void reportStats();
+
+private:
+    StreamBuffer solid;
+    StreamBuffer wireframe;
+
+    MeshLibrary::Mesh cube;
+    std::vector<unsigned int> solidVAOs;
+    std::vector<unsigned int> wireframeVAOs;
+    bool overflowReported;
+
+    // Static buffer layout: solid, then wireframe matrices
+    unsigned int staticBuffer;
+    size_t staticSolidCount;
+    size_t staticWireframeCount;
+    unsigned int staticSolidVAO;
+    unsigned int staticWireframeVAO;
+
+    unsigned int createVAO(const MeshLibrary& meshes, unsigned int buffer, size_t base);
+    void prepareList(StreamBuffer& buffer, int region, const InstanceList& list, size_t capacity);
+};
+
+#endif // INSTANCE_STREAM_H
@@ -0,0 +1,202 @@
+#pragma once
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+#include "frame_arena.h"
+#include "job_system.h"
+
+// Growable list of model matrices. Works like a std::vector<glm::mat4>, but can be
+// pointed at external memory (a persistently mapped StreamBuffer region) so generators
+// write their matrices straight into GPU-visible memory. If the external range runs
+// out, the contents move to heap storage until the next clear(). Lists that only live
+// for one simulation frame can grow in the frame arena instead of the heap.
+class InstanceList {
+public:
+    InstanceList() : items(nullptr), count(0), capacity(0), externalMemory(nullptr), externalCapacity(0),
+        frameScoped(false) {}
+
+    // Copies always own their storage
+    InstanceList(const InstanceList& other) : InstanceList() {
+        append(other.data(), other.size());
+    }
+
+    InstanceList& operator=(const InstanceList& other) {
+        if (this != &other) {
+            clear();
+            append(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    // Write into memory[0, memoryCapacity) from the next clear() on; nullptr detaches
+    void setExternalStorage(glm::mat4* memory, size_t memoryCapacity) {
+        externalMemory = memory;
+        externalCapacity = memory ? memoryCapacity : 0;
+        clear();
+    }
+
+    // Grow in the simulation frame arena; the contents are only valid for this frame
+    void setFrameScoped(bool enabled) {
+        frameScoped = enabled;
+        clear();
+    }
+
+    // True while every matrix lives in the external memory
+    bool isExternal() const {
+        return externalMemory != nullptr && items == externalMemory;
+    }
+
+    void clear() {
+        count = 0;
+        if (frameScoped) {
+            items = nullptr;
+            capacity = 0;
+        }
+        else if (externalMemory) {
+            items = externalMemory;
+            capacity = externalCapacity;
+        }
+        else {
+            items = heap.data();
+            capacity = heap.size();
+        }
+    }
+
+    void reserve(size_t n) {
+        if (n > capacity) grow(n);
+    }
+
+    // New elements are left for the caller to overwrite
+    void resize(size_t n) {
+        if (n > capacity) grow(n);
+        count = n;
+    }
+
+    void push_back(const glm::mat4& model) {
+        if (count == capacity) grow(count + 1);
+        items[count++] = model;
+    }
+
+    void append(const glm::mat4* first, size_t n) {
+        if (count + n > capacity) grow(count + n);
+        std::copy(first, first + n, items + count);
+        count += n;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const glm::mat4* data() const { return items; }
+    glm::mat4& operator[](size_t i) { return items[i]; }
+    const glm::mat4& operator[](size_t i) const { return items[i]; }
+    const glm::mat4* begin() const { return items; }
+    const glm::mat4* end() const { return items + count; }
+
+private:
+    glm::mat4* items;
+    size_t count;
+    size_t capacity;
+
+    std::vector<glm::mat4> heap;
+    glm::mat4* externalMemory;
+    size_t externalCapacity;
+    bool frameScoped;
+
+    void grow(size_t needed) {
+        size_t size = std::max(needed, std::max(capacity * 2, (size_t)64));
+        if (frameScoped) {
+            // The old range is simply abandoned; the arena reclaims it at frame end
+            glm::mat4* next = frameArena(FRAME_SIMULATION).allocateArray<glm::mat4>(size);
+            std::copy(items, items + count, next);
+            items = next;
+            capacity = size;
+            return;
+        }
+
+        std::vector<glm::mat4> next(size);
+        std::copy(items, items + count, next.begin());
+        heap.swap(next);
+        items = heap.data();
+        capacity = heap.size();
+    }
+};
+
+// Per-frame output of a content generator: model matrices of every cube to draw
+struct InstanceBatch {
+    InstanceList solid;      // Regular filled cubes
+    InstanceList wireframe;  // Cubes drawn with GL_LINE polygon mode
+
+    void clear() {
+        solid.clear();
+        wireframe.clear();
+    }
+
+    void setFrameScoped(bool enabled) {
+        solid.setFrameScoped(enabled);
+        wireframe.setFrameScoped(enabled);
+    }
+
+    size_t size() const {
+        return solid.size() + wireframe.size();
+    }
+
+    void append(const InstanceBatch& other) {
+        solid.append(other.solid.data(), other.solid.size());
+        wireframe.append(other.wireframe.data(), other.wireframe.size());
+    }
+};
+
+// The part of a room that does not change with time, generated once when the room is
+// entered and kept on the GPU. Content animated by a few parameters keeps them out of the
+// instance stream instead: the dev space (DevSpace, from time and nonEuclideanFactor) and
+// the parametric surfaces (time terms in v_parametric_surface.glsl). What is left in a
+// room's per-frame InstanceBatch is rebuilt matrix by matrix.
+struct StaticRoomContent {
+    InstanceBatch fixed;
+
+    void clear() {
+        fixed.clear();
+    }
+
+    size_t size() const {
+        return fixed.size();
+    }
+};
+
+// Run generate(i, localBatch) for every i in [0, count) on the job system. Each chunk
+// fills its own local batch so workers never share a container; the chunks are then
+// merged in index order, which keeps the output identical to a serial loop. The chunk
+// batches are transient and live in the simulation frame arena.
+template <typename GenerateFn>
+void parallelGenerate(JobSystem* jobs, int count, int grainSize, InstanceBatch& out, GenerateFn generate) {
+    if (count <= 0) return;
+
+    if (!jobs || jobs->getWorkerCount() == 0 || count <= grainSize) {
+        for (int i = 0; i < count; i++) {
+            generate(i, out);
+        }
+        return;
+    }
+
+    int chunkCount = (count + grainSize - 1) / grainSize;
+    FrameVector<InstanceBatch, FRAME_SIMULATION> chunks(chunkCount);
+
+    jobs->parallelFor(0, chunkCount, 1, [&](int chunkBegin, int chunkEnd) {
+        for (int chunk = chunkBegin; chunk < chunkEnd; chunk++) {
+            chunks[chunk].setFrameScoped(true);
+            int first = chunk * grainSize;
+            int last = glm::min(first + grainSize, count);
+            for (int i = first; i < last; i++) {
+                generate(i, chunks[chunk]);
+            }
+        }
+    });
+
+    for (const auto& chunk : chunks) {
+        out.append(chunk);
+    }
+}
+
+#endif // INSTANCING_H
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef ISOSURFACE_MESHER_H
+#define ISOSURFACE_MESHER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "command_list.h"
+#include "job_system.h"
+#include "mesh_library.h"
+#include "shader.h"
+
+// Turns a distance field into triangle meshes, chunk by chunk on the job system, as an
+// alternative to raymarching it. Each chunk samples its corners (plus a one-sample
+// border shared with its neighbours) and runs naive surface nets, the simplest dual
+// contouring: every cell the surface crosses gets one vertex at the mean of its edge
+// crossings, and every crossed grid edge becomes a quad joining the four cells around it.
+// Quads share their cells' vertices, so each chunk comes out indexed and welded.
+// Neighbouring chunks produce bit-identical vertices along their common border as long
+// as they sample the field at identical positions, so keep boxMin and the cell size
+// exactly representable (for instance multiples of a power-of-two fraction).
+//
+// Finished chunks are queued and uploaded on the GL thread by update(), so the surface
+// appears while the rest is still being extracted. The whole result is written to a
+// cache file named after a hash of the settings and loaded back on later runs.
+class IsosurfaceMesher {
+public:
+    // Samples a size^3 grid whose first sample is at origin, spacing apart, x fastest
+    typedef std::function<void(const glm::vec3& origin, float spacing, int size, float* out)> Field;
+
+    struct Settings {
+        glm::vec3 boxMin;
+        float boxSize;
+        int resolution;      // Cells per side, a multiple of chunkCells
+        int chunkCells;      // Cells per chunk side; at most 32 so indices fit 16 bits
+        float isoLevel;      // Field values below this are inside
+        std::string fieldKey;  // Describes the field's own parameters for the cache; empty to not cache
+    };
+
+    // One chunk's welded mesh: 8 floats per vertex (position, normal, texcoord)
+    struct ChunkMesh {
+        glm::ivec3 chunk;
+        std::vector<float> vertices;
+        std::vector<uint16_t> indices;
+    };
+
+    IsosurfaceMesher();
+    ~IsosurfaceMesher();
+
+    // Load the cached meshes or start extracting every chunk in the background
+    void start(const Settings& settings, const Field& field, JobSystem* jobs);
+
+    // Upload the chunks finished since the last call (GL thread)
+    void update(MeshLibrary& meshes);
+
+    // Record the uploaded chunks with this model matrix
+    void record(const Shader& shader, const glm::mat4& model, const MeshLibrary& meshes, CommandList& out) const;
+
+    // Extract one chunk (exposed for diagnostics)
+    static void extractChunk(const Field& field, const Settings& settings, const glm::ivec3& chunk, ChunkMesh& out);
+
+    bool isComplete() const { return uploadedChunks == chunkCount; }
+    size_t getTriangleCount() const { return triangles; }
+    void reportStats() const;
+
+private:
+    struct UploadedChunk {
+        MeshLibrary::Mesh mesh;
+        glm::vec3 center;
+    };
+
+    Settings settings;
+    Field field;
+    JobSystem* jobs;
+    JobGroup group;
+
+    std::mutex finishedMutex;
+    std::vector<ChunkMesh> finished;  // Extracted, not yet uploaded
+    double extractionSeconds;         // Summed over all chunk jobs
+
+    std::vector<ChunkMesh> cacheChunks;  // Kept until the cache is written
+    std::vector<UploadedChunk> uploaded;
+    int chunkCount;
+    int uploadedChunks;
+    size_t triangles;
+    bool loadedFromCache;
+    std::chrono::high_resolution_clock::time_point startTime;
+    double wallMs;
+
+    std::string cachePath() const;
+    bool loadCache();
+    void saveCache() const;
+};
+
+#endif // ISOSURFACE_MESHER_H
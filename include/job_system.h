@@ -0,0 +1,91 @@
+#pragma once
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork/join handle - every job spawned into a group must finish before wait() returns
+class JobGroup {
+public:
+    JobGroup() : pending(0) {}
+
+    bool isDone() const {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> pending;
+};
+
+// Work-stealing job scheduler. Each worker owns a deque: it pushes and pops its own
+// jobs at the back (LIFO, cache friendly) while idle workers steal from the front of
+// other deques (FIFO, oldest and usually largest jobs first). Threads that are not
+// workers (main/GL thread) share an extra injection deque and help out while waiting.
+class JobSystem {
+public:
+    typedef std::function<void()> Job;
+
+    // workerCount excludes the calling thread; 0 runs everything inline on the caller
+    explicit JobSystem(unsigned int workerCount = defaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Queue a job as part of a fork/join group
+    void spawn(JobGroup& group, Job job);
+
+    // Block until the group is complete, executing queued jobs in the meantime
+    void wait(JobGroup& group);
+
+    // Split [begin, end) into chunks of at most grainSize and run fn(chunkBegin, chunkEnd)
+    // on all threads. Returns once every chunk has completed.
+    void parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& fn);
+
+    // Number of threads that can execute jobs (workers plus the waiting thread)
+    unsigned int getThreadCount() const;
+
+    unsigned int getWorkerCount() const;
+
+    // Hardware concurrency minus the main thread, at least 1
+    static unsigned int defaultWorkerCount();
+
+    // 0 for threads that are not workers of any job system, 1..N for workers
+    static int currentThreadIndex();
+
+private:
+    struct QueuedJob {
+        Job job;
+        JobGroup* group;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+    };
+
+    // queues[0] is the injection queue for outside threads, queues[i] belongs to worker i
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<int> queuedJobs;
+    std::atomic<bool> running;
+
+    void workerLoop(int workerIndex);
+    bool popOwn(int queueIndex, QueuedJob& out);
+    bool steal(int thiefIndex, QueuedJob& out);
+    bool tryRunOne(int queueIndex);
+    void execute(QueuedJob& queued);
+};
+
+#endif // JOB_SYSTEM_H
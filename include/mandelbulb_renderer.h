@@ -0,0 +1,70 @@
+#pragma once
+#ifndef MANDELBULB_RENDERER_H
+#define MANDELBULB_RENDERER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "command_list.h"
+#include "shader.h"
+
+// Raymarched Mandelbulb for the Mandelbulb room, drawn after the rasterized scene with
+// full-screen triangles in three passes:
+//   1. f_mandelbulb_cone.glsl marches one cone per TILE_SIZE^2 tile of the march target
+//      and stores how far all rays of the tile can skip (-1 for tiles that miss)
+//   2. f_mandelbulb_march.glsl sphere traces at half resolution from the tile distance,
+//      with a bounding-sphere early-out and over-relaxed steps, writing colour and linear
+//      view depth
+//   3. f_mandelbulb_composite.glsl upsamples to the window, blending only march texels at
+//      the depth of the dominant hit, and writes that depth so the depth test composites
+//      the bulb with the cubes and portal frames already drawn
+class MandelbulbRenderer {
+public:
+    struct Settings {
+        glm::vec3 center;  // World position of the bulb's origin
+        float scale;       // World units per fractal unit
+    };
+
+    // March pixels per cone tile side
+    static const int TILE_SIZE = 8;
+
+    // Texture units the pass inputs are bound to while drawing
+    static const int TEXTURE_UNIT_TILES = 5;
+    static const int TEXTURE_UNIT_COLOR = 6;
+    static const int TEXTURE_UNIT_DEPTH = 7;
+
+    // Bulb floating beyond the far portal of a room spawning here
+    static Settings defaultSettings(const glm::vec3& spawnPosition);
+
+    MandelbulbRenderer();
+    ~MandelbulbRenderer();
+
+    // Create the pass targets for a framebuffer of this size (GL thread); the march covers
+    // whatever viewport is current when rendering, so resizes only change its sampling
+    bool initialize(const Settings& settings, int width, int height);
+
+    // Draw the bulb into the bound default framebuffer, after the rest of the scene
+    void render(const Shader& coneShader, const Shader& marchShader, const Shader& compositeShader,
+        const ViewParams& view, float time) const;
+
+    const Settings& getSettings() const { return settings; }
+    int getMarchWidth() const { return marchWidth; }
+    int getMarchHeight() const { return marchHeight; }
+    int getTileCount() const { return tilesX * tilesY; }
+
+private:
+    Settings settings;
+    int width, height;
+    int marchWidth, marchHeight;
+    int tilesX, tilesY;
+
+    unsigned int VAO;  // No attributes; the vertex shader works from gl_VertexID
+    unsigned int tileFramebuffer;
+    unsigned int tileTexture;
+    unsigned int marchFramebuffer;
+    unsigned int colorTexture;
+    unsigned int depthTexture;
+
+    void setRayUniforms(const Shader& shader, const ViewParams& view, float time) const;
+};
+
+#endif // MANDELBULB_RENDERER_H
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef MANDELBULB_VOLUME_H
+#define MANDELBULB_VOLUME_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "job_system.h"
+#include "shader.h"
+
+// Mandelbulb distance estimate of f_room_psychedelic.glsl baked into 3D textures over a
+// box around the Mandelbulb room, so its glow samples two texels instead of running
+// seven iterations of acos, atan, pow and log per fragment.
+//
+// The shader's power animates as 8 + 4 sin(0.1 t). The volume is baked at keyframes
+// every keyframeInterval seconds and the shader blends between the keyframes either side
+// of the current time. While those two are in use, the next keyframe bakes in the
+// background as one short job per few slices (so a thread that helps with the job queue
+// never picks up a long task), and is uploaded over the older texture once the time
+// reaches it. Each row of texels is iterated in structure-of-arrays form through the
+// anim_math array kernels, so the transcendental work runs SimdOps::LANES points at a
+// time.
+class MandelbulbVolume {
+public:
+    struct Settings {
+        glm::vec3 center;       // World-space centre of the baked box
+        float halfExtent;       // Half the side of the box in world units
+        int size;               // Texels per side
+        float keyframeInterval; // Seconds between baked values of the power
+    };
+
+    // Texture units of the older and the newer keyframe
+    static const int TEXTURE_UNIT_A = 3;
+    static const int TEXTURE_UNIT_B = 4;
+
+    // Slices per background job
+    static const int SLICES_PER_JOB = 4;
+
+    // Box around a room's spawn position that covers its content
+    static Settings defaultSettings(const glm::vec3& center);
+
+    MandelbulbVolume();
+    ~MandelbulbVolume();
+
+    // Bake the keyframes around this time and upload them (GL thread)
+    bool initialize(const Settings& settings, JobSystem* jobs, float time);
+
+    // Move to this time: swap in the next keyframe when it is due and ready, start baking
+    // the one after it. Jumps of more than one keyframe re-bake synchronously (GL thread)
+    void update(float time);
+
+    // Point a shader using f_room_psychedelic.glsl at the volumes; the analytic estimate
+    // is used when disabled and outside the box
+    void apply(const Shader& shader, bool enabled) const;
+
+    // Power the shader uses at this time
+    static float powerAt(float time);
+
+    // Distance estimates of slices [zBegin, zEnd) of a size^3 grid of texel centres
+    // starting at boxMin (world units), x fastest. out holds the whole volume.
+    static void bake(const glm::vec3& boxMin, float texelSize, int size, float power,
+        int zBegin, int zEnd, float* out);
+
+    // Scalar reference of the estimate at one point (world units)
+    static float distanceAt(const glm::vec3& position, float power);
+
+    double getBakeMilliseconds() const { return bakeMs; }
+    int getBakeCount() const { return bakes; }
+    int getLateFrames() const { return lateFrames; }
+
+private:
+    Settings settings;
+    JobSystem* jobs;
+
+    unsigned int textures[2];  // [older, newer] keyframe
+    int keyframe;              // Index of the older keyframe
+    float blend;
+
+    // Background bake of keyframe + 2
+    JobGroup pending;
+    std::vector<float> staging;
+    int stagingKeyframe;
+
+    double bakeMs;   // Last synchronous bake
+    int bakes;
+    int lateFrames;  // Frames that held the newer keyframe waiting for a bake
+
+    glm::vec3 boxMin() const { return settings.center - glm::vec3(settings.halfExtent); }
+    float texelSize() const { return 2.0f * settings.halfExtent / settings.size; }
+
+    void bakeNow(int frameIndex, std::vector<float>& out);
+    void startBake(int frameIndex);
+    void upload(unsigned int texture, const std::vector<float>& values);
+};
+
+#endif // MANDELBULB_VOLUME_H
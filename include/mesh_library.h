@@ -0,0 +1,76 @@
+#pragma once
+#ifndef MESH_LIBRARY_H
+#define MESH_LIBRARY_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+#include "free_list_allocator.h"
+
+// Static meshes packed into one shared vertex and index buffer. Meshes are added as the
+// usual interleaved position/normal/texcoord floats (8 per vertex, unindexed triangles);
+// identical vertices are merged into an index list and each vertex is compressed from
+// 32 to 16 bytes:
+//   location 0  position   3 x half float (+1 padding)
+//   location 1  normal     2 x snorm16, octahedral encoded (decodeNormal in the shaders)
+//   location 2  texcoord   2 x half float (the ground plane tiles up to 50, beyond unorm16)
+// Both buffers are fixed-size arenas: add() sub-allocates a range of each from a free
+// list and uploads straight into it, so no CPU copy is kept, and remove() hands the
+// ranges back. Every mesh is drawn with glDrawElements*BaseVertex from the same buffers,
+// so all non-instanced meshes share one VAO and instanced VAOs only add their instance
+// streams. Construct and use on the GL thread.
+class MeshLibrary {
+public:
+    static const size_t VERTEX_CAPACITY = 65536;
+    static const size_t INDEX_CAPACITY = 196608;
+
+    // Size of one compressed vertex
+    static const size_t VERTEX_SIZE = 16;
+
+    // Range of one mesh in the shared buffers
+    struct Mesh {
+        GLint firstIndex;   // In indices, not bytes
+        GLsizei indexCount;
+        GLint baseVertex;
+        GLsizei vertexCount;
+    };
+
+    MeshLibrary();
+    ~MeshLibrary();
+
+    // Compress, deduplicate and upload a mesh; an empty mesh when the arena is full
+    Mesh add(const std::vector<float>& vertices);
+
+    // Compress and upload a mesh that is already indexed (indices relative to its first
+    // vertex) as is, without looking for duplicates
+    Mesh add(const std::vector<float>& vertices, const std::vector<uint16_t>& indices);
+
+    // Free a mesh's ranges for later meshes
+    void remove(const Mesh& mesh);
+
+    // Point attributes 0-2 and the element buffer of the bound VAO at the shared buffers
+    void bindLayout() const;
+
+    unsigned int getVAO() const { return VAO; }
+    size_t getFreeVertices() const { return vertexSpace.getFreeSize(); }
+    size_t getFreeIndices() const { return indexSpace.getFreeSize(); }
+
+private:
+    struct PackedVertex {
+        uint16_t position[4];
+        int16_t normal[2];
+        uint16_t texCoord[2];
+    };
+
+    static PackedVertex pack(const float* vertex);
+    Mesh upload(const std::vector<PackedVertex>& vertices, const std::vector<uint16_t>& indices);
+
+    FreeListAllocator vertexSpace;
+    FreeListAllocator indexSpace;
+
+    unsigned int VAO;
+    unsigned int VBO;
+    unsigned int EBO;
+};
+
+#endif // MESH_LIBRARY_H
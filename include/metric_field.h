@@ -0,0 +1,73 @@
+#pragma once
+#ifndef METRIC_FIELD_H
+#define METRIC_FIELD_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "job_system.h"
+
+// Christoffel symbols of a room's metric, baked on a regular grid so the geodesic camera
+// only pays for trilinear lookups. The metric is a callback in world coordinates; its
+// derivatives are taken by central differences once, at bake time, on the job system.
+// Outside the grid, and until the bake has finished, space is flat.
+//
+// Walking straight ahead follows a geodesic: the camera's front is parallel transported
+// along each step, and the step itself bends by the same symbols (step()).
+class MetricField {
+public:
+    typedef std::function<glm::dmat3(const glm::dvec3& position)> Metric;
+
+    struct Settings {
+        glm::vec3 origin;      // Grid point (0, 0, 0), world units
+        glm::vec3 extent;      // Size of the box the grid spans
+        glm::ivec3 resolution; // Points per axis, at least 2
+    };
+
+    // Gamma^i_jk, symmetric in j and k, stored for jk = 00 01 02 11 12 22
+    struct Christoffel {
+        float symbols[3][6];
+    };
+
+    MetricField();
+    ~MetricField();
+
+    MetricField(const MetricField&) = delete;
+    MetricField& operator=(const MetricField&) = delete;
+
+    // Start baking in the background, one job per z slice (synchronous without jobs).
+    // Only the first call does anything.
+    void bake(const Settings& settings, const Metric& metric, JobSystem* jobs);
+
+    bool isReady() const;
+
+    // Trilinear lookup; false (and zero symbols) outside the grid or before the bake is done
+    bool sample(const glm::vec3& position, Christoffel& out) const;
+
+    // Move by displacement (the Euclidean step the keys asked for) with one midpoint step of
+    // the geodesic equation, parallel transporting front along it. front stays unit length.
+    void step(glm::vec3& position, glm::vec3& front, const glm::vec3& displacement) const;
+
+    // Gamma(a, b)^i = Gamma^i_jk a^j b^k
+    static glm::vec3 contract(const Christoffel& c, const glm::vec3& a, const glm::vec3& b);
+
+    const Settings& getSettings() const { return settings; }
+    double getBakeMilliseconds() const { return bakeMs; }
+    void reportStats(int roomIndex) const;
+
+private:
+    Settings settings;
+    Metric metric;
+    JobSystem* jobs;
+    JobGroup pending;
+    bool started;
+
+    std::vector<float> symbols;   // 18 floats per grid point, x fastest
+    std::atomic<int> slicesLeft;
+    double bakeMs;
+
+    void bakeSlice(int z, double startSeconds);
+};
+
+#endif // METRIC_FIELD_H
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef NOISE_VOLUME_H
+#define NOISE_VOLUME_H
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include "job_system.h"
+#include "shader.h"
+
+// Tileable 3D texture of the five-octave value-noise fbm used by f_room_psychedelic.glsl,
+// so the rooms sample one texel instead of evaluating 40 hashes per fragment. The volume
+// covers `period` noise units in each direction; every octave's lattice wraps at the
+// tile edge (the inter-octave shift is a whole number of cells), so texture repeat hides
+// the seams. The lattice hash differs from the shader's sin-based one: the pattern has
+// the same character and range, not the same values.
+//
+// Texels are generated slice by slice on the job system, with each row's final
+// interpolation done SIMDOps::LANES texels at a time, and stored in a cache file so
+// later runs only read it back.
+class NoiseVolume {
+public:
+    enum Format {
+        FORMAT_R8,
+        FORMAT_R16F
+    };
+
+    struct Settings {
+        int size;            // Texels per side, a power of two from 16 to 256
+        Format format;
+        std::string cachePath;  // Empty to always generate
+    };
+
+    // Texture unit the volume stays bound to
+    static const int TEXTURE_UNIT = 2;
+
+    static Settings defaultSettings();
+
+    NoiseVolume();
+    ~NoiseVolume();
+
+    // Load the volume from the cache or generate it, then upload it (GL thread)
+    bool initialize(const Settings& settings, JobSystem* jobs);
+
+    // Point a shader using f_room_psychedelic.glsl at the volume; analytic noise when disabled
+    void apply(const Shader& shader, bool enabled) const;
+
+    // fbm values in [0, 1), x fastest (exposed for diagnostics)
+    static void generate(int size, JobSystem* jobs, std::vector<float>& out);
+
+    // Noise units covered by a volume of this size
+    static float periodFor(int size) { return size / 16.0f; }
+
+    unsigned int getTexture() const { return texture; }
+    double getGenerationMilliseconds() const { return generationMs; }
+    bool wasLoadedFromCache() const { return loadedFromCache; }
+
+private:
+    unsigned int texture;
+    Settings settings;
+    double generationMs;
+    bool loadedFromCache;
+
+    bool loadCache(std::vector<unsigned char>& texels) const;
+    void saveCache(const std::vector<unsigned char>& texels) const;
+};
+
+#endif // NOISE_VOLUME_H
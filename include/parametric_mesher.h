@@ -0,0 +1,47 @@
+#pragma once
+#ifndef PARAMETRIC_MESHER_H
+#define PARAMETRIC_MESHER_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Tessellates a parametric surface (u, v) in [0, 1]^2 into one indexed triangle grid whose
+// rows and columns are placed adaptively. Each u interval is halved while, along any of
+// the current v lines, the surface bends more than maxAngle across it (curvature) or its
+// midpoint strays from the chord by more than maxScreenError pixels seen from viewPoint
+// (screen error); then the same is done for the v intervals along the refined u lines,
+// and u once more. Rows and columns run through the whole surface, so neighbouring quads
+// always share their edges and there are no T-junctions.
+//
+// The surface is built once at settings.time; anything that moves with time is meant to be
+// re-applied in the vertex shader. Vertices are the usual 8 floats (position, normal,
+// texcoord) with the texcoord set to (u, v) so the shader can evaluate those terms.
+class ParametricMesher {
+public:
+    // Position of the surface at (u, v) and time t
+    typedef std::function<glm::vec3(float u, float v, float t)> Surface;
+
+    struct Settings {
+        int minSegmentsU, minSegmentsV;  // Starting grid
+        int maxSegmentsU, maxSegmentsV;  // (maxU + 1) * (maxV + 1) must stay within 65536
+        float maxAngle;                  // Radians of bend allowed across one segment
+        float maxScreenError;            // Pixels of chord deviation allowed
+        glm::vec3 viewPoint;             // Where the screen error is judged from
+        float focalPixels;               // Viewport height / (2 tan(fov / 2))
+        float time;
+    };
+
+    static Settings defaultSettings();
+
+    static void tessellate(const Surface& surface, const Settings& settings,
+        std::vector<float>& vertices, std::vector<uint16_t>& indices);
+
+private:
+    // Refine breakpoints along one parameter, judged along the lines at the other one
+    static void refine(const Surface& surface, const Settings& settings, bool alongU,
+        const std::vector<float>& across, int maxSegments, std::vector<float>& breakpoints);
+};
+
+#endif // PARAMETRIC_MESHER_H
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "command_list.h"
+#include "mesh_library.h"
+#include "shader.h"
+
+// One source of particles, described by the simulation thread every frame. Each emitter
+// owns a fixed range of particle slots; a slot below `active` spawns when its staggered
+// birth time comes and respawns when its lifetime runs out, a slot at or above it dies.
+// Particles spring towards a guide curve that moves with the emitter, inside a tube of
+// radius `spread`, so the streams keep their shape while every particle moves on its own.
+struct ParticleEmitter {
+    enum Type {
+        STREAM = 0,  // Flows from origin to target along an arc; phase is the particle's age
+        ORBIT = 1    // Spread around a turning ring; phase is fixed for each life
+    };
+
+    int type;
+    int capacity;       // Particle slots; the slot layout resets when capacities change
+    int active;         // Living particles, at most capacity
+    float lifetime;     // Seconds, varied by +-25% per particle
+    float size;         // Cube edge, world units
+    float spread;       // Radius of the tube around the guide curve
+    float stiffness;    // Spring towards the guide curve, 1/s^2 (critically damped)
+
+    glm::vec3 origin;   // STREAM: start of the arc. ORBIT: centre of the ring
+    glm::vec3 target;   // STREAM: end of the arc. ORBIT: unit normal of the ring
+    float radius;       // STREAM: arc height. ORBIT: ring radius
+    float sway;         // STREAM: sideways sway. ORBIT: radius wobble (relative)
+    float turns;        // ORBIT: turns around the ring over the phase range
+    float angularSpeed; // ORBIT: radians per second the ring turns
+    float height;       // ORBIT: amplitude along the normal, of sin(dot(heightFrequency, (angle, phase, time)))
+    glm::vec3 heightFrequency;
+
+    static ParticleEmitter stream(const glm::vec3& from, const glm::vec3& to, int capacity);
+    static ParticleEmitter orbit(const glm::vec3& center, const glm::vec3& normal, float radius, int capacity);
+};
+
+// GPU particle simulation. Particle state (position and age, velocity and seed) lives in
+// two buffers; each frame a vertex-only program reads one and writes the other through
+// transform feedback with rasterization discarded, then the particles are drawn as
+// instanced cubes straight from the new state. The CPU only uploads the emitter
+// descriptors (at most MAX_EMITTERS), so its cost does not depend on the particle count.
+// GL thread only.
+class ParticleSystem {
+public:
+    static const int MAX_EMITTERS = 16;
+    static const int VEC4_PER_EMITTER = 6;  // Must match v_particle_update.glsl and v_particle.glsl
+
+    struct Settings {
+        int capacity;  // Particle slots shared by all emitters
+    };
+
+    static Settings defaultSettings();
+
+    ParticleSystem();
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // The programs' "emitters" locations are looked up here, once
+    void initialize(const Settings& settings, const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh,
+        const Shader& updateShader, const Shader& renderShader);
+
+    // Advance the simulation to this time with these emitters (one transform feedback pass)
+    // and give both programs the emitter table. Nothing runs without emitters.
+    void update(const Shader& updateShader, const Shader& renderShader,
+        const std::vector<ParticleEmitter>& emitters, float time);
+
+    // Record the particles of the last update as one instanced draw
+    void record(const Shader& renderShader, CommandList& out) const;
+
+    int getCapacity() const { return settings.capacity; }
+    void reportStats() const;
+
+private:
+    Settings settings;
+    MeshLibrary::Mesh cube;
+
+    unsigned int stateBuffers[2];
+    unsigned int updateVAOs[2];  // Read state i as vertices
+    unsigned int renderVAOs[2];  // Cube mesh plus state i as instance attributes
+    int current;                 // Buffer holding the latest state
+
+    std::vector<glm::vec4> emitterTable;
+    GLint updateEmittersLocation;  // "emitters" of the update program
+    GLint renderEmittersLocation;  // "emitters" of the render program
+    std::vector<int> layout;     // Capacity of each emitter at the last update
+    int usedSlots;               // Slots assigned to emitters
+    int activeParticles;
+    float lastTime;
+    bool started;
+};
+
+#endif // PARTICLE_SYSTEM_H
@@ -5,6 +5,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Camera.h"
+#include "gl_state.h"
+#include "portal_geometry.h"
 
 class Portal {
 public:
@@ -32,7 +34,7 @@ public:
 
     // Constructor
     Portal(glm::vec3 pos, glm::vec3 norm, glm::vec3 upVec, float w, float h, glm::vec4 col,
-        unsigned int screenWidth, unsigned int screenHeight,
+        PortalGeometry& sharedGeometry, unsigned int screenWidth, unsigned int screenHeight,
         float scale = 1.0f, glm::vec3 rotation = glm::vec3(0.0f))
         : position(pos), normal(glm::normalize(norm)), up(glm::normalize(upVec)),
         width(w), height(h), edgeColor(col), destination(nullptr),
@@ -42,8 +44,9 @@ public:
         // Re-calculate the up vector to ensure it's orthogonal
         up = glm::normalize(glm::cross(normal, right));
 
-        // Initialize vertices for rendering
-        initializeVertices();
+        // Surface and frame meshes are shared by every portal of this size
+        geometry = &sharedGeometry;
+        shapes = geometry->acquire(width, height);
 
         // Create framebuffer for portal rendering
         createFramebuffer(screenWidth, screenHeight);
@@ -55,9 +58,10 @@ public:
         glDeleteTextures(1, &textureID);
         glDeleteRenderbuffers(1, &renderbuffer);
 
-        // Clean up frame resources
-        glDeleteVertexArrays(1, &frameVAO);
-        glDeleteBuffers(1, &frameVBO);
+        geometry->release(width, height);
+
+        // Deleted names may be reused, so the cached bindings can no longer be trusted
+        glState().invalidate();
     }
 
     // Link this portal to another
@@ -279,13 +283,13 @@ public:
 
     // Begin rendering to portal framebuffer
     void beginPortalRender() const {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glState().bindFramebuffer(framebuffer);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
     // End rendering to portal framebuffer
     void endPortalRender() const {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glState().bindFramebuffer(0);
     }
 
     // Get the portal's texture ID
@@ -293,40 +297,37 @@ public:
         return textureID;
     }
 
-    // Get the VAO for rendering
-    unsigned int getVAO() const {
-        return portalVAO;
-    }
-
-    // Get the number of vertices
-    int getVertexCount() const {
-        return 6; // Two triangles
+    // Get the surface quad in the shared mesh library (in portal space)
+    const MeshLibrary::Mesh& getSurfaceMesh() const {
+        return shapes.surface;
     }
 
-    // Get the frame VAO for rendering
-    unsigned int getFrameVAO() const {
-        return frameVAO;
+    // Get the frame in the shared mesh library (in portal space)
+    const MeshLibrary::Mesh& getFrameMesh() const {
+        return shapes.frame;
     }
 
-    // Get the number of frame vertices
-    int getFrameVertexCount() const {
-        return frameVertices.size() / 8; // 8 floats per vertex
+    // Get the model matrix taking portal space (right, up, normal) to world space
+    glm::mat4 getModelMatrix() const {
+        glm::mat4 model(glm::vec4(right, 0.0f), glm::vec4(up, 0.0f), glm::vec4(normal, 0.0f),
+            glm::vec4(position, 1.0f));
+        return model;
     }
 
     // Render the portal frame
-    void renderPortalFrame(Shader& frameShader, float time) const {
+    void renderPortalFrame(Shader& frameShader, float time, const MeshLibrary& meshes) const {
         frameShader.use();
 
         // Set uniforms for the frame shader
         frameShader.setVec4("frameColor", edgeColor);
         frameShader.setFloat("time", time);
-
-        glm::mat4 model = glm::mat4(1.0f);
-        frameShader.setMat4("model", model);
+        frameShader.setMat4("model", getModelMatrix());
 
         // Render the frame
-        glBindVertexArray(frameVAO);
-        glDrawArrays(GL_TRIANGLES, 0, getFrameVertexCount());
+        const MeshLibrary::Mesh& frame = shapes.frame;
+        glState().bindVertexArray(meshes.getVAO());
+        glDrawElementsBaseVertex(GL_TRIANGLES, frame.indexCount, GL_UNSIGNED_SHORT,
+            (void*)(frame.firstIndex * sizeof(GLushort)), frame.baseVertex);
     }
 
     glm::mat4 getPortalProjection(const glm::mat4& originalProjection) const {
@@ -343,285 +344,18 @@ public:
 
 private:
     glm::vec3 right;          // Right vector (perpendicular to normal and up)
-    std::vector<float> vertices;  // Vertices for rendering the portal
-    std::vector<float> frameVertices; // Vertices for rendering the portal frame
-    unsigned int portalVAO, portalVBO;
-    unsigned int frameVAO, frameVBO;
-
-    // Initialize portal vertices and VAO/VBO
-    void initializeVertices() {
-        // Calculate corners
-        glm::vec3 halfWidth = right * (width / 2.0f);
-        glm::vec3 halfHeight = up * (height / 2.0f);
-
-        glm::vec3 topLeft = position - halfWidth + halfHeight;
-        glm::vec3 topRight = position + halfWidth + halfHeight;
-        glm::vec3 bottomLeft = position - halfWidth - halfHeight;
-        glm::vec3 bottomRight = position + halfWidth - halfHeight;
-
-        // Create vertices (position, normal, texCoord)
-        vertices = {
-            // First triangle
-            topLeft.x, topLeft.y, topLeft.z, normal.x, normal.y, normal.z, 0.0f, 1.0f,
-            bottomLeft.x, bottomLeft.y, bottomLeft.z, normal.x, normal.y, normal.z, 0.0f, 0.0f,
-            topRight.x, topRight.y, topRight.z, normal.x, normal.y, normal.z, 1.0f, 1.0f,
-
-            // Second triangle
-            bottomLeft.x, bottomLeft.y, bottomLeft.z, normal.x, normal.y, normal.z, 0.0f, 0.0f,
-            bottomRight.x, bottomRight.y, bottomRight.z, normal.x, normal.y, normal.z, 1.0f, 0.0f,
-            topRight.x, topRight.y, topRight.z, normal.x, normal.y, normal.z, 1.0f, 1.0f,
-        };
-
-        // Create VAO/VBO
-        glGenVertexArrays(1, &portalVAO);
-        glGenBuffers(1, &portalVBO);
-
-        glBindVertexArray(portalVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, portalVBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-        // Position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // Normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        // Texture coordinate attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-
-        // Create frame vertices for the gate-like appearance
-        createFrameVertices();
-    }
-
-    void createFrameSegment(glm::vec3 start, glm::vec3 end, float thickness, float depth, bool vertical) {
-        glm::vec3 direction = glm::normalize(end - start);
-        glm::vec3 sideDir;
-
-        if (vertical) {
-            sideDir = glm::cross(direction, normal);
-        }
-        else {
-            sideDir = glm::cross(normal, direction);
-        }
-
-        sideDir = glm::normalize(sideDir);
-
-        glm::vec3 halfThickness = sideDir * (thickness / 2.0f);
-        glm::vec3 halfDepth = normal * (depth / 2.0f);
-
-        // Create a box along the line from start to end
-        glm::vec3 center = (start + end) / 2.0f;
-        float length = glm::length(end - start);
-
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, center);
-
-        // Create rotation matrix to align with segment direction
-        glm::vec3 defaultDir = vertical ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
-        glm::vec3 rotAxis = glm::cross(defaultDir, direction);
-        float rotAngle = acos(glm::dot(defaultDir, direction));
-
-        if (glm::length(rotAxis) > 0.0001f) {
-            model = glm::rotate(model, rotAngle, glm::normalize(rotAxis));
-        }
-
-        // Set dimensions based on segment orientation
-        float width, height;
-        if (vertical) {
-            width = thickness;
-            height = length;
-        }
-        else {
-            width = length;
-            height = thickness;
-        }
-
-        // Create box with specified dimensions
-        addBoxVertices(center, width, height, depth);
-    }
-
-    void addDecorativeCorner(glm::vec3 position, glm::vec3 upPosition, float size, float depth) {
-        // Add a decorative element at the corner
-        glm::vec3 center = (position + upPosition) / 2.0f;
-
-        // Create a small ornamental piece
-        addBoxVertices(center, size, size, depth * 1.5f);
-    }
-
-    // Create frame vertices for the gate-like appearance
-    void createFrameVertices() {
-        // Create a more stylized frame - thinner with some decorative elements
-        float frameThickness = 0.05f * width;  // Thinner frame
-        float frameDepth = 0.1f;               // Less depth
-
-        // Get basic coordinates
-        glm::vec3 halfWidth = right * (width / 2.0f);
-        glm::vec3 halfHeight = up * (height / 2.0f);
-
-        // Clear previous vertices
-        frameVertices.clear();
-
-        // Number of segments for rounded corners and decorative elements
-        int segments = 8;
-
-        // Create an elegant frame with rounded corners
-        createFrameSegment(position - halfWidth, position - halfWidth + halfHeight * 2.0f, frameThickness, frameDepth, true);  // Left vertical
-        createFrameSegment(position + halfWidth, position + halfWidth + halfHeight * 2.0f, frameThickness, frameDepth, true);  // Right vertical
-        createFrameSegment(position - halfWidth, position + halfWidth, frameThickness, frameDepth, false);                     // Bottom horizontal
-        createFrameSegment(position - halfWidth + halfHeight * 2.0f, position + halfWidth + halfHeight * 2.0f, frameThickness, frameDepth, false); // Top horizontal
-
-        // Add some decorative elements at the corners
-        addDecorativeCorner(position - halfWidth, position - halfWidth + up * frameThickness * 3.0f, frameThickness * 1.5f, frameDepth); // Bottom left
-        addDecorativeCorner(position + halfWidth, position + halfWidth + up * frameThickness * 3.0f, frameThickness * 1.5f, frameDepth); // Bottom right
-        addDecorativeCorner(position - halfWidth + halfHeight * 2.0f, position - halfWidth + halfHeight * 2.0f + up * frameThickness * 3.0f, frameThickness * 1.5f, frameDepth); // Top left
-        addDecorativeCorner(position + halfWidth + halfHeight * 2.0f, position + halfWidth + halfHeight * 2.0f + up * frameThickness * 3.0f, frameThickness * 1.5f, frameDepth); // Top right
-
-        // Create VAO/VBO for frame
-        glGenVertexArrays(1, &frameVAO);
-        glGenBuffers(1, &frameVBO);
-
-        glBindVertexArray(frameVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, frameVBO);
-        glBufferData(GL_ARRAY_BUFFER, frameVertices.size() * sizeof(float), frameVertices.data(), GL_STATIC_DRAW);
-
-        // Position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // Normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        // Texture coord attribute
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-    }
-
-    // Helper method to add box vertices to the frame
-    void addBoxVertices(glm::vec3 center, float width, float height, float depth) {
-        glm::vec3 halfDims(width / 2.0f, height / 2.0f, depth / 2.0f);
-
-        // Adjust center position to account for the portal normal direction
-        center = center - normal * (depth / 2.0f);
-
-        // Create transformation matrix for oriented box
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, center);
-
-        // Rotation matrix to align with portal orientation
-        glm::mat3 rotation(right, up, normal);
-
-        // Create box vertices in local space, then transform to world space
-        // Front face
-        addQuadVertices(
-            model * glm::vec4(-halfDims.x, -halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, -halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, halfDims.y, halfDims.z, 1.0f),
-            rotation * glm::vec3(0.0f, 0.0f, 1.0f)
-        );
-
-        // Back face
-        addQuadVertices(
-            model * glm::vec4(halfDims.x, -halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, -halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, halfDims.y, -halfDims.z, 1.0f),
-            rotation * glm::vec3(0.0f, 0.0f, -1.0f)
-        );
-
-        // Top face
-        addQuadVertices(
-            model * glm::vec4(-halfDims.x, halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, halfDims.y, -halfDims.z, 1.0f),
-            rotation * glm::vec3(0.0f, 1.0f, 0.0f)
-        );
-
-        // Bottom face
-        addQuadVertices(
-            model * glm::vec4(-halfDims.x, -halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, -halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, -halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, -halfDims.y, halfDims.z, 1.0f),
-            rotation * glm::vec3(0.0f, -1.0f, 0.0f)
-        );
-
-        // Left face
-        addQuadVertices(
-            model * glm::vec4(-halfDims.x, -halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, -halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(-halfDims.x, halfDims.y, -halfDims.z, 1.0f),
-            rotation * glm::vec3(-1.0f, 0.0f, 0.0f)
-        );
-
-        // Right face
-        addQuadVertices(
-            model * glm::vec4(halfDims.x, -halfDims.y, halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, -halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, halfDims.y, -halfDims.z, 1.0f),
-            model * glm::vec4(halfDims.x, halfDims.y, halfDims.z, 1.0f),
-            rotation * glm::vec3(1.0f, 0.0f, 0.0f)
-        );
-    }
-
-    // Helper to add a quad to the frame vertices
-    void addQuadVertices(glm::vec4 v1, glm::vec4 v2, glm::vec4 v3, glm::vec4 v4, glm::vec3 normal) {
-        // Convert from vec4 to vec3
-        glm::vec3 p1(v1.x, v1.y, v1.z);
-        glm::vec3 p2(v2.x, v2.y, v2.z);
-        glm::vec3 p3(v3.x, v3.y, v3.z);
-        glm::vec3 p4(v4.x, v4.y, v4.z);
-
-        // First triangle (p1, p2, p3)
-        frameVertices.push_back(p1.x); frameVertices.push_back(p1.y); frameVertices.push_back(p1.z);
-        frameVertices.push_back(normal.x); frameVertices.push_back(normal.y); frameVertices.push_back(normal.z);
-        frameVertices.push_back(0.0f); frameVertices.push_back(0.0f);
-
-        frameVertices.push_back(p2.x); frameVertices.push_back(p2.y); frameVertices.push_back(p2.z);
-        frameVertices.push_back(normal.x); frameVertices.push_back(normal.y); frameVertices.push_back(normal.z);
-        frameVertices.push_back(1.0f); frameVertices.push_back(0.0f);
-
-        frameVertices.push_back(p3.x); frameVertices.push_back(p3.y); frameVertices.push_back(p3.z);
-        frameVertices.push_back(normal.x); frameVertices.push_back(normal.y); frameVertices.push_back(normal.z);
-        frameVertices.push_back(1.0f); frameVertices.push_back(1.0f);
-
-        // Second triangle (p1, p3, p4)
-        frameVertices.push_back(p1.x); frameVertices.push_back(p1.y); frameVertices.push_back(p1.z);
-        frameVertices.push_back(normal.x); frameVertices.push_back(normal.y); frameVertices.push_back(normal.z);
-        frameVertices.push_back(0.0f); frameVertices.push_back(0.0f);
-
-        frameVertices.push_back(p3.x); frameVertices.push_back(p3.y); frameVertices.push_back(p3.z);
-        frameVertices.push_back(normal.x); frameVertices.push_back(normal.y); frameVertices.push_back(normal.z);
-        frameVertices.push_back(1.0f); frameVertices.push_back(1.0f);
-
-        frameVertices.push_back(p4.x); frameVertices.push_back(p4.y); frameVertices.push_back(p4.z);
-        frameVertices.push_back(normal.x); frameVertices.push_back(normal.y); frameVertices.push_back(normal.z);
-        frameVertices.push_back(0.0f); frameVertices.push_back(1.0f);
-    }
+    PortalGeometry* geometry; // Registry the shapes were acquired from
+    PortalGeometry::Shapes shapes;
 
     // Create framebuffer for rendering portal view
     void createFramebuffer(unsigned int width, unsigned int height) {
         // Generate framebuffer
         glGenFramebuffers(1, &framebuffer);
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glState().bindFramebuffer(framebuffer);
 
         // Create texture attachment
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        glState().bindTexture2D(0, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -638,7 +372,7 @@ private:
             std::cerr << "ERROR: Framebuffer not complete!" << std::endl;
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glState().bindFramebuffer(0);
     }
 };
 
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef PORTAL_GEOMETRY_H
+#define PORTAL_GEOMETRY_H
+
+#include <map>
+#include <utility>
+#include "mesh_library.h"
+
+// Registry of the portal surface and frame meshes. Geometry is built in portal space
+// (right = +X, up = +Y, normal = +Z, centred on the portal position) and only depends on
+// the portal's width and height, so every portal of the same size shares one surface and
+// one frame mesh in the MeshLibrary and places them with its model matrix. Meshes are
+// reference counted and freed from the library when the last portal using them releases.
+class PortalGeometry {
+public:
+    struct Shapes {
+        MeshLibrary::Mesh surface;
+        MeshLibrary::Mesh frame;
+    };
+
+    explicit PortalGeometry(MeshLibrary& meshes);
+    ~PortalGeometry();
+
+    // Shapes for a portal of this size, built on first use (GL thread)
+    Shapes acquire(float width, float height);
+    void release(float width, float height);
+
+    const MeshLibrary& getMeshes() const { return meshes; }
+    size_t getShapeCount() const { return entries.size(); }
+
+private:
+    struct Entry {
+        Shapes shapes;
+        int users;
+    };
+
+    MeshLibrary& meshes;
+    std::map<std::pair<float, float>, Entry> entries;
+};
+
+#endif // PORTAL_GEOMETRY_H
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+// Draw submission order as 64-bit sort keys. Fields from most to least significant:
+//   63..62  pass      opaque before wireframe
+//   61..48  program   so program switches are grouped
+//   47..32  material  vertex array (and through it the instance source)
+//   31..0   depth     view-space distance, nearest first, so opaque fragments fail early-Z
+// Draws with equal keys keep the order they were pushed in.
+class RenderQueue {
+public:
+    enum Pass {
+        PASS_OPAQUE = 0,
+        PASS_WIREFRAME = 1
+    };
+
+    struct Item {
+        uint64_t key;
+        unsigned int index;  // Caller's draw index
+    };
+
+    static uint64_t makeKey(Pass pass, unsigned int program, unsigned int material, float depth);
+
+    void clear() { items.clear(); }
+    void push(uint64_t key, unsigned int index) {
+        Item item = { key, index };
+        items.push_back(item);
+    }
+
+    // LSD radix sort over 8-bit digits; digits every key shares are skipped
+    void sort();
+
+    const std::vector<Item>& getItems() const { return items; }
+
+private:
+    std::vector<Item> items;
+    std::vector<Item> scratch;
+};
+
+#endif // RENDER_QUEUE_H
@@ -4,10 +4,18 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <memory>
 #include <string>
 #include <vector>
 #include "camera.h"
 #include "shader.h"
+#include "instancing.h"
+#include "instance_stream.h"
+#include "fractal_hierarchy.h"
+#include "mesh_library.h"
+#include "job_system.h"
+#include "metric_field.h"
+#include "particle_system.h"
 
 // Structure to define a room's properties
 struct Room {
@@ -41,44 +49,84 @@ public:
     // Get total number of rooms
     size_t getRoomCount() const;
 
-    // Room-specific rendering functions
-    void renderRoomSpecificContent(int roomIndex, Shader& shader,
-        unsigned int cubeVAO, float time);
+    // Provide the scheduler used to generate content in parallel (nullptr = serial)
+    void setJobSystem(JobSystem* jobs);
+    JobSystem* getJobSystem() const;
+
+    // Generate this frame's instance transforms for a room (CPU only, any thread)
+    void generateRoomContent(int roomIndex, float time, InstanceBatch& out);
+
+    // Generate the time-independent instances of a room, once per visit (CPU only, any
+    // thread); generateRoomContent then only produces the animated content
+    void generateStaticContent(int roomIndex, StaticRoomContent& out);
+
+    // Room-specific rendering functions - record generated content on the GL thread
+    void recordRoomSpecificContent(const Shader& shader, const InstanceStream& stream, int region,
+        const InstanceBatch& content, CommandList& out);
+
+    // Record the rooms' GPU-composed fractal hierarchy (nothing for rooms without one)
+    void recordFractalHierarchy(int roomIndex, const Shader& shader, const FractalHierarchy& fractal,
+        const ViewParams& view, CommandList& out);
+
+    // Tessellate the Klein bottle and Mobius rooms' surfaces into the library (GL thread);
+    // focalPixels is the viewport height over 2 tan(fov / 2), for the screen error
+    void buildSurfaces(MeshLibrary& meshes, float focalPixels);
+
+    // Record the room's parametric surface as one draw (nothing for rooms without one)
+    void recordParametricSurface(int roomIndex, const Shader& shader, const MeshLibrary& meshes,
+        CommandList& out);
+
+    // Describe this frame's particle emitters for a room (CPU only, any thread); the
+    // particles themselves are simulated and drawn by ParticleSystem
+    void generateParticleEmitters(int roomIndex, float time, std::vector<ParticleEmitter>& out);
+
+    // The room's metric for the geodesic camera: the pullback of v_room_warping.glsl's warp
+    // function with its displacement scaled by the room's nonEuclideanIntensity, laid over
+    // world space around the spawn column. Each room bends the camera by its own amount;
+    // the shader warps each object's model space instead, so the field is not what is drawn.
+    // The first call starts baking its Christoffel symbols on the job system (simulation
+    // thread); the field is flat until that finishes.
+    const MetricField& getMetricField(int roomIndex);
+
+    // Wait for metric bakes still in flight and free the fields (before the job system goes)
+    void releaseMetricFields();
 
     void setupRoomShader(Shader& shader, int roomIndex, float time);
 
 private:
     std::vector<Room> rooms;
     int currentRoom;
+    JobSystem* jobSystem;
 
-    // Specialized rendering functions for each room type
-    void renderHyperbolicRoom(Shader& shader, unsigned int cubeVAO, float time);
-    void renderImpossibleArchitecture(Shader& shader, unsigned int cubeVAO, float time);
-    void renderFractalSpace(Shader& shader, unsigned int cubeVAO, float time);
-    void renderKleinBottleSpace(Shader& shader, unsigned int cubeVAO, float time);
-    void renderEscherPlayground(Shader& shader, unsigned int cubeVAO, float time);
-    void renderPsychedelicVortex(Shader& shader, unsigned int cubeVAO, float time);
-    void renderRotatingHyperspace(Shader& shader, unsigned int cubeVAO, float time);
-    void renderSphericalGeometry(Shader& shader, unsigned int cubeVAO, float time);
-    void renderInfiniteCorridor(Shader& shader, unsigned int cubeVAO, float time);
-    void renderMandelbulbFractalSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderEscherImpossibleArchitecture(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderHyperbolicSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderKleinBottleSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderRecursiveScalingEnvironment(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderQuantumSuperpositionSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderMobiusTopology(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderNonCommutativeRotationSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderInfiniteRegressionChamber(Shader& shader, unsigned int cubeVAO, const Room& room, float time);
-    void renderFractalStructure(Shader& shader, unsigned int cubeVAO, glm::vec3 center, float size, int depth, float time);
-    void renderPortalFrame(Shader& shader, unsigned int cubeVAO, glm::vec3 position, float angle, float width, float height, float time);
-    // Helper for fractal room
-    void renderFractalCube(Shader& shader, unsigned int cubeVAO,
-        glm::vec3 center, float size, int depth, float time);
+    // Built by buildSurfaces, around the origin
+    MeshLibrary::Mesh kleinSurface;
+    MeshLibrary::Mesh mobiusSurface;
+
+    // Created on first use, one per room
+    std::vector<std::unique_ptr<MetricField>> metricFields;
 
-    // Helper for psychedelic rooms
-    void renderFloatingFractals(Shader& shader, unsigned int cubeVAO,
-        const Room& room, float time);
+    // Specialized content generators for each room type
+    void generateHyperbolicRoom(float time, InstanceBatch& out);
+    void generateImpossibleArchitecture(float time, InstanceBatch& out);
+    void generateFractalSpace(float time, InstanceBatch& out);
+    void generateKleinBottleSpace(float time, InstanceBatch& out);
+    void generateEscherPlayground(float time, InstanceBatch& out);
+    void generatePsychedelicVortex(float time, InstanceBatch& out);
+    void generateRotatingHyperspace(float time, InstanceBatch& out);
+    void generateSphericalGeometry(float time, InstanceBatch& out);
+    void generateInfiniteCorridor(float time, InstanceBatch& out);
+    void generateMandelbulbFractalSpace(const Room& room, float time, InstanceBatch& out);
+    void generateEscherImpossibleArchitecture(const Room& room, InstanceBatch& out);
+    void generateHyperbolicSpace(const Room& room, float time, InstanceBatch& out);
+    void generateKleinBottleSpace(const Room& room, float time, InstanceBatch& out);
+    void generateRecursiveScalingEnvironment(const Room& room, float time, InstanceBatch& out);
+    void generateQuantumSuperpositionSpace(const Room& room, float time, InstanceBatch& out);
+    void generateMobiusTopology(const Room& room, float time, InstanceBatch& out);
+    void generateNonCommutativeRotationSpace(const Room& room, float time, InstanceBatch& out);
+    void generateInfiniteRegressionChamber(const Room& room, float time, InstanceBatch& out);
+    void generatePortalFrame(glm::vec3 position, float angle, float width, float height, float time, InstanceBatch& out);
+    // Helper for fractal room
+    void generateFractalCube(glm::vec3 center, float size, int depth, float time, InstanceBatch& out);
 };
 
 #endif // ROOM_H
\ No newline at end of file
@@ -4,8 +4,10 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "gl_state.h"
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -111,9 +113,61 @@ public:
         glDeleteShader(fragment);
     }
 
+    // Constructor for programs with a geometry shader between the vertex and fragment stages
+    Shader(const char* vertexPath, const char* geometryPath, const char* fragmentPath) {
+        std::string vertexCode = readSource(vertexPath);
+        std::string geometryCode = readSource(geometryPath);
+        std::string fragmentCode = readSource(fragmentPath);
+
+        unsigned int vertex = compile(GL_VERTEX_SHADER, vertexCode, "VERTEX");
+        unsigned int geometry = compile(GL_GEOMETRY_SHADER, geometryCode, "GEOMETRY");
+        unsigned int fragment = compile(GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT");
+
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, geometry);
+        glAttachShader(ID, fragment);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+
+        glDeleteShader(vertex);
+        glDeleteShader(geometry);
+        glDeleteShader(fragment);
+    }
+
+    // Constructor for programs without a fragment stage whose outputs are captured by
+    // transform feedback, interleaved in the order given; rasterization is discarded while
+    // they run. The geometry shader, if any, decides which primitives are captured.
+    Shader(const char* vertexPath, const std::vector<std::string>& feedbackVaryings,
+        const char* geometryPath = nullptr) {
+        std::string vertexCode = readSource(vertexPath);
+        unsigned int vertex = compile(GL_VERTEX_SHADER, vertexCode, "VERTEX");
+        unsigned int geometry = 0;
+        if (geometryPath) {
+            std::string geometryCode = readSource(geometryPath);
+            geometry = compile(GL_GEOMETRY_SHADER, geometryCode, "GEOMETRY");
+        }
+
+        // The captured outputs must be named before linking
+        std::vector<const char*> names;
+        for (const std::string& varying : feedbackVaryings) {
+            names.push_back(varying.c_str());
+        }
+
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        if (geometry) glAttachShader(ID, geometry);
+        glTransformFeedbackVaryings(ID, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+
+        glDeleteShader(vertex);
+        if (geometry) glDeleteShader(geometry);
+    }
+
     // Use/activate the shader
     void use() const {
-        glUseProgram(ID);
+        glState().useProgram(ID);
     }
 
     // Utility uniform functions
@@ -166,6 +220,31 @@ public:
     }
 
 private:
+    static std::string readSource(const char* path) {
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            return stream.str();
+        }
+        catch (std::ifstream::failure& e) {
+            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+            return std::string();
+        }
+    }
+
+    unsigned int compile(GLenum stage, const std::string& code, const std::string& type) {
+        const char* source = code.c_str();
+        unsigned int shader = glCreateShader(stage);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        checkCompileErrors(shader, type);
+        return shader;
+    }
+
     // Utility function for checking shader compilation/linking errors
     void checkCompileErrors(unsigned int shader, std::string type) {
         int success;
@@ -0,0 +1,178 @@
+#pragma once
+#ifndef SIMD_OPS_H
+#define SIMD_OPS_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Thin wrappers over one register width so batch kernels can be written once as templates
+// and instantiated for the widest available instruction set plus a scalar tail.
+// SimdOps is AVX2 (8 lanes) when compiled with it, SSE2 (4 lanes) otherwise.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_OPS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_OPS_SSE
+#endif
+
+struct ScalarOps {
+    typedef float Vec;
+    typedef int32_t VecI;
+    static const int LANES = 1;
+
+    static Vec load(const float* p) { return *p; }
+    static void store(float* p, Vec v) { *p = v; }
+    static Vec set1(float v) { return v; }
+    static Vec add(Vec a, Vec b) { return a + b; }
+    static Vec sub(Vec a, Vec b) { return a - b; }
+    static Vec mul(Vec a, Vec b) { return a * b; }
+    static Vec div(Vec a, Vec b) { return a / b; }
+    static Vec sqrt(Vec a) { return std::sqrt(a); }
+    static Vec rsqrt(Vec a) { return 1.0f / std::sqrt(a); }
+    static Vec min(Vec a, Vec b) { return a < b ? a : b; }
+    static Vec max(Vec a, Vec b) { return a > b ? a : b; }
+
+    // Comparisons return all-ones / all-zero bit masks like the SIMD versions
+    static Vec cmpLt(Vec a, Vec b) { return asFloat(a < b ? -1 : 0); }
+    static Vec cmpGt(Vec a, Vec b) { return asFloat(a > b ? -1 : 0); }
+    static Vec bitAnd(Vec a, Vec b) { return asFloat(asInt(a) & asInt(b)); }
+    static Vec bitOr(Vec a, Vec b) { return asFloat(asInt(a) | asInt(b)); }
+    static Vec bitXor(Vec a, Vec b) { return asFloat(asInt(a) ^ asInt(b)); }
+    static Vec select(Vec mask, Vec a, Vec b) { return asInt(mask) ? a : b; }
+
+    static VecI roundToInt(Vec a) { return (int32_t)std::lrint(a); }
+    static Vec toFloat(VecI a) { return (float)a; }
+    static VecI loadI(const int32_t* p) { return *p; }
+    static VecI set1I(int32_t v) { return v; }
+    static VecI addI(VecI a, VecI b) { return a + b; }
+    static VecI subI(VecI a, VecI b) { return a - b; }
+    static VecI andI(VecI a, VecI b) { return a & b; }
+    static VecI xorI(VecI a, VecI b) { return a ^ b; }
+    static VecI mulI(VecI a, VecI b) { return (int32_t)((uint32_t)a * (uint32_t)b); }
+    static VecI shiftLeftI(VecI a, int bits) { return (int32_t)((uint32_t)a << bits); }
+    static VecI shiftRightI(VecI a, int bits) { return (int32_t)((uint32_t)a >> bits); }
+    static Vec asFloat(VecI a) { float f; std::memcpy(&f, &a, sizeof(f)); return f; }
+    static VecI asInt(Vec a) { int32_t i; std::memcpy(&i, &a, sizeof(i)); return i; }
+
+    // Write (a, b, c, d) of every lane to dst + lane * stride
+    static void storeRows(Vec a, Vec b, Vec c, Vec d, float* dst, int stride) {
+        (void)stride;
+        dst[0] = a; dst[1] = b; dst[2] = c; dst[3] = d;
+    }
+};
+
+#if defined(SIMD_OPS_SSE) || defined(SIMD_OPS_AVX2)
+inline void simdStoreRows4(__m128 a, __m128 b, __m128 c, __m128 d, float* dst, int stride) {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_storeu_ps(dst, a);
+    _mm_storeu_ps(dst + stride, b);
+    _mm_storeu_ps(dst + 2 * stride, c);
+    _mm_storeu_ps(dst + 3 * stride, d);
+}
+#endif
+
+#if defined(SIMD_OPS_SSE)
+struct SimdOps {
+    typedef __m128 Vec;
+    typedef __m128i VecI;
+    static const int LANES = 4;
+
+    static Vec load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+    static Vec set1(float v) { return _mm_set1_ps(v); }
+    static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+    static Vec sqrt(Vec a) { return _mm_sqrt_ps(a); }
+    static Vec rsqrt(Vec a) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a)); }
+    static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+
+    static Vec cmpLt(Vec a, Vec b) { return _mm_cmplt_ps(a, b); }
+    static Vec cmpGt(Vec a, Vec b) { return _mm_cmpgt_ps(a, b); }
+    static Vec bitAnd(Vec a, Vec b) { return _mm_and_ps(a, b); }
+    static Vec bitOr(Vec a, Vec b) { return _mm_or_ps(a, b); }
+    static Vec bitXor(Vec a, Vec b) { return _mm_xor_ps(a, b); }
+    static Vec select(Vec mask, Vec a, Vec b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+    static VecI roundToInt(Vec a) { return _mm_cvtps_epi32(a); }
+    static Vec toFloat(VecI a) { return _mm_cvtepi32_ps(a); }
+    static VecI loadI(const int32_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static VecI set1I(int32_t v) { return _mm_set1_epi32(v); }
+    static VecI addI(VecI a, VecI b) { return _mm_add_epi32(a, b); }
+    static VecI subI(VecI a, VecI b) { return _mm_sub_epi32(a, b); }
+    static VecI andI(VecI a, VecI b) { return _mm_and_si128(a, b); }
+    static VecI xorI(VecI a, VecI b) { return _mm_xor_si128(a, b); }
+
+    // Low 32 bits of each product; SSE2 only multiplies lanes 0 and 2, so do both halves
+    static VecI mulI(VecI a, VecI b) {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+    static VecI shiftLeftI(VecI a, int bits) { return _mm_sll_epi32(a, _mm_cvtsi32_si128(bits)); }
+    static VecI shiftRightI(VecI a, int bits) { return _mm_srl_epi32(a, _mm_cvtsi32_si128(bits)); }
+    static Vec asFloat(VecI a) { return _mm_castsi128_ps(a); }
+    static VecI asInt(Vec a) { return _mm_castps_si128(a); }
+
+    static void storeRows(Vec a, Vec b, Vec c, Vec d, float* dst, int stride) {
+        simdStoreRows4(a, b, c, d, dst, stride);
+    }
+};
+#elif defined(SIMD_OPS_AVX2)
+struct SimdOps {
+    typedef __m256 Vec;
+    typedef __m256i VecI;
+    static const int LANES = 8;
+
+    static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    static Vec set1(float v) { return _mm256_set1_ps(v); }
+    static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+    static Vec sqrt(Vec a) { return _mm256_sqrt_ps(a); }
+    static Vec rsqrt(Vec a) { return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(a)); }
+    static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+
+    static Vec cmpLt(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Vec cmpGt(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Vec bitAnd(Vec a, Vec b) { return _mm256_and_ps(a, b); }
+    static Vec bitOr(Vec a, Vec b) { return _mm256_or_ps(a, b); }
+    static Vec bitXor(Vec a, Vec b) { return _mm256_xor_ps(a, b); }
+    static Vec select(Vec mask, Vec a, Vec b) { return _mm256_blendv_ps(b, a, mask); }
+
+    static VecI roundToInt(Vec a) { return _mm256_cvtps_epi32(a); }
+    static Vec toFloat(VecI a) { return _mm256_cvtepi32_ps(a); }
+    static VecI loadI(const int32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static VecI set1I(int32_t v) { return _mm256_set1_epi32(v); }
+    static VecI addI(VecI a, VecI b) { return _mm256_add_epi32(a, b); }
+    static VecI subI(VecI a, VecI b) { return _mm256_sub_epi32(a, b); }
+    static VecI andI(VecI a, VecI b) { return _mm256_and_si256(a, b); }
+    static VecI xorI(VecI a, VecI b) { return _mm256_xor_si256(a, b); }
+    static VecI mulI(VecI a, VecI b) { return _mm256_mullo_epi32(a, b); }
+    static VecI shiftLeftI(VecI a, int bits) { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(bits)); }
+    static VecI shiftRightI(VecI a, int bits) { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(bits)); }
+    static Vec asFloat(VecI a) { return _mm256_castsi256_ps(a); }
+    static VecI asInt(Vec a) { return _mm256_castps_si256(a); }
+
+    // Transpose the low and high four lanes separately
+    static void storeRows(Vec a, Vec b, Vec c, Vec d, float* dst, int stride) {
+        simdStoreRows4(_mm256_castps256_ps128(a), _mm256_castps256_ps128(b),
+            _mm256_castps256_ps128(c), _mm256_castps256_ps128(d), dst, stride);
+        simdStoreRows4(_mm256_extractf128_ps(a, 1), _mm256_extractf128_ps(b, 1),
+            _mm256_extractf128_ps(c, 1), _mm256_extractf128_ps(d, 1), dst + 4 * stride, stride);
+    }
+};
+#else
+typedef ScalarOps SimdOps;
+#endif
+
+#endif // SIMD_OPS_H
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef SPHERICAL_SPACE_H
+#define SPHERICAL_SPACE_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+#include "command_list.h"
+#include "mesh_library.h"
+#include "shader.h"
+
+// Spherical space: the 3-sphere of unit 4-vectors (x, y, z, w), scaled to `radius` world
+// units, whose isometries are the rotations of SO(4). Reading (x, y, z, w) as the quaternion
+// w + xi + yj + zk, every rotation is q -> a q b for unit quaternions a and b, which is how
+// the content is placed and moved (sphereIsometry).
+//
+// The camera sits at (0, 0, 0, 1). Dividing by w is the gnomonic projection, which keeps
+// great circles straight, so the usual perspective projection gives every point's true
+// direction. Light reaches the camera from each point along both arcs of its great circle,
+// so everything is seen twice: directly, at distance theta < pi, and in the opposite
+// direction at 2 pi - theta, through the camera's antipode. v_spherical.glsl draws the two
+// images as separate draws (the second one of -p) and replaces the projection's depth with
+// one that grows monotonically along the whole ray: the direct image fills the near half of
+// the depth range and the antipodal image the far half, so they composite correctly.
+
+// 4x4 matrix of q -> left * q * right on (x, y, z, w)
+glm::mat4 sphereIsometry(const glm::quat& left, const glm::quat& right);
+
+// The player's position on the 3-sphere, driven by the Euclidean camera: each frame's
+// displacement becomes a rotation towards it in the player's own frame. The sphere is
+// compact, so no recentering is needed, only re-orthonormalization against drift.
+// Used on the simulation thread.
+class SphericalCamera {
+public:
+    SphericalCamera();
+
+    // Forget the last position; the next update starts at (0, 0, 0, 1)
+    void reset();
+
+    void update(const glm::vec3& worldPosition, float radius);
+
+    // Sphere to camera-relative sphere coordinates (the inverse of the player's rotation)
+    glm::mat4 getView() const;
+
+private:
+    bool started;
+    glm::vec3 lastPosition;
+    glm::dmat4 player;
+};
+
+// Room content on the 3-sphere, as per-instance SO(4) matrices (attributes 3-6) in a static
+// buffer. Animation is one rotation per group, composed with the instances in the vertex
+// shader, so the CPU cost per frame does not depend on the instance count:
+//   - cubes along twelve fibres of the Hopf fibration, sliding along them together (right
+//     multiplication by e^(i s) moves every point along its own fibre)
+//   - larger cubes at the 24 vertices of the 24-cell, each spinning in place
+class SphericalRenderer {
+public:
+    struct Settings {
+        float radius;           // World units per radian
+        int fibreCount;         // Up to 12 (the base points are icosahedron vertices)
+        int cubesPerFibre;
+    };
+
+    static Settings defaultSettings();
+
+    SphericalRenderer();
+    ~SphericalRenderer();
+
+    // Place the content and create its instance buffer (GL thread)
+    void initialize(const Settings& settings, const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh);
+
+    // Record both images of every group
+    void record(const Shader& shader, const glm::mat4& cameraView, float time, CommandList& out) const;
+
+    const Settings& getSettings() const { return settings; }
+    size_t getInstanceCount() const { return fibreInstances + latticeInstances; }
+    void reportStats() const;
+
+private:
+    Settings settings;
+    MeshLibrary::Mesh cube;
+
+    unsigned int instanceBuffer;
+    unsigned int fibreVAO;    // Instances [0, fibreInstances)
+    unsigned int latticeVAO;  // The rest
+    size_t fibreInstances;
+    size_t latticeInstances;
+
+    unsigned int createVAO(const MeshLibrary& meshes, size_t base) const;
+};
+
+#endif // SPHERICAL_SPACE_H
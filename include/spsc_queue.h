@@ -0,0 +1,49 @@
+#pragma once
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Capacity must be a power of two; one slot stays empty to tell full from empty.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only. Returns false (and drops the item) when the queue is full.
+    bool push(const T& item) {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        size_t nextTail = (currentTail + 1) & (Capacity - 1);
+        if (nextTail == head.load(std::memory_order_acquire)) return false;
+
+        items[currentTail] = item;
+        tail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when the queue is empty.
+    bool pop(T& item) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) return false;
+
+        item = items[currentHead];
+        head.store((currentHead + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[Capacity];
+
+    // Separate cache lines so producer and consumer do not false-share
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+// GL buffer for data rewritten every frame, split into regionCount regions so the CPU
+// fills one region while the GPU still reads the others. With ARB_buffer_storage the
+// buffer is mapped once (persistent, coherent) and written in place; each region is
+// fenced after the draws that read it and waited on before it is handed back to the
+// writer. Without it, upload() re-specifies (orphans) the buffer and copies with
+// glBufferSubData. All methods except writes through getRegionPointer() are GL-thread only.
+class StreamBuffer {
+public:
+    struct Stats {
+        unsigned long long waits;    // waitForRegion() calls on a fenced region
+        unsigned long long stalls;   // ...of which the GPU had not finished yet
+        double stallMilliseconds;    // CPU time spent blocked in those stalls
+        unsigned long long uploads;  // Copies through upload()
+    };
+
+    StreamBuffer();
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    void initialize(size_t regionSize, int regionCount);
+
+    bool isPersistent() const { return mapped != nullptr; }
+    unsigned int getBuffer() const { return buffer; }
+    size_t getRegionSize() const { return regionSize; }
+    int getRegionCount() const { return (int)fences.size(); }
+    size_t getRegionOffset(int region) const { return region * regionSize; }
+
+    // Persistent mode: CPU address of a region, valid for the buffer's lifetime. Any thread
+    // may write through it while it owns the region. nullptr in orphaning mode.
+    void* getRegionPointer(int region) const;
+
+    // Block until the GPU has finished the commands fenced for this region
+    void waitForRegion(int region);
+
+    // Fence the commands issued so far; call after the draws that read the region
+    void fenceRegion(int region);
+
+    // Copy bytes to the start of a region (orphaning fallback, or data that missed the
+    // mapped memory). Returns the number of bytes written, at most getRegionSize().
+    size_t upload(int region, const void* data, size_t bytes);
+
+    const Stats& getStats() const { return stats; }
+    void resetStats();
+
+private:
+    unsigned int buffer;
+    size_t regionSize;
+    char* mapped;
+    std::vector<GLsync> fences;
+    Stats stats;
+};
+
+#endif // STREAM_BUFFER_H
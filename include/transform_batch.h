@@ -0,0 +1,72 @@
+#pragma once
+#ifndef TRANSFORM_BATCH_H
+#define TRANSFORM_BATCH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+// Affine model matrix without the constant (0, 0, 0, 1) row: three rows of
+// (rotation * scale | translation), 48 bytes instead of 64
+struct PackedTransform {
+    float rows[3][4];
+};
+
+inline glm::mat4 toMat4(const PackedTransform& packed) {
+    glm::mat4 model(1.0f);
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 3; row++) {
+            model[column][row] = packed.rows[row][column];
+        }
+    }
+    return model;
+}
+
+// How the rotation arrays of a TransformSoA are interpreted
+enum RotationFormat {
+    ROTATION_AXIS_ANGLE,  // rotX/Y/Z = axis (any length), rotW = angle in radians
+    ROTATION_QUATERNION   // rotX/Y/Z/W = unit quaternion (x, y, z, w)
+};
+
+// Structure-of-arrays list of translate * rotate * scale transforms. Equivalent to
+//   glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), position), angle, axis), scale)
+// for every entry, but laid out so the kernel can process 4/8 instances per instruction.
+struct TransformSoA {
+    RotationFormat rotationFormat;
+
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> rotX, rotY, rotZ, rotW;
+    std::vector<float> scaleX, scaleY, scaleZ;
+
+    explicit TransformSoA(RotationFormat format = ROTATION_AXIS_ANGLE) : rotationFormat(format) {}
+
+    size_t size() const {
+        return posX.size();
+    }
+
+    void clear();
+    void reserve(size_t count);
+
+    // Only valid for ROTATION_AXIS_ANGLE lists
+    void push(const glm::vec3& position, float angle, const glm::vec3& axis, const glm::vec3& scale);
+
+    // Only valid for ROTATION_QUATERNION lists
+    void push(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+};
+
+// Batch kernels: write in.size() matrices to out (AVX2 when compiled with it, SSE otherwise)
+void buildTransforms(const TransformSoA& in, PackedTransform* out);
+void buildTransforms(const TransformSoA& in, glm::mat4* out);
+
+// Append the matrices of a transform list to a model matrix list (std::vector<glm::mat4>
+// or InstanceList)
+template <typename MatrixList>
+inline void appendTransforms(const TransformSoA& in, MatrixList& out) {
+    size_t first = out.size();
+    out.resize(first + in.size());
+    if (in.size() > 0) {
+        buildTransforms(in, &out[first]);
+    }
+}
+
+#endif // TRANSFORM_BATCH_H
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Lock-free triple buffer between one writer and one reader. The writer always has a
+// slot to fill and the reader always has the latest complete slot, so neither ever
+// waits for the other; intermediate values the reader did not pick up are dropped.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back(0), middle(1), front(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer: slot to fill for the next publish()
+    T& writeSlot() {
+        return slots[back];
+    }
+
+    // Writer: hand the filled slot to the reader and take the stale one back
+    void publish() {
+        back = middle.exchange(back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader: true if acquire() would switch to a new slot. Only the reader clears this,
+    // so a true result holds until the reader's next acquire().
+    bool hasPublished() const {
+        return (middle.load(std::memory_order_relaxed) & FRESH_BIT) != 0;
+    }
+
+    // Reader: switch to the latest published slot. Returns false if nothing new arrived.
+    bool acquire() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0) return false;
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Reader: the slot most recently acquired
+    const T& readSlot() const {
+        return slots[front];
+    }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH_BIT = 4;
+
+    T slots[3];
+    int back;                 // Owned by the writer
+    std::atomic<int> middle;  // Shared: index plus FRESH_BIT when it holds an unread slot
+    int front;                // Owned by the reader
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -0,0 +1,76 @@
+#version 410 core
+
+// Full-resolution composite of the half-resolution Mandelbulb march (MandelbulbRenderer).
+// The four nearest march texels are blended bilinearly, but only those at about the same
+// depth as the dominant hit, so silhouettes and self-occlusion edges do not bleed. The
+// fragment writes the blended hit's depth and is depth tested against the rasterized scene.
+out vec4 FragColor;
+
+uniform sampler2D marchColor;
+uniform sampler2D marchDepth;
+uniform mat4 projection;
+uniform vec4 viewport;  // x, y, width, height of the window's viewport
+
+// Relative depth difference at which a texel stops contributing
+const float DEPTH_TOLERANCE = 0.05;
+
+void main()
+{
+    // Position in march texels, relative to texel centres; the march covers the viewport
+    // at whatever size it has now
+    ivec2 marchSize = textureSize(marchDepth, 0);
+    vec2 marchPos = (gl_FragCoord.xy - viewport.xy) / viewport.zw * vec2(marchSize) - 0.5;
+    ivec2 base = ivec2(floor(marchPos));
+    vec2 f = marchPos - vec2(base);
+    ivec2 last = marchSize - 1;
+
+    ivec2 coords[4];
+    coords[0] = clamp(base, ivec2(0), last);
+    coords[1] = clamp(base + ivec2(1, 0), ivec2(0), last);
+    coords[2] = clamp(base + ivec2(0, 1), ivec2(0), last);
+    coords[3] = clamp(base + ivec2(1, 1), ivec2(0), last);
+
+    float bilinear[4];
+    bilinear[0] = (1.0 - f.x) * (1.0 - f.y);
+    bilinear[1] = f.x * (1.0 - f.y);
+    bilinear[2] = (1.0 - f.x) * f.y;
+    bilinear[3] = f.x * f.y;
+
+    // The hit with the largest bilinear weight sets the reference depth; the fragment is
+    // covered when hits make up at least half of the footprint
+    float depths[4];
+    float reference = 0.0;
+    float referenceWeight = 0.0;
+    float coverage = 0.0;
+    for (int i = 0; i < 4; i++) {
+        depths[i] = texelFetch(marchDepth, coords[i], 0).r;
+        if (depths[i] <= 0.0) continue;
+
+        coverage += bilinear[i];
+        if (bilinear[i] > referenceWeight) {
+            referenceWeight = bilinear[i];
+            reference = depths[i];
+        }
+    }
+    if (coverage < 0.5) discard;
+
+    vec3 color = vec3(0.0);
+    float depth = 0.0;
+    float total = 0.0;
+    for (int i = 0; i < 4; i++) {
+        if (depths[i] <= 0.0) continue;
+
+        float similarity = max(1.0 - abs(depths[i] - reference) / (reference * DEPTH_TOLERANCE), 0.0);
+        float weight = bilinear[i] * similarity;
+        color += texelFetch(marchColor, coords[i], 0).rgb * weight;
+        depth += depths[i] * weight;
+        total += weight;
+    }
+    color /= total;
+    depth /= total;
+
+    // Linear view depth to window depth with the scene's projection
+    float ndcDepth = (projection[2][2] * -depth + projection[3][2]) / depth;
+    gl_FragDepth = ndcDepth * 0.5 + 0.5;
+    FragColor = vec4(color, 1.0);
+}
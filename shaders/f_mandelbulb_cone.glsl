@@ -0,0 +1,90 @@
+#version 410 core
+
+// Cone-marching pre-pass of MandelbulbRenderer: one fragment per tile of the march target.
+// A cone that encloses every ray of the tile is stepped through the distance field, and
+// the distance that all of those rays can safely skip is written out; -1 when the whole
+// cone leaves the bounding sphere without getting near the surface.
+out float startDistance;
+
+uniform mat4 inverseViewProjection;
+uniform vec3 viewPos;
+uniform vec2 targetSize;    // Pixels of the march target
+uniform float pixelAngle;   // Width of one march pixel per unit of distance
+uniform int tileSize;       // March pixels per tile side
+
+uniform vec3 bulbCenter;
+uniform float bulbScale;    // World units per fractal unit
+uniform float bulbRadius;   // Bounding sphere in fractal units
+uniform float time;
+
+const int CONE_STEPS = 48;
+
+// Same estimator as f_room_psychedelic.glsl
+float mandelbulbDE(vec3 pos, float power) {
+    vec3 z = pos;
+    float dr = 1.0;
+    float r = 0.0;
+
+    for (int i = 0; i < 7; i++) {
+        r = length(z);
+        if (r > 2.0) break;
+
+        float theta = (r > 0.0001) ? acos(clamp(z.z / r, -1.0, 1.0)) : 0.0;
+        float phi = atan(z.y, z.x);
+        dr = pow(max(r, 0.0001), power - 1.0) * power * dr + 1.0;
+
+        float zr = pow(r, power);
+        theta = theta * power;
+        phi = phi * power;
+
+        z = zr * vec3(sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta));
+        z += pos;
+    }
+    return 0.5 * log(max(r, 0.0001)) * r / max(dr, 0.0001);
+}
+
+// Entry and exit distance along a unit ray; exit < 0 when the sphere is missed
+vec2 sphereInterval(vec3 origin, vec3 direction, float radius) {
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - radius * radius;
+    float h = b * b - c;
+    if (h < 0.0) return vec2(-1.0);
+    h = sqrt(h);
+    return vec2(-b - h, -b + h);
+}
+
+void main()
+{
+    // Ray through the tile centre, in fractal units
+    vec2 pixel = gl_FragCoord.xy * float(tileSize);
+    vec4 farPoint = inverseViewProjection * vec4(pixel / targetSize * 2.0 - 1.0, 1.0, 1.0);
+    vec3 direction = normalize(farPoint.xyz / farPoint.w - viewPos);
+    vec3 origin = (viewPos - bulbCenter) / bulbScale;
+
+    // Cone radius per unit of distance: half the tile diagonal
+    float coneSlope = pixelAngle * float(tileSize) * 0.7072;
+
+    // Widen the sphere by the largest cone radius inside it so no ray of the tile is lost
+    float reach = coneSlope * (length(origin) + bulbRadius);
+    vec2 span = sphereInterval(origin, direction, bulbRadius + reach);
+    if (span.y < 0.0) {
+        startDistance = -1.0;
+        return;
+    }
+
+    float power = 8.0 + 4.0 * sin(time * 0.1);
+    float t = max(span.x, 0.0);
+    for (int i = 0; i < CONE_STEPS; i++) {
+        float d = mandelbulbDE(origin + direction * t, power);
+        float cone = coneSlope * t;
+        if (d <= cone * 2.0) break;
+
+        // Largest step that keeps the whole cone cross-section inside the empty ball
+        t += (d - cone) / (1.0 + coneSlope);
+        if (t > span.y) {
+            startDistance = -1.0;
+            return;
+        }
+    }
+    startDistance = t;
+}
@@ -0,0 +1,145 @@
+#version 410 core
+
+// Half-resolution sphere tracing of the Mandelbulb (MandelbulbRenderer). Each ray starts at
+// the later of its bounding-sphere entry and its tile's cone-pass distance, then steps with
+// over-relaxation, falling back to plain sphere tracing when a step overshoots.
+layout(location = 0) out vec4 marchColor;
+layout(location = 1) out float marchDepth;  // Linear view depth of the hit, 0 for none
+
+uniform mat4 inverseViewProjection;
+uniform mat4 viewProjection;
+uniform vec3 viewPos;
+uniform vec2 targetSize;
+uniform float pixelAngle;
+uniform int tileSize;
+uniform sampler2D tileStart;
+
+uniform vec3 bulbCenter;
+uniform float bulbScale;
+uniform float bulbRadius;
+uniform float time;
+
+const int MAX_STEPS = 96;
+const float RELAXATION = 1.6;
+
+// Same estimator as f_room_psychedelic.glsl
+float mandelbulbDE(vec3 pos, float power) {
+    vec3 z = pos;
+    float dr = 1.0;
+    float r = 0.0;
+
+    for (int i = 0; i < 7; i++) {
+        r = length(z);
+        if (r > 2.0) break;
+
+        float theta = (r > 0.0001) ? acos(clamp(z.z / r, -1.0, 1.0)) : 0.0;
+        float phi = atan(z.y, z.x);
+        dr = pow(max(r, 0.0001), power - 1.0) * power * dr + 1.0;
+
+        float zr = pow(r, power);
+        theta = theta * power;
+        phi = phi * power;
+
+        z = zr * vec3(sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta));
+        z += pos;
+    }
+    return 0.5 * log(max(r, 0.0001)) * r / max(dr, 0.0001);
+}
+
+vec2 sphereInterval(vec3 origin, vec3 direction, float radius) {
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - radius * radius;
+    float h = b * b - c;
+    if (h < 0.0) return vec2(-1.0);
+    h = sqrt(h);
+    return vec2(-b - h, -b + h);
+}
+
+// Gradient of the estimator from four tetrahedral taps
+vec3 estimateNormal(vec3 p, float power, float epsilon) {
+    const vec2 k = vec2(1.0, -1.0);
+    return normalize(k.xyy * mandelbulbDE(p + k.xyy * epsilon, power) +
+                     k.yyx * mandelbulbDE(p + k.yyx * epsilon, power) +
+                     k.yxy * mandelbulbDE(p + k.yxy * epsilon, power) +
+                     k.xxx * mandelbulbDE(p + k.xxx * epsilon, power));
+}
+
+void miss()
+{
+    marchColor = vec4(0.0);
+    marchDepth = 0.0;
+}
+
+void main()
+{
+    vec4 farPoint = inverseViewProjection * vec4(gl_FragCoord.xy / targetSize * 2.0 - 1.0, 1.0, 1.0);
+    vec3 direction = normalize(farPoint.xyz / farPoint.w - viewPos);
+    vec3 origin = (viewPos - bulbCenter) / bulbScale;
+
+    // Bounding-sphere early-out
+    vec2 span = sphereInterval(origin, direction, bulbRadius);
+    if (span.y < 0.0) {
+        miss();
+        return;
+    }
+
+    float start = texelFetch(tileStart, ivec2(gl_FragCoord.xy) / tileSize, 0).r;
+    if (start < 0.0) {
+        miss();
+        return;
+    }
+
+    float power = 8.0 + 4.0 * sin(time * 0.1);
+    float t = max(max(span.x, 0.0), start);
+
+    // Relaxed sphere tracing (Keinert et al. 2014): step RELAXATION times the distance
+    // while consecutive unbounding spheres overlap; otherwise undo the step and continue
+    // unrelaxed
+    float omega = RELAXATION;
+    float previousRadius = 0.0;
+    float stepLength = 0.0;
+    float pixelRadius = pixelAngle * 0.5;
+    bool hit = false;
+    int steps = 0;
+
+    for (; steps < MAX_STEPS; steps++) {
+        float radius = mandelbulbDE(origin + direction * t, power);
+        bool overshot = omega > 1.0 && radius + previousRadius < stepLength;
+        if (overshot) {
+            stepLength -= omega * stepLength;
+            omega = 1.0;
+        }
+        else {
+            stepLength = radius * omega;
+        }
+        previousRadius = radius;
+
+        if (!overshot && radius < pixelRadius * t) {
+            hit = true;
+            break;
+        }
+        t += stepLength;
+        if (t > span.y) break;
+    }
+
+    if (!hit) {
+        miss();
+        return;
+    }
+
+    vec3 p = origin + direction * t;
+    vec3 normal = estimateNormal(p, power, max(pixelRadius * t, 0.0005));
+
+    // Iridescent colouring in the spirit of the room shader; the step count stands in for
+    // ambient occlusion
+    float occlusion = 1.0 - float(steps) / float(MAX_STEPS);
+    vec3 base = 0.5 + 0.5 * sin(vec3(0.0, 2.0, 4.0) + length(p) * 6.0 + time);
+    vec3 lightDirection = normalize(vec3(0.4, 0.8, 0.3));
+    float diffuse = max(dot(normal, lightDirection), 0.0);
+    float rim = pow(1.0 - max(dot(normal, -direction), 0.0), 3.0);
+    vec3 color = base * (0.25 + 0.75 * diffuse) * occlusion + vec3(0.2, 0.5, 0.8) * rim;
+
+    vec3 worldHit = bulbCenter + p * bulbScale;
+    marchColor = vec4(color, 1.0);
+    marchDepth = (viewProjection * vec4(worldHit, 1.0)).w;
+}
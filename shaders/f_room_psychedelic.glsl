@@ -10,6 +10,20 @@ uniform float time;
 uniform int roomType;
 uniform float roomIntensity;
 
+// Precomputed fbm (NoiseVolume), tiling every noiseVolumePeriod noise units
+uniform sampler3D noiseVolume;
+uniform float noiseVolumePeriod;
+uniform bool useNoiseVolume;
+
+// Baked mandelbulbDE (MandelbulbVolume) over a world-space box at the two keyframes of the
+// power around the current time
+uniform sampler3D mandelbulbVolumeA;
+uniform sampler3D mandelbulbVolumeB;
+uniform float mandelbulbBlend;
+uniform vec3 mandelbulbVolumeMin;
+uniform float mandelbulbVolumeSize;
+uniform bool useMandelbulbVolume;
+
 // Noise functions for fractal generation
 float hash(float n) {
     return fract(sin(n) * 43758.5453);
@@ -41,6 +55,14 @@ float fbm(vec3 x) {
     return v;
 }
 
+// fbm from the noise volume when available, evaluated analytically otherwise
+float fbmPattern(vec3 x) {
+    if (useNoiseVolume) {
+        return texture(noiseVolume, x / noiseVolumePeriod).r;
+    }
+    return fbm(x);
+}
+
 // Distance estimator functions for ray marching fractals
 float mandelbulbDE(vec3 pos, float power) {
     vec3 z = pos;
@@ -68,6 +90,17 @@ float mandelbulbDE(vec3 pos, float power) {
     return 0.5 * log(max(r, 0.0001)) * r / max(dr, 0.0001);
 }
 
+// Distance estimate at a world position, from the baked volumes inside their box
+float mandelbulbDistance(vec3 position, float power) {
+    if (useMandelbulbVolume) {
+        vec3 uvw = (position - mandelbulbVolumeMin) / mandelbulbVolumeSize;
+        if (all(greaterThanEqual(uvw, vec3(0.0))) && all(lessThanEqual(uvw, vec3(1.0)))) {
+            return mix(texture(mandelbulbVolumeA, uvw).r, texture(mandelbulbVolumeB, uvw).r, mandelbulbBlend);
+        }
+    }
+    return mandelbulbDE(position * 0.1, power);
+}
+
 // Apply different effects based on room type
 vec3 applyRoomEffect(vec3 position, vec3 normal, float t) {
     vec3 color = vec3(0.5);
@@ -76,8 +109,8 @@ vec3 applyRoomEffect(vec3 position, vec3 normal, float t) {
     case 1: // Mandelbulb Fractal Space
     {
         // Fractal coloring based on position and time
-        float dist = mandelbulbDE(position * 0.1, 8.0 + 4.0 * sin(t * 0.1));
-        float pattern = fbm(position * 0.2 + t * 0.1);
+        float dist = mandelbulbDistance(position, 8.0 + 4.0 * sin(t * 0.1));
+        float pattern = fbmPattern(position * 0.2 + t * 0.1);
 
         // Create iridescent colors
         color.r = 0.5 + 0.5 * sin(pattern * 5.0 + t + 0.0);
@@ -260,7 +293,7 @@ vec3 applyRoomEffect(vec3 position, vec3 normal, float t) {
         p *= scale;
 
         // Apply fractal noise
-        float pattern = fbm(p * 1.0 + t * 0.1);
+        float pattern = fbmPattern(p * 1.0 + t * 0.1);
 
         // DMT-inspired color palette
         color = vec3(
@@ -0,0 +1,77 @@
+#version 410 core
+// Builds the cube of each surviving instance (InstanceCuller), with the same faces,
+// warp and outputs as the cube mesh through v_room_instanced.glsl
+layout(points) in;
+layout(triangle_strip, max_vertices = 24) out;
+
+in vec4 vModel0[];
+in vec4 vModel1[];
+in vec4 vModel2[];
+in vec4 vModel3[];
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+// Per face: normal, then four corners in strip order with their texture coordinates
+const vec3 FACE_NORMALS[6] = vec3[6](
+    vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0), vec3(-1.0, 0.0, 0.0),
+    vec3(1.0, 0.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 1.0, 0.0));
+
+const vec3 FACE_CORNERS[24] = vec3[24](
+    vec3(-0.5, -0.5, 0.5), vec3(0.5, -0.5, 0.5), vec3(-0.5, 0.5, 0.5), vec3(0.5, 0.5, 0.5),
+    vec3(-0.5, -0.5, -0.5), vec3(0.5, -0.5, -0.5), vec3(-0.5, 0.5, -0.5), vec3(0.5, 0.5, -0.5),
+    vec3(-0.5, -0.5, 0.5), vec3(-0.5, 0.5, 0.5), vec3(-0.5, -0.5, -0.5), vec3(-0.5, 0.5, -0.5),
+    vec3(0.5, -0.5, 0.5), vec3(0.5, 0.5, 0.5), vec3(0.5, -0.5, -0.5), vec3(0.5, 0.5, -0.5),
+    vec3(-0.5, -0.5, 0.5), vec3(0.5, -0.5, 0.5), vec3(-0.5, -0.5, -0.5), vec3(0.5, -0.5, -0.5),
+    vec3(-0.5, 0.5, 0.5), vec3(0.5, 0.5, 0.5), vec3(-0.5, 0.5, -0.5), vec3(0.5, 0.5, -0.5));
+
+const vec2 CORNER_TEXCOORDS[4] = vec2[4](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0));
+
+// Same warp as v_room_instanced.glsl
+vec3 warp(vec3 position)
+{
+    if (position.y > 0.0) {
+        float dist = length(position.xz);
+
+        float warpFactor = sin(dist * 0.5 - time * 0.8) * 0.1;
+        position.y += warpFactor * position.y;
+
+        float angle = dist * 0.1 + time * 0.2;
+        float sinA = sin(angle);
+        float cosA = cos(angle);
+
+        vec3 warpedPos = position;
+        warpedPos.x = position.x * cosA - position.z * sinA * 0.2;
+        warpedPos.z = position.z * cosA + position.x * sinA * 0.2;
+
+        position = mix(position, warpedPos, min(1.0, dist * 0.05));
+    }
+    return position;
+}
+
+void main()
+{
+    mat4 model = mat4(vModel0[0], vModel1[0], vModel2[0], vModel3[0]);
+    mat4 viewProjection = projection * view;
+
+    // Once per instance instead of once per vertex
+    mat3 normalMatrix = mat3(transpose(inverse(model)));
+
+    for (int face = 0; face < 6; face++) {
+        vec3 normal = normalMatrix * FACE_NORMALS[face];
+        for (int corner = 0; corner < 4; corner++) {
+            FragPos = vec3(model * vec4(warp(FACE_CORNERS[face * 4 + corner]), 1.0));
+            Normal = normal;
+            TexCoord = CORNER_TEXCOORDS[corner];
+            gl_Position = viewProjection * vec4(FragPos, 1.0);
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
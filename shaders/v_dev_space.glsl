@@ -0,0 +1,239 @@
+#version 410 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+// Per-instance: x = object kind, y/z = grid or wall coordinates, w = unused
+layout(location = 3) in vec4 aInstance;
+// Per-instance: offset of the area the object belongs to
+layout(location = 4) in vec3 aOrigin;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+uniform float nonEuclideanFactor;
+uniform bool nonEuclideanEnabled;
+
+const float PI = 3.14159;
+
+// Object kinds, matching DevSpace::initialize
+const int GRID_A = 0;
+const int GRID_B = 1;
+const int WALL_A = 2;
+const int WALL_B = 3;
+const int ORBIT_A = 4;
+const int ORBIT_B = 5;
+
+mat4 translation(vec3 offset)
+{
+    mat4 m = mat4(1.0);
+    m[3] = vec4(offset, 1.0);
+    return m;
+}
+
+mat4 scaling(vec3 factors)
+{
+    return mat4(vec4(factors.x, 0.0, 0.0, 0.0),
+                vec4(0.0, factors.y, 0.0, 0.0),
+                vec4(0.0, 0.0, factors.z, 0.0),
+                vec4(0.0, 0.0, 0.0, 1.0));
+}
+
+// Same as glm::rotate: angle in radians around an axis of any length
+mat4 rotation(float angle, vec3 axis)
+{
+    vec3 a = normalize(axis);
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 t = (1.0 - c) * a;
+
+    return mat4(vec4(c + t.x * a.x, t.x * a.y + s * a.z, t.x * a.z - s * a.y, 0.0),
+                vec4(t.y * a.x - s * a.z, c + t.y * a.y, t.y * a.z + s * a.x, 0.0),
+                vec4(t.z * a.x + s * a.y, t.z * a.y - s * a.x, c + t.z * a.z, 0.0),
+                vec4(0.0, 0.0, 0.0, 1.0));
+}
+
+// Compression, vertical warp and angular twist of area A
+vec3 nonEuclideanTransformation(vec3 position)
+{
+    // Distance from origin in xz plane
+    float dist = length(position.xz);
+    vec3 newPos = position;
+
+    // Areas far from origin are compressed
+    if (dist > 5.0) {
+        float compressionFactor = 1.0 - 0.1 * nonEuclideanFactor * (dist - 5.0) / 10.0;
+        compressionFactor = max(compressionFactor, 0.5);
+        newPos.xz = normalize(position.xz) * dist * compressionFactor;
+    }
+
+    // Subtle spatial distortions that intensify with distance
+    float warpFactor = sin(dist * 0.2 + time * 0.3) * 0.2 * nonEuclideanFactor;
+    newPos.y += warpFactor * position.y;
+
+    // Turning right 4 times doesn't bring you back to start
+    float angle = atan(position.z, position.x);
+    float rotAmount = sin(angle * 4.0 + time * 0.1) * 0.05 * nonEuclideanFactor;
+    float rotatedX = position.x * cos(rotAmount) - position.z * sin(rotAmount);
+    float rotatedZ = position.x * sin(rotAmount) + position.z * cos(rotAmount);
+    newPos.x = mix(newPos.x, rotatedX, 0.5);
+    newPos.z = mix(newPos.z, rotatedZ, 0.5);
+
+    return newPos;
+}
+
+mat4 gridCubeA(float i, float j)
+{
+    vec3 position = nonEuclideanTransformation(aOrigin + vec3(i * 2.0, 0.5, j * 2.0));
+    float rotAngle = sin(time * 0.5 + i * 0.7 + j * 0.5) * 20.0 * nonEuclideanFactor;
+    return translation(position) * rotation(radians(rotAngle), vec3(0.0, 1.0, 0.0));
+}
+
+mat4 gridCubeB(float i, float j)
+{
+    // Spiral distortion around the area centre
+    vec2 local = vec2(i * 2.0, j * 2.0);
+    float dist = length(local);
+    float angle = atan(local.y, local.x) + sin(dist * 0.5) * 0.3 * nonEuclideanFactor;
+
+    vec3 position = aOrigin + vec3(dist * cos(angle), 0.5, dist * sin(angle));
+    position.y += sin(dist * 0.8 + time * 0.6) * 0.4 * nonEuclideanFactor;
+
+    vec3 scale = 1.0 + vec3(sin(time * 0.3 + i * 0.6),
+                            cos(time * 0.4 + j * 0.5),
+                            sin(time * 0.5 + (i + j) * 0.4)) * 0.2 * nonEuclideanFactor;
+    float rotAngle = cos(time * 0.4 + i * 0.5 + j * 0.3) * 30.0 * nonEuclideanFactor;
+
+    return translation(position) * scaling(scale) * rotation(radians(rotAngle), vec3(0.0, 1.0, 0.0));
+}
+
+mat4 wallSectionA(float x)
+{
+    // Curved wall that should be straight in Euclidean space
+    float bend = sin(x * 0.2 + time * 0.2) * 2.0 * nonEuclideanFactor;
+    float rotAngle = cos(x * 0.2 + time * 0.2) * 15.0 * nonEuclideanFactor;
+
+    return translation(aOrigin + vec3(x, 2.0, -10.0 + bend)) *
+        rotation(radians(rotAngle), vec3(0.0, 1.0, 0.0)) *
+        scaling(vec3(1.0, 4.0, 0.2));
+}
+
+mat4 wallSectionB(float x)
+{
+    // Wall that seems to fold into itself
+    float fold = sin(x * 0.3 + time * 0.3) * 3.0 * nonEuclideanFactor;
+    float yOffset = cos(x * 0.3 + time * 0.15) * 1.0 * nonEuclideanFactor;
+    float twistAngle = sin(x * 0.2 + time * 0.25) * 40.0 * nonEuclideanFactor;
+    float scaleY = 4.0 + sin(x * 0.4 + time * 0.2) * 1.0 * nonEuclideanFactor;
+
+    return translation(aOrigin + vec3(x, 2.0 + yOffset, 10.0 - fold)) *
+        rotation(radians(twistAngle), vec3(0.0, 0.0, 1.0)) *
+        scaling(vec3(1.0, scaleY, 0.2));
+}
+
+mat4 floatingObject(int kind, float i)
+{
+    float angle = i * (2.0 * PI / 10.0) + time * 0.2;
+    float radius = 8.0 + sin(time * 0.5 + i * 0.5) * 2.0;
+    float height = 2.0 + sin(time * 0.3 + i * 0.4) * 1.5;
+
+    // Klein bottle-inspired trajectory (objects seem to pass through themselves);
+    // the shrunk radius is shared with the area B orbit
+    float distortedAngle = angle + sin(i * 0.7 + time * 0.4) * nonEuclideanFactor;
+    if (distortedAngle > PI && distortedAngle < 2.0 * PI) {
+        radius *= (1.0 - (distortedAngle - PI) / PI * 0.5 * nonEuclideanFactor);
+    }
+
+    if (kind == ORBIT_A) {
+        vec3 position = aOrigin + vec3(
+            sin(distortedAngle) * radius,
+            height * (1.0 + cos(distortedAngle * 2.0) * 0.3 * nonEuclideanFactor),
+            cos(distortedAngle) * radius);
+        float scale = 0.5 + sin(time * 0.6 + i) * 0.2;
+
+        return translation(position) *
+            rotation(time + i, vec3(sin(i * 0.5), cos(i * 0.3), sin(i * 0.7))) *
+            scaling(vec3(scale));
+    }
+
+    vec3 position = aOrigin + vec3(sin(angle + PI) * radius, height * 1.2, cos(angle + PI) * radius);
+    if (nonEuclideanEnabled) {
+        // Figure-8 patterns that shouldn't be possible in normal space
+        float loopFactor = sin(time * 0.3 + i * 0.5) * nonEuclideanFactor;
+        position = aOrigin + vec3(
+            sin(angle * 2.0) * radius * (0.5 + 0.5 * cos(angle)),
+            height * (1.0 + sin(angle * 3.0) * 0.4 * nonEuclideanFactor),
+            cos(angle) * radius * (1.0 + loopFactor * sin(angle * 2.0)));
+    }
+    float scale = 0.6 + cos(time * 0.5 + i) * 0.2;
+
+    return translation(position) *
+        rotation(time * 0.8 + i, vec3(cos(i * 0.4), sin(i * 0.6), cos(i * 0.5))) *
+        scaling(vec3(scale));
+}
+
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main()
+{
+    int kind = int(aInstance.x + 0.5);
+
+    mat4 model;
+    if (kind == GRID_A) {
+        model = gridCubeA(aInstance.y, aInstance.z);
+    }
+    else if (kind == GRID_B) {
+        model = gridCubeB(aInstance.y, aInstance.z);
+    }
+    else if (kind == WALL_A) {
+        model = wallSectionA(aInstance.y);
+    }
+    else if (kind == WALL_B) {
+        model = wallSectionB(aInstance.y);
+    }
+    else {
+        model = floatingObject(kind, aInstance.y);
+    }
+
+    // Same vertex warping as v_warping.glsl for objects above the floor
+    vec3 position = aPos;
+    if (position.y > 0.0) {
+        float dist = length(position.xz);
+
+        float warpFactor = sin(dist * 0.5 - time * 0.8) * 0.1;
+        position.y += warpFactor * position.y;
+
+        float angle = dist * 0.1 + time * 0.2;
+        float sinA = sin(angle);
+        float cosA = cos(angle);
+
+        vec3 warpedPos = position;
+        warpedPos.x = position.x * cosA - position.z * sinA * 0.2;
+        warpedPos.z = position.z * cosA + position.x * sinA * 0.2;
+
+        position = mix(position, warpedPos, min(1.0, dist * 0.05));
+    }
+
+    // Transform to world space
+    FragPos = vec3(model * vec4(position, 1.0));
+
+    // Transform normal to world space
+    Normal = mat3(transpose(inverse(model))) * decodeNormal(aNormal);
+
+    // Pass texture coordinates
+    TexCoord = aTexCoord;
+
+    // Final position
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#version 410 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+uniform int roomType;
+uniform float roomIntensity;
+
+// One node per instance, two texels each (FractalHierarchy):
+//   2n      child offset in units of the parent's size, scale relative to the parent
+//   2n + 1  parent index (-1 for the root), level
+uniform samplerBuffer nodes;
+uniform vec3 rootCenter;
+uniform float rootSize;
+// Smallest node height, as a fraction of the viewport height, that is drawn
+uniform float minScreenSize;
+
+// Matches FractalHierarchy::MAX_DEPTH
+const int MAX_DEPTH = 8;
+
+// Same as glm::rotate: angle in radians around an axis of any length
+mat4 rotation(float angle, vec3 axis)
+{
+    vec3 a = normalize(axis);
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 t = (1.0 - c) * a;
+
+    return mat4(vec4(c + t.x * a.x, t.x * a.y + s * a.z, t.x * a.z - s * a.y, 0.0),
+                vec4(t.y * a.x - s * a.z, c + t.y * a.y, t.y * a.z + s * a.x, 0.0),
+                vec4(t.z * a.x + s * a.y, t.z * a.y - s * a.x, c + t.z * a.z, 0.0),
+                vec4(0.0, 0.0, 0.0, 1.0));
+}
+
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main()
+{
+    int node = gl_InstanceID;
+    vec4 shape = texelFetch(nodes, node * 2);
+    vec4 links = texelFetch(nodes, node * 2 + 1);
+    float level = links.y;
+
+    // Walk up the parent chain; offset ends up in units of the root size
+    vec3 offset = shape.xyz;
+    float scale = shape.w;
+    int parent = int(links.x);
+    for (int i = 0; i < MAX_DEPTH && parent >= 0; i++) {
+        vec4 parentShape = texelFetch(nodes, parent * 2);
+        offset = parentShape.xyz + parentShape.w * offset;
+        scale *= parentShape.w;
+        parent = int(texelFetch(nodes, parent * 2 + 1).x);
+    }
+
+    vec3 center = rootCenter + offset * rootSize;
+    float size = scale * rootSize;
+
+    // Nodes that would cover less than the cut-off are moved outside the clip volume
+    float viewDistance = -(view * vec4(center, 1.0)).z;
+    if (viewDistance > 0.0 && size * projection[1][1] * 0.5 / viewDistance < minScreenSize) {
+        FragPos = center;
+        Normal = vec3(0.0, 1.0, 0.0);
+        TexCoord = aTexCoord;
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+
+    // Deeper levels spin faster around a shared, slowly drifting axis
+    vec3 axis = vec3(sin(time * 0.3), cos(time * 0.2), sin(time * 0.1));
+    mat3 basis = mat3(rotation(time * (level + 1.0) * 0.1, axis)) * size;
+
+    // Same vertex warping as v_room_instanced.glsl
+    vec3 position = aPos;
+    if (position.y > 0.0) {
+        float dist = length(position.xz);
+
+        float warpFactor = sin(dist * 0.5 - time * 0.8) * 0.1;
+        position.y += warpFactor * position.y;
+
+        float angle = dist * 0.1 + time * 0.2;
+        float sinA = sin(angle);
+        float cosA = cos(angle);
+
+        vec3 warpedPos = position;
+        warpedPos.x = position.x * cosA - position.z * sinA * 0.2;
+        warpedPos.z = position.z * cosA + position.x * sinA * 0.2;
+
+        position = mix(position, warpedPos, min(1.0, dist * 0.05));
+    }
+
+    // Transform to world space
+    FragPos = center + basis * position;
+
+    // Uniform scale: the rotation alone carries the normal
+    Normal = basis * decodeNormal(aNormal) / size;
+
+    // Pass texture coordinates
+    TexCoord = aTexCoord;
+
+    // Final position
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,50 @@
+#version 410 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+layout(location = 3) in mat4 aTile;  // Camera-relative isometry of the tile (hyperboloid model)
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model;  // Placement inside the tile, in Klein units
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform float time;
+uniform int roomType;
+uniform float roomIntensity;
+
+// World units per unit of hyperbolic distance
+uniform float hyperbolicScale;
+
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main()
+{
+    // Klein coordinates are homogeneous hyperboloid coordinates: (x, y, z, 1) is a point of
+    // the space, and isometries act on it linearly
+    vec4 point = aTile * model * vec4(aPos, 1.0);
+
+    // The camera sits at the origin, so dividing by w is the perspective it sees. Only the
+    // rotation of the Euclidean view applies; its position is already in aTile.
+    vec3 eye = mat3(view) * point.xyz * hyperbolicScale;
+    gl_Position = projection * vec4(eye, point.w);
+
+    // Lit and patterned as if the Klein image stood around the player in the room
+    FragPos = viewPos + point.xyz / point.w * hyperbolicScale;
+
+    // Good enough near the camera, where the lighting is seen
+    Normal = mat3(aTile * model) * decodeNormal(aNormal);
+
+    // Pass texture coordinates
+    TexCoord = aTexCoord;
+}
@@ -0,0 +1,63 @@
+#version 410 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+uniform int roomType;
+uniform float roomIntensity;
+
+// Which surface's time terms to apply: 0 none, 1 Klein bottle, 2 Mobius strip
+uniform int surfaceMotion;
+
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// Time-varying part of the surfaces' positions at parameter uv; must match the motion
+// terms of the Surface callables in RoomManager
+vec3 surfaceOffset(vec2 uv, float t)
+{
+    float a = uv.x * 6.28318;
+
+    if (surfaceMotion == 1) {
+        // The neck sways around the ring while the whole bottle bobs
+        float neck = 0.5 - 0.5 * cos(a);
+        return vec3(neck * 5.0 * sin(t * 0.2), sin(a * 3.0 + t * 0.5), -neck * 5.0 * cos(t * 0.2));
+    }
+    if (surfaceMotion == 2) {
+        // A wave runs around the strip
+        return vec3(0.0, sin(t * 0.2 + a), 0.0);
+    }
+    return vec3(0.0);
+}
+
+void main()
+{
+    // The mesh was tessellated at time 0; move it to the current time
+    vec3 position = aPos + surfaceOffset(aTexCoord, time) - surfaceOffset(aTexCoord, 0.0);
+
+    // Transform to world space
+    FragPos = vec3(model * vec4(position, 1.0));
+
+    // The offsets barely turn the surface, so the tessellated normal is kept
+    Normal = mat3(model) * decodeNormal(aNormal);
+
+    // Pass texture coordinates
+    TexCoord = aTexCoord;
+
+    // Final position
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,67 @@
+#version 410 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+// Particle state written by v_particle_update.glsl, one particle per instance
+layout(location = 3) in vec4 aPositionAge;
+layout(location = 4) in vec4 aVelocitySeed;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+uniform int roomType;
+uniform float roomIntensity;
+
+// Same table as v_particle_update.glsl
+const int MAX_EMITTERS = 16;
+const int VEC4_PER_EMITTER = 6;
+uniform vec4 emitters[MAX_EMITTERS * VEC4_PER_EMITTER];
+uniform int emitterCount;
+
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+mat3 rotation(vec3 axis, float angle)
+{
+    float s = sin(angle), c = cos(angle), k = 1.0 - c;
+    return mat3(
+        k * axis.x * axis.x + c, k * axis.x * axis.y + s * axis.z, k * axis.x * axis.z - s * axis.y,
+        k * axis.x * axis.y - s * axis.z, k * axis.y * axis.y + c, k * axis.y * axis.z + s * axis.x,
+        k * axis.x * axis.z + s * axis.y, k * axis.y * axis.z - s * axis.x, k * axis.z * axis.z + c);
+}
+
+void main()
+{
+    float size = 0.0;
+    for (int e = 0; e < emitterCount; e++) {
+        vec4 slots = emitters[e * VEC4_PER_EMITTER + 2];
+        if (gl_InstanceID >= int(slots.x) && gl_InstanceID < int(slots.x + slots.y)) {
+            size = slots.w;
+        }
+    }
+
+    // Grow in over an eighth of a second; unborn and killed particles collapse to a point
+    float age = aPositionAge.w;
+    float scale = age < 0.0 ? 0.0 : size * min(age * 8.0, 1.0);
+
+    // Each particle tumbles around its own axis
+    float seed = aVelocitySeed.w;
+    vec3 axis = normalize(vec3(sin(seed * 53.0), cos(seed * 71.0), sin(seed * 29.0) + 1.5));
+    mat3 spin = rotation(axis, time * 2.0 + seed * 6.2831853);
+
+    FragPos = aPositionAge.xyz + spin * aPos * scale;
+    Normal = spin * decodeNormal(aNormal);
+    TexCoord = aTexCoord;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,146 @@
+#version 410 core
+// One particle per vertex; the outputs are captured into the other state buffer
+// (ParticleSystem), with rasterization discarded
+layout(location = 0) in vec4 aPositionAge;   // World position, seconds alive (negative: not born yet)
+layout(location = 1) in vec4 aVelocitySeed;  // Velocity, random seed in (0, 1) (0: never initialized)
+
+out vec4 outPositionAge;
+out vec4 outVelocitySeed;
+
+// ParticleSystem::MAX_EMITTERS rows of ParticleSystem::VEC4_PER_EMITTER:
+//   0: origin, type            1: target, lifetime
+//   2: first slot, capacity, active, size
+//   3: spread, stiffness, radius, sway
+//   4: turns, angular speed, height, -
+//   5: height frequency, -
+const int MAX_EMITTERS = 16;
+const int VEC4_PER_EMITTER = 6;
+uniform vec4 emitters[MAX_EMITTERS * VEC4_PER_EMITTER];
+uniform int emitterCount;
+
+uniform float time;
+uniform float deltaTime;
+uniform bool resetParticles;  // The slot layout changed: every particle starts over
+
+const float PI = 3.14159265;
+
+// Integer hash of a float's bits, uniform in [0, 1)
+float random(float seed, uint salt)
+{
+    uint h = floatBitsToUint(seed) * 747796405u + salt * 2891336453u;
+    h = ((h >> ((h >> 28u) + 4u)) ^ h) * 277803737u;
+    h = (h >> 22u) ^ h;
+    return float(h) / 4294967296.0;
+}
+
+vec3 randomInBall(float seed)
+{
+    float z = random(seed, 3u) * 2.0 - 1.0;
+    float a = random(seed, 4u) * 2.0 * PI;
+    float r = pow(random(seed, 5u), 1.0 / 3.0);
+    return r * vec3(sqrt(1.0 - z * z) * cos(a), z, sqrt(1.0 - z * z) * sin(a));
+}
+
+// Point of the emitter's guide curve at phase 0..1 (ParticleEmitter)
+vec3 guidePoint(int row, float phase)
+{
+    vec3 origin = emitters[row].xyz;
+    vec3 target = emitters[row + 1].xyz;
+    float radius = emitters[row + 3].z;
+    float sway = emitters[row + 3].w;
+
+    if (int(emitters[row].w) == 0) {
+        // Stream: an arc from origin to target, swaying sideways
+        vec3 side = cross(vec3(0.0, 1.0, 0.0), target - origin);
+        side = dot(side, side) > 1e-6 ? normalize(side) : vec3(1.0, 0.0, 0.0);
+        vec3 point = mix(origin, target, phase);
+        point.y += sin(phase * PI) * radius;
+        return point + side * sin(phase * 2.0 * PI) * sway;
+    }
+
+    // Orbit: a wobbling ring around origin, turning over time, with height along its normal
+    vec3 normal = target;
+    vec3 u = normalize(cross(normal, abs(normal.y) < 0.9 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 v = cross(normal, u);
+    float angle = phase * emitters[row + 4].x * 2.0 * PI + time * emitters[row + 4].y;
+    float ringRadius = radius * (1.0 + sway * cos(angle * 0.7));
+    float height = emitters[row + 4].z * sin(dot(emitters[row + 5].xyz, vec3(angle, phase, time)));
+    return origin + (u * cos(angle) + v * sin(angle)) * ringRadius + normal * height;
+}
+
+void main()
+{
+    vec3 position = aPositionAge.xyz;
+    float age = aPositionAge.w;
+    vec3 velocity = aVelocitySeed.xyz;
+    float seed = aVelocitySeed.w;
+
+    // The emitter owning this slot
+    int row = -1;
+    int slot = 0;
+    for (int e = 0; e < emitterCount; e++) {
+        int first = int(emitters[e * VEC4_PER_EMITTER + 2].x);
+        int capacity = int(emitters[e * VEC4_PER_EMITTER + 2].y);
+        if (gl_VertexID >= first && gl_VertexID < first + capacity) {
+            row = e * VEC4_PER_EMITTER;
+            slot = gl_VertexID - first;
+        }
+    }
+    if (row < 0) {
+        outPositionAge = vec4(position, -1.0);
+        outVelocitySeed = vec4(0.0, 0.0, 0.0, seed);
+        return;
+    }
+
+    float baseLifetime = emitters[row + 1].w;
+    float lifetime = baseLifetime * (0.75 + 0.5 * random(seed, 1u));
+
+    // New particles are born at a random point of their first lifetime, so emission is even
+    if (resetParticles || seed == 0.0) {
+        seed = max(random(float(gl_VertexID), 7u), 1e-6);
+        lifetime = baseLifetime * (0.75 + 0.5 * random(seed, 1u));
+        age = -random(seed, 2u) * lifetime;
+    }
+
+    // Killed: wait unborn until the emitter allows this slot again
+    if (float(slot) >= emitters[row + 2].z) {
+        outPositionAge = vec4(position, -random(seed, 2u) * lifetime - 1e-3);
+        outVelocitySeed = vec4(0.0, 0.0, 0.0, seed);
+        return;
+    }
+
+    bool born = age < 0.0;
+    age += deltaTime;
+    if (age < 0.0) {
+        outPositionAge = vec4(position, age);
+        outVelocitySeed = vec4(velocity, seed);
+        return;
+    }
+
+    // Respawn with a new seed when the lifetime runs out
+    if (age >= lifetime) {
+        seed = fract(seed + 0.61803399);
+        seed = seed == 0.0 ? 0.5 : seed;
+        lifetime = baseLifetime * (0.75 + 0.5 * random(seed, 1u));
+        age = 0.0;
+        born = true;
+    }
+
+    float phase = int(emitters[row].w) == 0 ? age / lifetime : random(seed, 6u);
+    vec3 target = guidePoint(row, phase) + randomInBall(seed) * emitters[row + 3].x;
+
+    if (born) {
+        position = target;
+        velocity = vec3(0.0);
+    }
+    else {
+        // Critically damped spring towards the moving guide, semi-implicit Euler
+        float stiffness = emitters[row + 3].y;
+        vec3 acceleration = stiffness * (target - position) - 2.0 * sqrt(stiffness) * velocity;
+        velocity += acceleration * deltaTime;
+        position += velocity * deltaTime;
+    }
+
+    outPositionAge = vec4(position, age);
+    outVelocitySeed = vec4(velocity, seed);
+}
@@ -1,6 +1,6 @@
 #version 410 core
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec2 aNormal;
 layout(location = 2) in vec2 aTexCoord;
 
 out vec3 FragPos;
@@ -12,14 +12,25 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform float time;
 
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
 void main()
 {
+    vec3 normal = decodeNormal(aNormal);
+
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = mat3(transpose(inverse(model))) * normal;
     TexCoord = aTexCoord;
 
-    // Add subtle movement to portal vertices for a "breathing" effect
-    vec3 offset = aNormal * sin(time * 1.5) * 0.02;
+    // Add subtle movement to portal vertices for a "breathing" effect (along the world normal)
+    vec3 offset = Normal * sin(time * 1.5) * 0.02;
     vec3 warpedPos = FragPos + offset;
 
     gl_Position = projection * view * vec4(warpedPos, 1.0);
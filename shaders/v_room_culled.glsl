@@ -0,0 +1,17 @@
+#version 410 core
+// One surviving instance per vertex, as written by g_instance_cull.glsl; the geometry
+// shader builds its cube
+layout(location = 3) in mat4 aModel;
+
+out vec4 vModel0;
+out vec4 vModel1;
+out vec4 vModel2;
+out vec4 vModel3;
+
+void main()
+{
+    vModel0 = aModel[0];
+    vModel1 = aModel[1];
+    vModel2 = aModel[2];
+    vModel3 = aModel[3];
+}
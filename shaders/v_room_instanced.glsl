@@ -0,0 +1,64 @@
+#version 410 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+// Per-instance model matrix, streamed every frame or static (occupies locations 3-6)
+layout(location = 3) in mat4 aModel;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+uniform int roomType;
+uniform float roomIntensity;
+
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main()
+{
+    // Original position
+    vec3 position = aPos;
+
+    // Apply warping based on room type and position
+    if (position.y > 0.0) {
+        // Calculate distance from origin in xz plane
+        float dist = length(position.xz);
+
+        // Basic warping effect
+        float warpFactor = sin(dist * 0.5 - time * 0.8) * 0.1;
+        position.y += warpFactor * position.y;
+
+        // Rotation effect
+        float angle = dist * 0.1 + time * 0.2;
+        float sinA = sin(angle);
+        float cosA = cos(angle);
+
+        vec3 warpedPos = position;
+        warpedPos.x = position.x * cosA - position.z * sinA * 0.2;
+        warpedPos.z = position.z * cosA + position.x * sinA * 0.2;
+
+        position = mix(position, warpedPos, min(1.0, dist * 0.05));
+    }
+
+    // Transform to world space
+    FragPos = vec3(aModel * vec4(position, 1.0));
+
+    // Transform normal to world space
+    Normal = mat3(transpose(inverse(aModel))) * decodeNormal(aNormal);
+
+    // Pass texture coordinates
+    TexCoord = aTexCoord;
+
+    // Final position
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#version 410 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+layout(location = 3) in mat4 aInstance;  // SO(4) placement on the 3-sphere
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+uniform mat4 model;         // Placement at (0, 0, 0, 1), in units of the radius
+uniform mat4 sphereMotion;  // This frame's rotation of the group, applied before aInstance
+uniform mat4 sphereView;    // Sphere to camera-relative coordinates
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform float time;
+uniform int roomType;
+uniform float roomIntensity;
+
+uniform float sphereRadius;   // World units per radian
+uniform int antipodalImage;   // 0: the direct image, 1: the one seen the long way round
+
+// Same near plane as the Euclidean projection, in world units
+const float NEAR_DISTANCE = 0.1;
+
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main()
+{
+    // (x, y, z, 1) near the origin is a homogeneous point of the sphere; rotations act on it
+    // linearly and the projection only needs ratios, so it is never normalized
+    mat4 placement = sphereView * aInstance * sphereMotion * model;
+    vec4 point = placement * vec4(aPos, 1.0);
+    if (antipodalImage == 1) point = -point;
+
+    // Direction from the projection; only the rotation of the Euclidean view applies
+    vec3 eye = mat3(view) * point.xyz;
+    vec4 clip = projection * vec4(eye, 0.0);
+
+    // Depth: -k w / t, with t = -eye.z the distance along the view axis, is -k cot(theta)
+    // on the axis, which rises from -inf to +inf as theta goes from 0 to pi and is -1 at
+    // the near plane. Each image then takes half of the depth range, the direct one the
+    // near half.
+    float depth = -(NEAR_DISTANCE / sphereRadius) * point.w;
+    clip.z = 0.5 * depth + (antipodalImage == 1 ? 0.5 : -0.5) * clip.w;
+    gl_Position = clip;
+
+    // Lit as if the point stood at its arc length from the player, in its direction
+    float arc = atan(length(point.xyz), point.w);
+    if (antipodalImage == 1) arc += 3.14159;  // -p is pi - theta away; the light came 2 pi - theta
+    vec3 direction = length(point.xyz) > 1e-6 ? normalize(point.xyz) : vec3(0.0);
+    FragPos = viewPos + direction * arc * sphereRadius;
+
+    Normal = mat3(placement) * decodeNormal(aNormal);
+
+    // Pass texture coordinates
+    TexCoord = aTexCoord;
+}
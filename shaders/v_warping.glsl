@@ -1,6 +1,6 @@
 #version 410 core
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec2 aNormal;
 layout(location = 2) in vec2 aTexCoord;
 
 out vec3 FragPos;
@@ -12,6 +12,15 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform float time;
 
+// Normals arrive octahedral encoded in two snorm16 values (MeshLibrary)
+vec3 decodeNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
 void main()
 {
     // Original position
@@ -45,7 +54,7 @@ void main()
     FragPos = vec3(model * vec4(position, 1.0));
 
     // Transform normal to world space
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = mat3(transpose(inverse(model))) * decodeNormal(aNormal);
 
     // Pass texture coordinates
     TexCoord = aTexCoord;
@@ -0,0 +1,284 @@
+#include "anim_math.h"
+#include "simd_ops.h"
+
+// Polynomials are the single precision minimax fits from the Cephes library, evaluated
+// branch-free so every Ops width runs exactly the same sequence of operations.
+
+namespace {
+    const float TWO_OVER_PI = 0.636619772367581f;
+    // pi/2 split into three parts so x - k*pi/2 stays exact for |k| < 2^13 (Cody-Waite)
+    const float HALF_PI_1 = 1.5703125f;
+    const float HALF_PI_2 = 4.837512969970703125e-4f;
+    const float HALF_PI_3 = 7.54978995489188216e-8f;
+
+    const float PI = 3.14159265358979f;
+    const float HALF_PI = 1.57079632679490f;
+    const float QUARTER_PI = 0.785398163397448f;
+    const float TAN_PI_8 = 0.414213562373095f;
+    const float SQRT_2 = 1.41421356237310f;
+    const float LOG2_E = 1.44269504088896f;
+
+    template <typename Ops>
+    typename Ops::Vec absolute(typename Ops::Vec a) {
+        return Ops::bitAnd(a, Ops::asFloat(Ops::set1I(0x7fffffff)));
+    }
+
+    template <typename Ops>
+    typename Ops::Vec signBit(typename Ops::Vec a) {
+        return Ops::bitAnd(a, Ops::asFloat(Ops::set1I((int32_t)0x80000000)));
+    }
+
+    template <typename Ops>
+    void sinCos(typename Ops::Vec x, typename Ops::Vec& sine, typename Ops::Vec& cosine) {
+        typedef typename Ops::Vec Vec;
+        typedef typename Ops::VecI VecI;
+
+        // Reduce to r in [-pi/4, pi/4] and the quadrant k
+        VecI k = Ops::roundToInt(Ops::mul(x, Ops::set1(TWO_OVER_PI)));
+        Vec kf = Ops::toFloat(k);
+        Vec r = Ops::sub(x, Ops::mul(kf, Ops::set1(HALF_PI_1)));
+        r = Ops::sub(r, Ops::mul(kf, Ops::set1(HALF_PI_2)));
+        r = Ops::sub(r, Ops::mul(kf, Ops::set1(HALF_PI_3)));
+        Vec r2 = Ops::mul(r, r);
+
+        Vec sinPoly = Ops::set1(-1.9515295891e-4f);
+        sinPoly = Ops::add(Ops::mul(sinPoly, r2), Ops::set1(8.3321608736e-3f));
+        sinPoly = Ops::add(Ops::mul(sinPoly, r2), Ops::set1(-1.6666654611e-1f));
+        sinPoly = Ops::add(Ops::mul(Ops::mul(sinPoly, r2), r), r);
+
+        Vec cosPoly = Ops::set1(2.443315711809948e-5f);
+        cosPoly = Ops::add(Ops::mul(cosPoly, r2), Ops::set1(-1.388731625493765e-3f));
+        cosPoly = Ops::add(Ops::mul(cosPoly, r2), Ops::set1(4.166664568298827e-2f));
+        cosPoly = Ops::mul(Ops::mul(cosPoly, r2), r2);
+        cosPoly = Ops::add(Ops::sub(Ops::set1(1.0f), Ops::mul(Ops::set1(0.5f), r2)), cosPoly);
+
+        // Odd quadrants swap sin and cos; quadrant bit 1 flips the sign
+        Vec swap = Ops::asFloat(Ops::subI(Ops::set1I(0), Ops::andI(k, Ops::set1I(1))));
+        Vec sinSign = Ops::asFloat(Ops::shiftLeftI(Ops::andI(k, Ops::set1I(2)), 30));
+        Vec cosSign = Ops::asFloat(Ops::shiftLeftI(Ops::andI(Ops::addI(k, Ops::set1I(1)), Ops::set1I(2)), 30));
+
+        sine = Ops::bitXor(Ops::select(swap, cosPoly, sinPoly), sinSign);
+        cosine = Ops::bitXor(Ops::select(swap, sinPoly, cosPoly), cosSign);
+    }
+
+    template <typename Ops>
+    typename Ops::Vec atan2(typename Ops::Vec y, typename Ops::Vec x) {
+        typedef typename Ops::Vec Vec;
+
+        Vec ax = absolute<Ops>(x);
+        Vec ay = absolute<Ops>(y);
+        Vec larger = Ops::max(ax, ay);
+        Vec smaller = Ops::min(ax, ay);
+
+        // t in [0, 1]; (0, 0) would divide by zero, so force t = 0 there
+        Vec t = Ops::div(smaller, larger);
+        t = Ops::bitAnd(Ops::cmpGt(larger, Ops::set1(0.0f)), t);
+
+        // Fold t > tan(pi/8) onto [-tan(pi/8), tan(pi/8)] via atan(t) = pi/4 + atan((t-1)/(t+1))
+        Vec folded = Ops::cmpGt(t, Ops::set1(TAN_PI_8));
+        t = Ops::select(folded, Ops::div(Ops::sub(t, Ops::set1(1.0f)), Ops::add(t, Ops::set1(1.0f))), t);
+        Vec offset = Ops::bitAnd(folded, Ops::set1(QUARTER_PI));
+
+        Vec z = Ops::mul(t, t);
+        Vec poly = Ops::set1(8.05374449538e-2f);
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(-1.38776856032e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(1.99777106478e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(-3.33329491539e-1f));
+        Vec angle = Ops::add(Ops::add(Ops::mul(Ops::mul(poly, z), t), t), offset);
+
+        // Undo the octant reduction
+        angle = Ops::select(Ops::cmpGt(ay, ax), Ops::sub(Ops::set1(HALF_PI), angle), angle);
+        // Negative x by its sign bit, so x = -0 gives pi like std::atan2
+        Vec negativeX = Ops::asFloat(Ops::subI(Ops::set1I(0), Ops::shiftRightI(Ops::asInt(x), 31)));
+        angle = Ops::select(negativeX, Ops::sub(Ops::set1(PI), angle), angle);
+        return Ops::bitOr(angle, signBit<Ops>(y));
+    }
+
+    template <typename Ops>
+    typename Ops::Vec exp2(typename Ops::Vec x) {
+        typedef typename Ops::Vec Vec;
+        typedef typename Ops::VecI VecI;
+
+        x = Ops::min(Ops::max(x, Ops::set1(-126.0f)), Ops::set1(127.0f));
+
+        // 2^x = 2^k * 2^f with f in [-0.5, 0.5]
+        VecI k = Ops::roundToInt(x);
+        Vec f = Ops::sub(x, Ops::toFloat(k));
+
+        Vec poly = Ops::set1(1.535336188319500e-4f);
+        poly = Ops::add(Ops::mul(poly, f), Ops::set1(1.339887440266574e-3f));
+        poly = Ops::add(Ops::mul(poly, f), Ops::set1(9.618437357674640e-3f));
+        poly = Ops::add(Ops::mul(poly, f), Ops::set1(5.550332471162809e-2f));
+        poly = Ops::add(Ops::mul(poly, f), Ops::set1(2.402264791363012e-1f));
+        poly = Ops::add(Ops::mul(poly, f), Ops::set1(6.931472028550421e-1f));
+        poly = Ops::add(Ops::mul(poly, f), Ops::set1(1.0f));
+
+        Vec scale = Ops::asFloat(Ops::shiftLeftI(Ops::addI(k, Ops::set1I(127)), 23));
+        return Ops::mul(poly, scale);
+    }
+
+    template <typename Ops>
+    typename Ops::Vec log2(typename Ops::Vec x) {
+        typedef typename Ops::Vec Vec;
+        typedef typename Ops::VecI VecI;
+
+        // x = 2^e * m with m in [sqrt(2)/2, sqrt(2))
+        VecI bits = Ops::asInt(x);
+        Vec e = Ops::toFloat(Ops::addI(Ops::shiftRightI(bits, 23), Ops::set1I(-127)));
+        Vec m = Ops::asFloat(Ops::addI(Ops::andI(bits, Ops::set1I(0x007fffff)), Ops::set1I(0x3f800000)));
+
+        Vec high = Ops::cmpGt(m, Ops::set1(SQRT_2));
+        m = Ops::select(high, Ops::mul(m, Ops::set1(0.5f)), m);
+        e = Ops::add(e, Ops::bitAnd(high, Ops::set1(1.0f)));
+
+        Vec z = Ops::sub(m, Ops::set1(1.0f));
+        Vec z2 = Ops::mul(z, z);
+
+        Vec poly = Ops::set1(7.0376836292e-2f);
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(-1.1514610310e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(1.1676998740e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(-1.2420140846e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(1.4249322787e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(-1.6668057665e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(2.0000714765e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(-2.4999993993e-1f));
+        poly = Ops::add(Ops::mul(poly, z), Ops::set1(3.3333331174e-1f));
+
+        // ln(m) = z - z^2/2 + z^3 * P(z)
+        Vec ln = Ops::mul(Ops::mul(poly, z2), z);
+        ln = Ops::sub(ln, Ops::mul(Ops::set1(0.5f), z2));
+        ln = Ops::add(ln, z);
+
+        return Ops::add(Ops::mul(ln, Ops::set1(LOG2_E)), e);
+    }
+
+    template <typename Ops>
+    typename Ops::Vec pow(typename Ops::Vec base, typename Ops::Vec exponent) {
+        // Non-positive bases return 0
+        typename Ops::Vec result = exp2<Ops>(Ops::mul(exponent, log2<Ops>(base)));
+        return Ops::bitAnd(Ops::cmpGt(base, Ops::set1(0.0f)), result);
+    }
+
+    // Run kernel over [0, count): full SIMD blocks first, scalar for the remainder
+    template <typename Kernel>
+    void forEachBlock(size_t count, Kernel kernel) {
+        size_t i = 0;
+        for (; i + SimdOps::LANES <= count; i += SimdOps::LANES) {
+            kernel(SimdOps(), i);
+        }
+        for (; i < count; i++) {
+            kernel(ScalarOps(), i);
+        }
+    }
+
+    struct SinKernel {
+        const float* x; float* out;
+        template <typename Ops> void operator()(Ops, size_t i) const {
+            typename Ops::Vec s, c;
+            sinCos<Ops>(Ops::load(x + i), s, c);
+            Ops::store(out + i, s);
+        }
+    };
+
+    struct CosKernel {
+        const float* x; float* out;
+        template <typename Ops> void operator()(Ops, size_t i) const {
+            typename Ops::Vec s, c;
+            sinCos<Ops>(Ops::load(x + i), s, c);
+            Ops::store(out + i, c);
+        }
+    };
+
+    struct SinCosKernel {
+        const float* x; float* sines; float* cosines;
+        template <typename Ops> void operator()(Ops, size_t i) const {
+            typename Ops::Vec s, c;
+            sinCos<Ops>(Ops::load(x + i), s, c);
+            Ops::store(sines + i, s);
+            Ops::store(cosines + i, c);
+        }
+    };
+
+    struct Atan2Kernel {
+        const float* y; const float* x; float* out;
+        template <typename Ops> void operator()(Ops, size_t i) const {
+            Ops::store(out + i, atan2<Ops>(Ops::load(y + i), Ops::load(x + i)));
+        }
+    };
+
+    struct Exp2Kernel {
+        const float* x; float* out;
+        template <typename Ops> void operator()(Ops, size_t i) const {
+            Ops::store(out + i, exp2<Ops>(Ops::load(x + i)));
+        }
+    };
+
+    struct PowKernel {
+        const float* base; const float* exponent; float* out;
+        template <typename Ops> void operator()(Ops, size_t i) const {
+            Ops::store(out + i, pow<Ops>(Ops::load(base + i), Ops::load(exponent + i)));
+        }
+    };
+}
+
+float fastSin(float x) {
+    float s, c;
+    sinCos<ScalarOps>(x, s, c);
+    return s;
+}
+
+float fastCos(float x) {
+    float s, c;
+    sinCos<ScalarOps>(x, s, c);
+    return c;
+}
+
+void fastSinCos(float x, float& sine, float& cosine) {
+    sinCos<ScalarOps>(x, sine, cosine);
+}
+
+float fastAtan2(float y, float x) {
+    return atan2<ScalarOps>(y, x);
+}
+
+float fastExp2(float x) {
+    return exp2<ScalarOps>(x);
+}
+
+float fastLog2(float x) {
+    return log2<ScalarOps>(x);
+}
+
+float fastPow(float base, float exponent) {
+    return pow<ScalarOps>(base, exponent);
+}
+
+void sinArray(const float* x, float* out, size_t count) {
+    SinKernel kernel = { x, out };
+    forEachBlock(count, kernel);
+}
+
+void cosArray(const float* x, float* out, size_t count) {
+    CosKernel kernel = { x, out };
+    forEachBlock(count, kernel);
+}
+
+void sinCosArray(const float* x, float* sines, float* cosines, size_t count) {
+    SinCosKernel kernel = { x, sines, cosines };
+    forEachBlock(count, kernel);
+}
+
+void atan2Array(const float* y, const float* x, float* out, size_t count) {
+    Atan2Kernel kernel = { y, x, out };
+    forEachBlock(count, kernel);
+}
+
+void exp2Array(const float* x, float* out, size_t count) {
+    Exp2Kernel kernel = { x, out };
+    forEachBlock(count, kernel);
+}
+
+void powArray(const float* base, const float* exponent, float* out, size_t count) {
+    PowKernel kernel = { base, exponent, out };
+    forEachBlock(count, kernel);
+}
@@ -0,0 +1,302 @@
+#include "command_list.h"
+#include "frame_arena.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+
+void CommandList::reset() {
+    draws.clear();
+    uniforms.clear();
+    drawUniforms.clear();
+    liveUniforms.clear();
+    materials.clear();
+    pendingHasCenter = false;
+}
+
+GLint CommandList::locate(unsigned int program, const std::string& name) {
+    std::pair<unsigned int, std::string> key(program, name);
+    auto it = locationCache.find(key);
+    if (it != locationCache.end()) return it->second;
+
+    GLint location = glGetUniformLocation(program, name.c_str());
+    locationCache[key] = location;
+    return location;
+}
+
+unsigned int CommandList::findViewBinding(unsigned int program) {
+    for (unsigned int i = 0; i < viewBindings.size(); i++) {
+        if (viewBindings[i].program == program) return i;
+    }
+
+    ViewBinding binding = {
+        program,
+        locate(program, "view"),
+        locate(program, "projection"),
+        locate(program, "viewPos")
+    };
+    viewBindings.push_back(binding);
+    return (unsigned int)viewBindings.size() - 1;
+}
+
+void CommandList::pushUniform(const Shader& shader, const std::string& name, UniformType type,
+    const float* values, int count) {
+    UniformCommand uniform = {}; // Zeroed tail so replays can compare payloads whole
+    uniform.program = shader.ID;
+    uniform.location = locate(shader.ID, name);
+    if (uniform.location < 0) return; // Optimized out or not declared, like glUniform* would ignore it
+    uniform.type = type;
+    std::memcpy(uniform.values, values, count * sizeof(float));
+    uniforms.push_back(uniform);
+
+    unsigned int index = (unsigned int)uniforms.size() - 1;
+    for (LiveUniform& live : liveUniforms) {
+        if (live.program == uniform.program && live.location == uniform.location) {
+            live.index = index;
+            return;
+        }
+    }
+    LiveUniform live = { uniform.program, uniform.location, index };
+    liveUniforms.push_back(live);
+}
+
+void CommandList::setInt(const Shader& shader, const std::string& name, int value) {
+    // Integers travel bit-exact through the float payload
+    float payload;
+    std::memcpy(&payload, &value, sizeof(payload));
+    pushUniform(shader, name, UNIFORM_INT, &payload, 1);
+}
+
+void CommandList::setBool(const Shader& shader, const std::string& name, bool value) {
+    setInt(shader, name, (int)value);
+}
+
+void CommandList::setFloat(const Shader& shader, const std::string& name, float value) {
+    pushUniform(shader, name, UNIFORM_FLOAT, &value, 1);
+}
+
+void CommandList::setVec3(const Shader& shader, const std::string& name, const glm::vec3& value) {
+    pushUniform(shader, name, UNIFORM_VEC3, glm::value_ptr(value), 3);
+}
+
+void CommandList::setVec4(const Shader& shader, const std::string& name, const glm::vec4& value) {
+    pushUniform(shader, name, UNIFORM_VEC4, glm::value_ptr(value), 4);
+}
+
+void CommandList::setMat4(const Shader& shader, const std::string& name, const glm::mat4& value) {
+    pushUniform(shader, name, UNIFORM_MAT4, glm::value_ptr(value), 16);
+}
+
+void CommandList::draw(const Shader& shader, unsigned int vao, GLenum primitive, GLint first, GLsizei count,
+    GLsizei instanceCount, GLenum polygonMode) {
+    DrawCommand command;
+    command.program = shader.ID;
+    command.vao = vao;
+    command.primitive = primitive;
+    command.indexed = false;
+    command.first = first;
+    command.count = count;
+    command.baseVertex = 0;
+    command.instanceCount = instanceCount;
+    command.feedback = 0;
+    command.polygonMode = polygonMode;
+    command.viewBinding = findViewBinding(shader.ID);
+
+    auto material = std::find(materials.begin(), materials.end(), vao);
+    command.material = (unsigned int)(material - materials.begin());
+    if (material == materials.end()) materials.push_back(vao);
+
+    command.hasCenter = pendingHasCenter;
+    command.center = pendingCenter;
+    pendingHasCenter = false;
+
+    // Snapshot the program's uniform state so the draw can be replayed out of order
+    command.uniformBegin = (unsigned int)drawUniforms.size();
+    for (const LiveUniform& live : liveUniforms) {
+        if (live.program == shader.ID) drawUniforms.push_back(live.index);
+    }
+    command.uniformCount = (unsigned int)drawUniforms.size() - command.uniformBegin;
+    draws.push_back(command);
+}
+
+void CommandList::drawIndexed(const Shader& shader, unsigned int vao, GLenum primitive, GLint firstIndex,
+    GLsizei indexCount, GLint baseVertex, GLsizei instanceCount, GLenum polygonMode) {
+    draw(shader, vao, primitive, firstIndex, indexCount, instanceCount, polygonMode);
+    draws.back().indexed = true;
+    draws.back().baseVertex = baseVertex;
+}
+
+void CommandList::drawFeedback(const Shader& shader, unsigned int vao, GLenum primitive, unsigned int feedback,
+    GLenum polygonMode) {
+    draw(shader, vao, primitive, 0, 0, 0, polygonMode);
+    draws.back().feedback = feedback;
+}
+
+void CommandList::setDepthCenter(const glm::vec3& center) {
+    pendingHasCenter = true;
+    pendingCenter = center;
+}
+
+void ViewCommandList::build(const CommandList& commands, const ViewParams& viewParams) {
+    source = &commands;
+    params = viewParams;
+    ops.clear();
+
+    const std::vector<CommandList::DrawCommand>& draws = commands.getDraws();
+    const std::vector<CommandList::UniformCommand>& uniforms = commands.getUniforms();
+    const std::vector<unsigned int>& drawUniforms = commands.getDrawUniforms();
+
+    queue.clear();
+    for (unsigned int i = 0; i < draws.size(); i++) {
+        const CommandList::DrawCommand& draw = draws[i];
+        RenderQueue::Pass pass = draw.polygonMode == GL_FILL ? RenderQueue::PASS_OPAQUE : RenderQueue::PASS_WIREFRAME;
+        float depth = draw.hasCenter ? -(params.view * glm::vec4(draw.center, 1.0f)).z : 0.0f;
+        queue.push(RenderQueue::makeKey(pass, draw.viewBinding, draw.material, depth), i);
+    }
+    queue.sort();
+
+    // 0 never names a program or a VAO the scene draws with, so the first draw binds both
+    unsigned int program = 0;
+    unsigned int vao = 0;
+    GLenum polygonMode = GL_FILL;
+    // Scratch lives in the render frame arena; views are built on job system workers
+    FrameVector<unsigned int, FRAME_RENDER> viewBound;
+    // Uniform write last emitted per program location; earlier views leave unknown values
+    FrameVector<unsigned int, FRAME_RENDER> applied;
+    applied.reserve(commands.getUniforms().size());
+
+    for (const RenderQueue::Item& item : queue.getItems()) {
+        const CommandList::DrawCommand& draw = draws[item.index];
+
+        if (draw.program != program) {
+            program = draw.program;
+            Op op = { OP_PROGRAM, program };
+            ops.push_back(op);
+
+            // View uniforms live in the program object, so once per program per view is enough
+            if (std::find(viewBound.begin(), viewBound.end(), draw.viewBinding) == viewBound.end()) {
+                viewBound.push_back(draw.viewBinding);
+                Op viewOp = { OP_VIEW, draw.viewBinding };
+                ops.push_back(viewOp);
+            }
+        }
+        if (draw.vao != vao) {
+            vao = draw.vao;
+            Op op = { OP_VAO, vao };
+            ops.push_back(op);
+        }
+        if (draw.polygonMode != polygonMode) {
+            polygonMode = draw.polygonMode;
+            Op op = { OP_POLYGON_MODE, polygonMode };
+            ops.push_back(op);
+        }
+
+        for (unsigned int u = draw.uniformBegin; u < draw.uniformBegin + draw.uniformCount; u++) {
+            unsigned int index = drawUniforms[u];
+            const CommandList::UniformCommand& uniform = uniforms[index];
+
+            bool found = false;
+            for (unsigned int& last : applied) {
+                const CommandList::UniformCommand& previous = uniforms[last];
+                if (previous.program != uniform.program || previous.location != uniform.location) continue;
+
+                found = true;
+                if (last != index && std::memcmp(previous.values, uniform.values, sizeof(uniform.values)) != 0) {
+                    Op op = { OP_UNIFORM, index };
+                    ops.push_back(op);
+                }
+                last = index;
+                break;
+            }
+            if (!found) {
+                applied.push_back(index);
+                Op op = { OP_UNIFORM, index };
+                ops.push_back(op);
+            }
+        }
+
+        Op op = { OP_DRAW, item.index };
+        ops.push_back(op);
+    }
+
+    // Leave the polygon mode as the rest of the renderer expects it
+    if (polygonMode != GL_FILL) {
+        Op op = { OP_POLYGON_MODE, GL_FILL };
+        ops.push_back(op);
+    }
+}
+
+void ViewCommandList::execute() const {
+    if (!source) return;
+
+    const std::vector<CommandList::DrawCommand>& draws = source->getDraws();
+    const std::vector<CommandList::UniformCommand>& uniforms = source->getUniforms();
+
+    for (const Op& op : ops) {
+        switch (op.type) {
+        case OP_PROGRAM:
+            glState().useProgram(op.value);
+            break;
+        case OP_VIEW: {
+            const CommandList::ViewBinding& binding = source->getViewBinding(op.value);
+            if (binding.view >= 0) glUniformMatrix4fv(binding.view, 1, GL_FALSE, glm::value_ptr(params.view));
+            if (binding.projection >= 0) glUniformMatrix4fv(binding.projection, 1, GL_FALSE, glm::value_ptr(params.projection));
+            if (binding.viewPos >= 0) glUniform3fv(binding.viewPos, 1, glm::value_ptr(params.viewPos));
+            break;
+        }
+        case OP_VAO:
+            glState().bindVertexArray(op.value);
+            break;
+        case OP_POLYGON_MODE:
+            glState().polygonMode(op.value);
+            break;
+        case OP_UNIFORM: {
+            const CommandList::UniformCommand& uniform = uniforms[op.value];
+            switch (uniform.type) {
+            case CommandList::UNIFORM_INT: {
+                int value;
+                std::memcpy(&value, uniform.values, sizeof(value));
+                glProgramUniform1i(uniform.program, uniform.location, value);
+                break;
+            }
+            case CommandList::UNIFORM_FLOAT:
+                glProgramUniform1f(uniform.program, uniform.location, uniform.values[0]);
+                break;
+            case CommandList::UNIFORM_VEC3:
+                glProgramUniform3fv(uniform.program, uniform.location, 1, uniform.values);
+                break;
+            case CommandList::UNIFORM_VEC4:
+                glProgramUniform4fv(uniform.program, uniform.location, 1, uniform.values);
+                break;
+            case CommandList::UNIFORM_MAT4:
+                glProgramUniformMatrix4fv(uniform.program, uniform.location, 1, GL_FALSE, uniform.values);
+                break;
+            }
+            break;
+        }
+        case OP_DRAW: {
+            const CommandList::DrawCommand& draw = draws[op.value];
+            if (draw.feedback) {
+                glDrawTransformFeedback(draw.primitive, draw.feedback);
+            }
+            else if (draw.indexed) {
+                void* offset = (void*)(draw.first * sizeof(GLushort));
+                if (draw.instanceCount > 0) {
+                    glDrawElementsInstancedBaseVertex(draw.primitive, draw.count, GL_UNSIGNED_SHORT, offset,
+                        draw.instanceCount, draw.baseVertex);
+                }
+                else {
+                    glDrawElementsBaseVertex(draw.primitive, draw.count, GL_UNSIGNED_SHORT, offset, draw.baseVertex);
+                }
+            }
+            else if (draw.instanceCount > 0) {
+                glDrawArraysInstanced(draw.primitive, draw.first, draw.count, draw.instanceCount);
+            }
+            else {
+                glDrawArrays(draw.primitive, draw.first, draw.count);
+            }
+            break;
+        }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include "dev_space.h"
+#include "gl_state.h"
+#include <cstddef>
+
+namespace {
+    // Object kinds, matching the constants in v_dev_space.glsl
+    enum DevObjectKind {
+        GRID_A = 0,
+        GRID_B = 1,
+        WALL_A = 2,
+        WALL_B = 3,
+        ORBIT_A = 4,
+        ORBIT_B = 5
+    };
+}
+
+DevSpace::DevSpace() : VAO(0), instanceVBO(0) {
+    cube.firstIndex = cube.indexCount = cube.baseVertex = 0;
+}
+
+DevSpace::~DevSpace() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &instanceVBO);
+}
+
+void DevSpace::initialize(const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh,
+    const glm::vec3& portalAOffset, const glm::vec3& portalBOffset) {
+    instances.clear();
+
+    // 5x5 cube grids around each area centre (centre skipped)
+    for (int i = -2; i <= 2; i++) {
+        for (int j = -2; j <= 2; j++) {
+            if (i == 0 && j == 0) continue;
+            Instance cube = { glm::vec4(GRID_A, i, j, 0.0f), portalAOffset };
+            instances.push_back(cube);
+        }
+    }
+    for (int i = -2; i <= 2; i++) {
+        for (int j = -2; j <= 2; j++) {
+            if (i == 0 && j == 0) continue;
+            Instance cube = { glm::vec4(GRID_B, i, j, 0.0f), portalBOffset };
+            instances.push_back(cube);
+        }
+    }
+
+    // Walls are built from 1-unit sections so they can bend; with the effects off
+    // the sections line up into a straight wall
+    for (int i = -10; i <= 10; i++) {
+        Instance section = { glm::vec4(WALL_A, i, 0.0f, 0.0f), portalAOffset };
+        instances.push_back(section);
+    }
+    for (int i = -10; i <= 10; i++) {
+        Instance section = { glm::vec4(WALL_B, i, 0.0f, 0.0f), portalBOffset };
+        instances.push_back(section);
+    }
+
+    // Floating objects, one orbiting in each area per index
+    for (int i = 0; i < 10; i++) {
+        Instance orbitA = { glm::vec4(ORBIT_A, i, 0.0f, 0.0f), portalAOffset };
+        Instance orbitB = { glm::vec4(ORBIT_B, i, 0.0f, 0.0f), portalBOffset };
+        instances.push_back(orbitA);
+        instances.push_back(orbitB);
+    }
+
+    cube = cubeMesh;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceVBO);
+
+    glState().bindVertexArray(VAO);
+
+    // Cube mesh from the shared library buffers
+    meshes.bindLayout();
+
+    // Instance records never change after this upload
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, params));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, origin));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+
+    glState().bindVertexArray(0);
+}
+
+void DevSpace::record(const Shader& shader, float nonEuclideanFactor, bool applyNonEuclidean, float time,
+    CommandList& out) const {
+    if (instances.empty()) return;
+
+    out.setFloat(shader, "time", time);
+    out.setFloat(shader, "nonEuclideanFactor", applyNonEuclidean ? nonEuclideanFactor : 0.0f);
+    out.setBool(shader, "nonEuclideanEnabled", applyNonEuclidean);
+    out.drawIndexed(shader, VAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex,
+        static_cast<GLsizei>(instances.size()));
+}
+
+size_t DevSpace::getInstanceCount() const {
+    return instances.size();
+}
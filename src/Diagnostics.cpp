@@ -0,0 +1,287 @@
+#include "diagnostics.h"
+#include "transform_batch.h"
+#include "simd_ops.h"
+#include "anim_math.h"
+#include "frame_arena.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+    const int BENCHMARK_ITERATIONS = 20;
+
+    // Average milliseconds needed to generate one frame of the given room
+    double timeRoomGeneration(RoomManager& roomManager, int roomIndex, float time, InstanceBatch& batch) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+            // Each iteration is a frame, so transient generator memory is recycled like in the game
+            advanceFrame(FRAME_SIMULATION);
+            batch.clear();
+            roomManager.generateRoomContent(roomIndex, time, batch);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / BENCHMARK_ITERATIONS;
+    }
+
+    // Largest error of fast(x) against reference(x), absolute or relative to the reference
+    template <typename FastFn, typename ReferenceFn>
+    double maxError(const std::vector<float>& inputs, FastFn fast, ReferenceFn reference, bool relative) {
+        double worst = 0.0;
+        for (float x : inputs) {
+            double expected = reference((double)x);
+            double error = std::fabs((double)fast(x) - expected);
+            if (relative && expected != 0.0) error /= std::fabs(expected);
+            worst = glm::max(worst, error);
+        }
+        return worst;
+    }
+
+    void reportAccuracy(const char* name, double error, double bound) {
+        std::cout << "  " << std::setw(10) << std::left << name << std::right << " max error "
+            << std::scientific << error << " (bound " << bound << ")" << std::fixed
+            << (error < bound ? "" : "  [BOUND EXCEEDED]") << std::endl;
+    }
+
+    template <typename Fn>
+    double timeMs(Fn fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    bool sameMatrices(const InstanceList& a, const InstanceList& b) {
+        return a.size() == b.size() &&
+            (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(glm::mat4)) == 0);
+    }
+}
+
+void runGenerationBenchmark(RoomManager& roomManager, float time) {
+    JobSystem* frameJobs = roomManager.getJobSystem();
+    InstanceBatch serialBatch;
+    InstanceBatch parallelBatch;
+
+    std::cout << "=== Content generation benchmark (" << BENCHMARK_ITERATIONS << " iterations) ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    // Per-room serial vs parallel time with the frame job system
+    for (int room = 1; room < (int)roomManager.getRoomCount(); room++) {
+        roomManager.setJobSystem(nullptr);
+        double serialMs = timeRoomGeneration(roomManager, room, time, serialBatch);
+
+        roomManager.setJobSystem(frameJobs);
+        double parallelMs = timeRoomGeneration(roomManager, room, time, parallelBatch);
+
+        bool identical = sameMatrices(serialBatch.solid, parallelBatch.solid) &&
+            sameMatrices(serialBatch.wireframe, parallelBatch.wireframe);
+
+        std::cout << "Room " << room << " (" << roomManager.getRoom(room).name << "): "
+            << serialBatch.size() << " cubes, serial " << serialMs << " ms, parallel "
+            << parallelMs << " ms, speedup " << (parallelMs > 0.0 ? serialMs / parallelMs : 0.0) << "x"
+            << (identical ? "" : "  [OUTPUT MISMATCH]") << std::endl;
+    }
+
+    // Scaling of all rooms together with an increasing number of workers
+    unsigned int maxWorkers = JobSystem::defaultWorkerCount();
+    double baselineMs = 0.0;
+    for (unsigned int workers = 0; workers <= maxWorkers; workers++) {
+        JobSystem jobs(workers);
+        roomManager.setJobSystem(&jobs);
+
+        double totalMs = 0.0;
+        for (int room = 1; room < (int)roomManager.getRoomCount(); room++) {
+            totalMs += timeRoomGeneration(roomManager, room, time, parallelBatch);
+        }
+        if (workers == 0) baselineMs = totalMs;
+
+        std::cout << "Threads " << jobs.getThreadCount() << ": all rooms " << totalMs << " ms, scaling "
+            << (totalMs > 0.0 ? baselineMs / totalMs : 0.0) << "x" << std::endl;
+    }
+
+    roomManager.setJobSystem(frameJobs);
+    std::cout.unsetf(std::ios_base::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+void runTransformBenchmark() {
+    const size_t instanceCounts[] = { 1000, 100000, 1000000 };
+
+    // Which kernel path these numbers come from depends on the compiler flags
+    std::cout << "=== Batch TRS kernel benchmark (" << SimdOps::LANES << " lanes, "
+#if defined(SIMD_OPS_AVX2)
+        << "AVX2"
+#elif defined(SIMD_OPS_SSE)
+        << "SSE2"
+#else
+        << "scalar"
+#endif
+        << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    for (size_t count : instanceCounts) {
+        TransformSoA transforms;
+        transforms.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            transforms.push(
+                glm::vec3(unit(random), unit(random), unit(random)) * 50.0f,
+                unit(random) * 6.28318f,
+                glm::vec3(unit(random), unit(random), unit(random) + 1.5f),
+                glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(2.0f));
+        }
+
+        std::vector<glm::mat4> reference(count);
+        std::vector<glm::mat4> batched(count);
+        std::vector<PackedTransform> packed(count);
+
+        // Current path: three full 4x4 multiplies per instance
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(transforms.posX[i], transforms.posY[i], transforms.posZ[i]));
+            model = glm::rotate(model, transforms.rotW[i], glm::vec3(transforms.rotX[i], transforms.rotY[i], transforms.rotZ[i]));
+            model = glm::scale(model, glm::vec3(transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i]));
+            reference[i] = model;
+        }
+        auto glmEnd = std::chrono::high_resolution_clock::now();
+        buildTransforms(transforms, batched.data());
+        auto mat4End = std::chrono::high_resolution_clock::now();
+        buildTransforms(transforms, packed.data());
+        auto packedEnd = std::chrono::high_resolution_clock::now();
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            glm::mat4 unpacked = toMat4(packed[i]);
+            for (int column = 0; column < 4; column++) {
+                for (int row = 0; row < 4; row++) {
+                    maxError = glm::max(maxError, std::fabs(reference[i][column][row] - batched[i][column][row]));
+                    maxError = glm::max(maxError, std::fabs(reference[i][column][row] - unpacked[column][row]));
+                }
+            }
+        }
+
+        double glmMs = std::chrono::duration<double, std::milli>(glmEnd - start).count();
+        double mat4Ms = std::chrono::duration<double, std::milli>(mat4End - glmEnd).count();
+        double packedMs = std::chrono::duration<double, std::milli>(packedEnd - mat4End).count();
+
+        std::cout << count << " instances: glm " << glmMs << " ms, batch mat4 " << mat4Ms
+            << " ms, batch 3x4 " << packedMs << " ms, speedup "
+            << (packedMs > 0.0 ? glmMs / packedMs : 0.0) << "x, max error " << maxError
+            << (maxError < 1e-4f ? "" : "  [TOLERANCE EXCEEDED]") << std::endl;
+    }
+
+    std::cout.unsetf(std::ios_base::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+void runAnimMathBenchmark() {
+    const size_t sampleCount = 1000000;
+
+    std::cout << "=== Animation math benchmark ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    // Accuracy over each documented range
+    std::vector<float> trigInputs(sampleCount);
+    std::vector<float> exp2Inputs(sampleCount);
+    std::vector<float> log2Inputs(sampleCount);
+    for (size_t i = 0; i < sampleCount; i++) {
+        float t = (float)i / (sampleCount - 1);
+        trigInputs[i] = -8192.0f + t * 16384.0f;
+        exp2Inputs[i] = -126.0f + t * 253.0f;
+        log2Inputs[i] = std::ldexp(1.0f + t, (int)(i % 254) - 126);
+    }
+
+    double atan2Error = 0.0;
+    double powError = 0.0;
+    std::mt19937 random(99);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (size_t i = 0; i < sampleCount; i++) {
+        float y = unit(random) * std::pow(10.0f, (float)(i % 9) - 4.0f);
+        float x = unit(random) * std::pow(10.0f, (float)(i % 7) - 3.0f);
+        atan2Error = glm::max(atan2Error, std::fabs((double)fastAtan2(y, x) - std::atan2((double)y, (double)x)));
+
+        // Only results that fit in a float (|exponent * log2(base)| <= 126) are covered
+        float base = 0.01f + (unit(random) + 1.0f) * 20.0f;
+        float exponent = unit(random) * 20.0f;
+        if (std::fabs(exponent * std::log2(base)) > 126.0f) continue;
+        double expected = std::pow((double)base, (double)exponent);
+        powError = glm::max(powError, std::fabs(fastPow(base, exponent) / expected - 1.0));
+    }
+
+    // log2 is bounded by 1e-7 * max(1, |log2 x|) over all normal floats
+    double log2Error = 0.0;
+    for (float x : log2Inputs) {
+        double expected = std::log2((double)x);
+        double error = std::fabs(fastLog2(x) - expected);
+        log2Error = glm::max(log2Error, error / glm::max(1.0, std::fabs(expected)));
+    }
+
+    // Signed zeros pick the half plane like std::atan2
+    const float zeros[4][2] = { { 0.0f, 0.0f }, { 0.0f, -0.0f }, { -0.0f, 0.0f }, { -0.0f, -0.0f } };
+    for (const auto& zero : zeros) {
+        atan2Error = glm::max(atan2Error,
+            std::fabs((double)fastAtan2(zero[0], zero[1]) - std::atan2((double)zero[0], (double)zero[1])));
+    }
+
+    std::cout << "Accuracy against libm (" << sampleCount << " samples):" << std::endl;
+    reportAccuracy("sin", maxError(trigInputs, fastSin, [](double x) { return std::sin(x); }, false), 1e-7);
+    reportAccuracy("cos", maxError(trigInputs, fastCos, [](double x) { return std::cos(x); }, false), 1e-7);
+    reportAccuracy("atan2", atan2Error, 3e-7);
+    reportAccuracy("exp2", maxError(exp2Inputs, fastExp2, [](double x) { return std::exp2(x); }, true), 1e-7);
+    reportAccuracy("log2", log2Error, 1e-7);
+    reportAccuracy("pow", powError, 8e-6);
+
+    // Throughput of the array kernels against a plain libm loop
+    std::vector<float> input(sampleCount);
+    std::vector<float> sines(sampleCount);
+    std::vector<float> cosines(sampleCount);
+    std::vector<float> other(sampleCount);
+    for (size_t i = 0; i < sampleCount; i++) {
+        input[i] = 0.5f + i * 0.2f;
+        other[i] = 1.0f + (i % 100) * 0.05f;
+    }
+
+    double libmSinCos = timeMs([&]() {
+        for (size_t i = 0; i < sampleCount; i++) {
+            sines[i] = std::sin(input[i]);
+            cosines[i] = std::cos(input[i]);
+        }
+    });
+    double fastSinCosMs = timeMs([&]() { sinCosArray(input.data(), sines.data(), cosines.data(), sampleCount); });
+
+    // sin(a + b*i) series: independent calls vs the rotation recurrence
+    double phaseSeriesMs = timeMs([&]() {
+        PhaseSeries series(0.5f, 0.2f);
+        for (size_t i = 0; i < sampleCount; i++) {
+            sines[i] = series.sin();
+            series.advance();
+        }
+    });
+
+    double libmAtan2 = timeMs([&]() {
+        for (size_t i = 0; i < sampleCount; i++) cosines[i] = std::atan2(input[i], other[i]);
+    });
+    double fastAtan2Ms = timeMs([&]() { atan2Array(input.data(), other.data(), cosines.data(), sampleCount); });
+
+    double libmPow = timeMs([&]() {
+        for (size_t i = 0; i < sampleCount; i++) cosines[i] = std::pow(other[i], 1.7f);
+    });
+    std::fill(sines.begin(), sines.end(), 1.7f);
+    double fastPowMs = timeMs([&]() { powArray(other.data(), sines.data(), cosines.data(), sampleCount); });
+
+    std::cout << "Throughput (" << sampleCount << " values):" << std::endl;
+    std::cout << "  sincos    libm " << libmSinCos << " ms, fast " << fastSinCosMs << " ms, phase series "
+        << phaseSeriesMs << " ms" << std::endl;
+    std::cout << "  atan2     libm " << libmAtan2 << " ms, fast " << fastAtan2Ms << " ms" << std::endl;
+    std::cout << "  pow       libm " << libmPow << " ms, fast " << fastPowMs << " ms" << std::endl;
+
+    std::cout.unsetf(std::ios_base::floatfield);
+    std::cout << std::setprecision(6);
+}
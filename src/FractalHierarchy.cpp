@@ -0,0 +1,108 @@
+#include "fractal_hierarchy.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <cmath>
+
+const int FractalHierarchy::MAX_DEPTH;
+const int FractalHierarchy::TEXTURE_UNIT;
+
+FractalHierarchy::FractalHierarchy()
+    : boundRadius(0.0f), depth(0), VAO(0), nodeBuffer(0), nodeTexture(0), drawnNodes(0) {
+    cube.firstIndex = cube.indexCount = cube.baseVertex = cube.vertexCount = 0;
+}
+
+FractalHierarchy::~FractalHierarchy() {
+    glDeleteTextures(1, &nodeTexture);
+    glDeleteBuffers(1, &nodeBuffer);
+    glState().invalidate();
+}
+
+void FractalHierarchy::initialize(const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh, int maxDepth,
+    float childScale, float childOffset) {
+    cube = cubeMesh;
+    depth = std::max(1, std::min(maxDepth, MAX_DEPTH));
+
+    // Nothing is streamed per instance, so the library's shared VAO serves as is
+    VAO = meshes.getVAO();
+
+    // Breadth-first: the children of level L are appended while level L is walked
+    nodes.clear();
+    levelEnd.clear();
+    levelScale.clear();
+
+    Node root = { -1, 0, glm::vec3(0.0f), 1.0f };
+    nodes.push_back(root);
+    levelEnd.push_back(1);
+    levelScale.push_back(1.0f);
+
+    size_t levelBegin = 0;
+    for (int level = 1; level < depth; level++) {
+        size_t parentEnd = nodes.size();
+        for (size_t parent = levelBegin; parent < parentEnd; parent++) {
+            for (int i = 0; i < 8; i++) {
+                glm::vec3 direction((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+                Node child = { (int)parent, level, direction * childOffset, childScale };
+                nodes.push_back(child);
+            }
+        }
+        levelBegin = parentEnd;
+        levelEnd.push_back(nodes.size());
+        levelScale.push_back(levelScale.back() * childScale);
+    }
+
+    // Farthest a node centre gets from the root along each axis, plus the half diagonal
+    // of the root cube (the largest) in any rotation
+    float reach = 0.0f;
+    for (int level = 0; level + 1 < depth; level++) {
+        reach += childOffset * levelScale[level];
+    }
+    boundRadius = std::sqrt(3.0f) * (reach + 0.5f);
+
+    std::vector<glm::vec4> texels;
+    texels.reserve(nodes.size() * 2);
+    for (const Node& node : nodes) {
+        texels.push_back(glm::vec4(node.childOffset, node.relativeScale));
+        texels.push_back(glm::vec4((float)node.parent, (float)node.level, 0.0f, 0.0f));
+    }
+
+    if (nodeBuffer == 0) glGenBuffers(1, &nodeBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, nodeBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, texels.size() * sizeof(glm::vec4), texels.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    if (nodeTexture == 0) glGenTextures(1, &nodeTexture);
+    glState().bindTextureBuffer(TEXTURE_UNIT, nodeTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, nodeBuffer);
+}
+
+void FractalHierarchy::record(const Shader& shader, const glm::vec3& rootCenter, float rootSize,
+    const ViewParams& view, float minScreenSize, CommandList& out) const {
+    // A node of size s at distance d covers s * projection[1][1] / (2 d) of the viewport
+    // height; use the nearest distance any node can have to find the deepest level that
+    // may still be large enough
+    float nearest = glm::length(view.viewPos - rootCenter) - boundRadius * rootSize;
+    float focal = view.projection[1][1] * 0.5f;
+
+    size_t levels = 1;
+    if (nearest <= 0.0f) {
+        levels = levelEnd.size();
+    }
+    else {
+        while (levels < levelEnd.size() && rootSize * levelScale[levels] * focal / nearest >= minScreenSize) {
+            levels++;
+        }
+    }
+    drawnNodes = levelEnd[levels - 1];
+
+    // Draws are replayed after recording; nothing else binds a buffer texture to this unit,
+    // so the binding is still in place then
+    glState().bindTextureBuffer(TEXTURE_UNIT, nodeTexture);
+
+    out.setInt(shader, "nodes", TEXTURE_UNIT);
+    out.setVec3(shader, "rootCenter", rootCenter);
+    out.setFloat(shader, "rootSize", rootSize);
+    out.setFloat(shader, "minScreenSize", minScreenSize);
+    out.setDepthCenter(rootCenter);
+    out.drawIndexed(shader, VAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex,
+        (GLsizei)drawnNodes);
+}
@@ -0,0 +1,146 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+
+const size_t FrameArena::BLOCK_SIZE;
+
+FrameArena::FrameArena() : current(0), offset(0), used(0), highWater(0), capacity(0) {}
+
+FrameArena::~FrameArena() {
+    for (const Block& block : blocks) {
+        ::operator delete(block.memory);
+    }
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+
+    while (current < blocks.size()) {
+        Block& block = blocks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.memory);
+        size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+        if (aligned + size <= block.size) {
+            used += aligned + size - offset;
+            offset = aligned + size;
+            return block.memory + aligned;
+        }
+
+        // The rest of this block is wasted for the frame; move on to the next one
+        used += block.size - offset;
+        current++;
+        offset = 0;
+    }
+
+    // operator new memory is aligned for any fundamental type
+    size_t blockSize = std::max(BLOCK_SIZE, size);
+    Block block = { static_cast<char*>(::operator new(blockSize)), blockSize };
+    blocks.push_back(block);
+    capacity += blockSize;
+    current = blocks.size() - 1;
+
+    offset = size;
+    used += size;
+    return block.memory;
+}
+
+void FrameArena::reset() {
+    highWater = std::max(highWater, used);
+
+    // One block that fits the whole frame instead of a chain
+    if (blocks.size() > 1) {
+        size_t combined = capacity;
+        for (const Block& block : blocks) {
+            ::operator delete(block.memory);
+        }
+        blocks.clear();
+
+        Block block = { static_cast<char*>(::operator new(combined)), combined };
+        blocks.push_back(block);
+    }
+
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+namespace {
+    std::atomic<unsigned int> frameEpochs[FRAME_PIPELINE_COUNT];
+
+    struct ThreadArenas;
+    std::mutex registryMutex;
+    std::vector<ThreadArenas*> registry;
+
+    struct ThreadArenas {
+        struct Pipeline {
+            FrameArena arenas[2];
+            unsigned int epoch = 0;
+            int active = 0;
+
+            // Published on reset so other threads can read stats without racing the arena
+            std::atomic<size_t> highWater{ 0 };
+            std::atomic<size_t> capacity{ 0 };
+        };
+
+        Pipeline pipelines[FRAME_PIPELINE_COUNT];
+
+        ThreadArenas() {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(this);
+        }
+
+        ~ThreadArenas() {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+        }
+    };
+
+    thread_local ThreadArenas threadArenas;
+}
+
+void advanceFrame(FramePipeline pipeline) {
+    frameEpochs[pipeline].fetch_add(1, std::memory_order_release);
+}
+
+FrameArena& frameArena(FramePipeline pipeline) {
+    ThreadArenas::Pipeline& state = threadArenas.pipelines[pipeline];
+
+    unsigned int epoch = frameEpochs[pipeline].load(std::memory_order_acquire);
+    if (epoch != state.epoch) {
+        state.epoch = epoch;
+        state.active ^= 1;
+
+        FrameArena& next = state.arenas[state.active];
+        next.reset();
+
+        const FrameArena& previous = state.arenas[state.active ^ 1];
+        size_t peak = std::max(next.getHighWater(), previous.getHighWater());
+        state.highWater.store(std::max(peak, previous.getUsed()), std::memory_order_relaxed);
+        state.capacity.store(next.getCapacity() + previous.getCapacity(), std::memory_order_relaxed);
+    }
+    return state.arenas[state.active];
+}
+
+void reportFrameArenaStats() {
+    const char* names[FRAME_PIPELINE_COUNT] = { "simulation", "render" };
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (int pipeline = 0; pipeline < FRAME_PIPELINE_COUNT; pipeline++) {
+        int threads = 0;
+        size_t peak = 0;
+        size_t reserved = 0;
+        for (ThreadArenas* arenas : registry) {
+            const ThreadArenas::Pipeline& state = arenas->pipelines[pipeline];
+            size_t reservedHere = state.capacity.load(std::memory_order_relaxed);
+            if (reservedHere == 0) continue;
+            threads++;
+            peak = std::max(peak, state.highWater.load(std::memory_order_relaxed));
+            reserved += reservedHere;
+        }
+
+        std::cout << "Frame arenas (" << names[pipeline] << "): " << threads << " threads, peak "
+            << peak / 1024 << " KB per thread per frame, " << reserved / 1024 << " KB reserved" << std::endl;
+    }
+}
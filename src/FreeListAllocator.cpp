@@ -0,0 +1,57 @@
+#include "free_list_allocator.h"
+
+const size_t FreeListAllocator::INVALID_OFFSET;
+
+FreeListAllocator::FreeListAllocator(size_t size) : capacity(size), freeSize(size) {
+    if (size > 0) freeRanges[0] = size;
+}
+
+size_t FreeListAllocator::allocate(size_t size) {
+    if (size == 0) return INVALID_OFFSET;
+
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->second < size) continue;
+
+        size_t offset = it->first;
+        size_t remaining = it->second - size;
+        freeRanges.erase(it);
+        if (remaining > 0) freeRanges[offset + size] = remaining;
+
+        freeSize -= size;
+        return offset;
+    }
+    return INVALID_OFFSET;
+}
+
+void FreeListAllocator::release(size_t offset, size_t size) {
+    if (size == 0 || offset == INVALID_OFFSET) return;
+    freeSize += size;
+
+    auto next = freeRanges.lower_bound(offset);
+
+    // Merge with the following range when they touch
+    if (next != freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+
+    // Merge with the preceding range when they touch
+    if (next != freeRanges.begin()) {
+        auto previous = next;
+        --previous;
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    freeRanges[offset] = size;
+}
+
+size_t FreeListAllocator::getLargestFreeRange() const {
+    size_t largest = 0;
+    for (const auto& range : freeRanges) {
+        if (range.second > largest) largest = range.second;
+    }
+    return largest;
+}
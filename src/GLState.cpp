@@ -0,0 +1,132 @@
+#include "gl_state.h"
+
+GLStateCache::GLStateCache() {
+    invalidate();
+    current.issued = current.filtered = current.unitSwitches = 0;
+    lastFrame = current;
+}
+
+bool GLStateCache::change(Tracked& state, unsigned int value) {
+    if (state.known && state.value == value) {
+        current.filtered++;
+        return false;
+    }
+    state.known = true;
+    state.value = value;
+    current.issued++;
+    return true;
+}
+
+void GLStateCache::useProgram(unsigned int id) {
+    if (change(program, id)) glUseProgram(id);
+}
+
+void GLStateCache::bindVertexArray(unsigned int vao) {
+    if (change(vertexArray, vao)) glBindVertexArray(vao);
+}
+
+void GLStateCache::bindTexture(Tracked& binding, GLenum target, int unit, unsigned int texture) {
+    // Compare the binding first so an unneeded glActiveTexture is skipped as well
+    if (binding.known && binding.value == texture) {
+        current.filtered++;
+        return;
+    }
+    // The unit switch is part of this bind and counted on its own, not as a second change
+    if (!activeUnit.known || activeUnit.value != (unsigned int)unit) {
+        activeUnit.known = true;
+        activeUnit.value = (unsigned int)unit;
+        current.unitSwitches++;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    change(binding, texture);
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::bindTexture2D(int unit, unsigned int texture) {
+    bindTexture(textures[unit], GL_TEXTURE_2D, unit, texture);
+}
+
+void GLStateCache::bindTexture3D(int unit, unsigned int texture) {
+    bindTexture(textures3D[unit], GL_TEXTURE_3D, unit, texture);
+}
+
+void GLStateCache::bindTextureBuffer(int unit, unsigned int texture) {
+    bindTexture(textureBuffers[unit], GL_TEXTURE_BUFFER, unit, texture);
+}
+
+void GLStateCache::bindFramebuffer(unsigned int id) {
+    if (change(framebuffer, id)) glBindFramebuffer(GL_FRAMEBUFFER, id);
+}
+
+void GLStateCache::setBlend(bool enabled) {
+    if (!change(blend, enabled)) return;
+    if (enabled) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+}
+
+void GLStateCache::blendFunc(GLenum source, GLenum destination) {
+    bool sourceChanged = !(blendSource.known && blendSource.value == source);
+    bool destinationChanged = !(blendDestination.known && blendDestination.value == destination);
+    if (!sourceChanged && !destinationChanged) {
+        current.filtered++;
+        return;
+    }
+    blendSource.known = blendDestination.known = true;
+    blendSource.value = source;
+    blendDestination.value = destination;
+    current.issued++;
+    glBlendFunc(source, destination);
+}
+
+void GLStateCache::setDepthTest(bool enabled) {
+    if (!change(depthTest, enabled)) return;
+    if (enabled) glEnable(GL_DEPTH_TEST);
+    else glDisable(GL_DEPTH_TEST);
+}
+
+void GLStateCache::polygonMode(GLenum mode) {
+    if (change(polygon, mode)) glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void GLStateCache::viewport(int x, int y, int width, int height) {
+    if (viewportKnown && viewportRect[0] == x && viewportRect[1] == y &&
+        viewportRect[2] == width && viewportRect[3] == height) {
+        current.filtered++;
+        return;
+    }
+    viewportKnown = true;
+    viewportRect[0] = x;
+    viewportRect[1] = y;
+    viewportRect[2] = width;
+    viewportRect[3] = height;
+    current.issued++;
+    glViewport(x, y, width, height);
+}
+
+void GLStateCache::getViewport(int rect[4]) {
+    if (!viewportKnown) {
+        glGetIntegerv(GL_VIEWPORT, viewportRect);
+        viewportKnown = true;
+    }
+    for (int i = 0; i < 4; i++) rect[i] = viewportRect[i];
+}
+
+void GLStateCache::invalidate() {
+    Tracked unknown = { false, 0 };
+    program = vertexArray = activeUnit = framebuffer = unknown;
+    blend = blendSource = blendDestination = depthTest = polygon = unknown;
+    for (int i = 0; i < TEXTURE_UNITS; i++) {
+        textures[i] = textures3D[i] = textureBuffers[i] = unknown;
+    }
+    viewportKnown = false;
+}
+
+void GLStateCache::endFrame() {
+    lastFrame = current;
+    current.issued = current.filtered = current.unitSwitches = 0;
+}
+
+GLStateCache& glState() {
+    static GLStateCache cache;
+    return cache;
+}
@@ -0,0 +1,39 @@
+#include "gpu_timer.h"
+
+GpuTimer::GpuTimer() : active(-1) {
+    for (Query& query : queries) {
+        query.id = 0;
+        query.tag = 0;
+        query.pending = false;
+    }
+}
+
+GpuTimer::~GpuTimer() {
+    for (Query& query : queries) {
+        if (query.id != 0) glDeleteQueries(1, &query.id);
+    }
+}
+
+void GpuTimer::begin(int tag) {
+    active = -1;
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        if (!queries[i].pending) {
+            active = i;
+            break;
+        }
+    }
+    if (active < 0) return;
+
+    Query& query = queries[active];
+    if (query.id == 0) glGenQueries(1, &query.id);
+    query.tag = tag;
+    glBeginQuery(GL_TIME_ELAPSED, query.id);
+}
+
+void GpuTimer::end() {
+    if (active < 0) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    queries[active].pending = true;
+    active = -1;
+}
@@ -0,0 +1,361 @@
+#include "hyperbolic_space.h"
+#include "gl_state.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+    const double PI = 3.14159265358979323846;
+
+    // Hard limit on the cache, whatever the settings
+    const size_t MAX_CACHED_TILES = 65536;
+
+    // A camera jump longer than this (world units) is a teleport, not a walk
+    const float TELEPORT_DISTANCE = 5.0f;
+
+    // Signature of the Minkowski product
+    const double ETA[4] = { 1.0, 1.0, 1.0, -1.0 };
+
+    long long cellKey(double x, double z, double cellSize) {
+        long long cx = (long long)std::floor(x / cellSize);
+        long long cz = (long long)std::floor(z / cellSize);
+        return (cx << 32) ^ (cz & 0xffffffffLL);
+    }
+}
+
+HyperbolicTiling::Settings HyperbolicTiling::defaultSettings() {
+    Settings settings;
+    settings.p = 4;
+    settings.q = 5;
+    settings.scale = 10.0f;
+    settings.viewRadius = 5.0f;
+    settings.cacheRadius = 6.0f;
+    settings.maxVisibleTiles = 1024;
+    return settings;
+}
+
+double HyperbolicTiling::minkowskiDot(const glm::dvec4& a, const glm::dvec4& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z - a.w * b.w;
+}
+
+double HyperbolicTiling::distance(const glm::dvec4& a, const glm::dvec4& b) {
+    return std::acosh(std::max(-minkowskiDot(a, b), 1.0));
+}
+
+glm::dmat4 HyperbolicTiling::translation(const glm::dvec3& displacement) {
+    double d = glm::length(displacement);
+    if (d < 1e-12) return glm::dmat4(1.0);
+
+    // Boost along n by rapidity d: mixes the n component of position with w
+    glm::dvec3 n = displacement / d;
+    double c = std::cosh(d), s = std::sinh(d);
+    glm::dmat4 m(1.0);
+    for (int col = 0; col < 3; col++) {
+        for (int row = 0; row < 3; row++) m[col][row] += (c - 1.0) * n[row] * n[col];
+        m[col][3] = s * n[col];
+        m[3][col] = s * n[col];
+    }
+    m[3][3] = c;
+    return m;
+}
+
+glm::dmat4 HyperbolicTiling::reflection(const glm::dvec4& normal) {
+    // x - 2 <x, normal> normal
+    glm::dmat4 m(1.0);
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) m[col][row] -= 2.0 * normal[row] * normal[col] * ETA[col];
+    }
+    return m;
+}
+
+glm::dmat4 HyperbolicTiling::inverse(const glm::dmat4& isometry) {
+    glm::dmat4 m;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) m[col][row] = ETA[row] * ETA[col] * isometry[row][col];
+    }
+    return m;
+}
+
+void HyperbolicTiling::renormalize(glm::dmat4& isometry) {
+    // Column 3 is the image of the origin (timelike), columns 0-2 of the axes (spacelike)
+    glm::dvec4& origin = isometry[3];
+    origin /= std::sqrt(std::max(-minkowskiDot(origin, origin), 1e-300));
+
+    for (int col = 0; col < 3; col++) {
+        glm::dvec4& axis = isometry[col];
+        axis += minkowskiDot(axis, origin) * origin;
+        for (int previous = 0; previous < col; previous++) {
+            axis -= minkowskiDot(axis, isometry[previous]) * isometry[previous];
+        }
+        axis /= std::sqrt(std::max(minkowskiDot(axis, axis), 1e-300));
+    }
+}
+
+HyperbolicTiling::HyperbolicTiling() : inradius(0.0), circumradius(0.0), buildMilliseconds(0.0) {
+    settings = defaultSettings();
+}
+
+void HyperbolicTiling::build(const Settings& newSettings) {
+    auto start = std::chrono::high_resolution_clock::now();
+    settings = newSettings;
+    tiles.clear();
+    neighbours.clear();
+
+    if ((settings.p - 2) * (settings.q - 2) <= 4) {
+        std::cerr << "HyperbolicTiling: {" << settings.p << "," << settings.q << "} is not hyperbolic" << std::endl;
+        return;
+    }
+
+    // Right triangle of the tile's centre, an edge midpoint and a vertex
+    inradius = std::acosh(std::cos(PI / settings.q) / std::sin(PI / settings.p));
+    circumradius = std::acosh(1.0 / (std::tan(PI / settings.p) * std::tan(PI / settings.q)));
+
+    // Edge k faces direction 2 pi k / p, inradius from the centre; its line is the plane
+    // through it perpendicular to that direction
+    std::vector<glm::dmat4> mirrors;
+    for (int k = 0; k < settings.p; k++) {
+        double angle = 2.0 * PI * k / settings.p;
+        glm::dvec4 normal(std::cosh(inradius) * std::cos(angle), 0.0,
+            std::cosh(inradius) * std::sin(angle), std::sinh(inradius));
+        mirrors.push_back(reflection(normal));
+    }
+
+    // The central tile is symmetric in z -> -z (edge 0 faces +x)
+    glm::dmat4 symmetry = reflection(glm::dvec4(0.0, 0.0, 1.0, 0.0));
+
+    // Distinct centres are at least 2 inradius apart, which is 2 sinh(inradius) > inradius
+    // in (x, z), so a duplicate is always in the 3x3 cells around its original
+    double cellSize = inradius;
+    std::unordered_map<long long, std::vector<int> > cells;
+
+    Tile central = { glm::dmat4(1.0), glm::dvec4(0.0, 0.0, 0.0, 1.0) };
+    tiles.push_back(central);
+    cells[cellKey(0.0, 0.0, cellSize)].push_back(0);
+
+    for (size_t next = 0; next < tiles.size() && tiles.size() < MAX_CACHED_TILES; next++) {
+        for (int k = 0; k < settings.p; k++) {
+            Tile tile;
+            tile.isometry = tiles[next].isometry * mirrors[k] * symmetry;
+            renormalize(tile.isometry);
+            tile.center = tile.isometry[3];
+            if (std::acosh(tile.center.w) > settings.cacheRadius) continue;
+
+            bool known = false;
+            for (int dx = -1; dx <= 1 && !known; dx++) {
+                for (int dz = -1; dz <= 1 && !known; dz++) {
+                    auto cell = cells.find(cellKey(tile.center.x + dx * cellSize, tile.center.z + dz * cellSize, cellSize));
+                    if (cell == cells.end()) continue;
+                    for (int other : cell->second) {
+                        if (distance(tiles[other].center, tile.center) < 0.5 * inradius) {
+                            known = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (known) continue;
+
+            cells[cellKey(tile.center.x, tile.center.z, cellSize)].push_back((int)tiles.size());
+            tiles.push_back(tile);
+        }
+    }
+
+    // Tiles touching the central one have their centres within two circumradii
+    for (size_t i = 1; i < tiles.size(); i++) {
+        if (std::acosh(tiles[i].center.w) < 2.0 * circumradius + 1e-6) neighbours.push_back((int)i);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    buildMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "Hyperbolic {" << settings.p << "," << settings.q << "} tiling: " << tiles.size()
+        << " tiles within " << settings.cacheRadius << " in " << buildMilliseconds << " ms" << std::endl;
+}
+
+int HyperbolicTiling::nearestNeighbour(const glm::dvec4& point) const {
+    // Nearest centre = smallest cosh(distance) = -<point, centre>
+    int nearest = -1;
+    double closest = point.w;
+    for (int i : neighbours) {
+        double coshDistance = -minkowskiDot(point, tiles[i].center);
+        if (coshDistance < closest) {
+            closest = coshDistance;
+            nearest = i;
+        }
+    }
+    return nearest;
+}
+
+HyperbolicCamera::HyperbolicCamera()
+    : started(false), lastPosition(0.0f), floor(1.0), height(0.1), recenterCount(0) {
+}
+
+void HyperbolicCamera::reset() {
+    started = false;
+}
+
+void HyperbolicCamera::update(const HyperbolicTiling& tiling, const glm::vec3& worldPosition, float floorHeight) {
+    double scale = tiling.getSettings().scale;
+    glm::vec3 delta = worldPosition - lastPosition;
+    lastPosition = worldPosition;
+
+    if (!started || glm::length(delta) > TELEPORT_DISTANCE) {
+        floor = glm::dmat4(1.0);
+        started = true;
+    }
+    else {
+        // Walk in the player's frame, so loops pick up the holonomy of the curved floor
+        floor = floor * HyperbolicTiling::translation(glm::dvec3(delta.x, 0.0, delta.z) / scale);
+    }
+
+    // Hand the player over to the central tile; the tiling looks the same from there
+    int neighbour = tiling.nearestNeighbour(floor[3]);
+    if (neighbour >= 0) {
+        floor = HyperbolicTiling::inverse(tiling.getTiles()[neighbour].isometry) * floor;
+        recenterCount++;
+    }
+    HyperbolicTiling::renormalize(floor);
+
+    height = std::max((worldPosition.y - floorHeight) / scale, 0.01);
+}
+
+glm::mat4 HyperbolicCamera::getView() const {
+    glm::dmat4 player = floor * HyperbolicTiling::translation(glm::dvec3(0.0, height, 0.0));
+    return glm::mat4(HyperbolicTiling::inverse(player));
+}
+
+HyperbolicRenderer::HyperbolicRenderer() : tiling(nullptr), visibleCount(0) {
+    tileMesh.firstIndex = tileMesh.indexCount = tileMesh.baseVertex = tileMesh.vertexCount = 0;
+    cube = tileMesh;
+}
+
+HyperbolicRenderer::~HyperbolicRenderer() {
+    if (!VAOs.empty()) glDeleteVertexArrays((GLsizei)VAOs.size(), VAOs.data());
+    glState().invalidate();
+}
+
+void HyperbolicRenderer::initialize(const HyperbolicTiling& tilingToDraw, MeshLibrary& meshes,
+    const MeshLibrary::Mesh& cubeMesh, int regionCount) {
+    tiling = &tilingToDraw;
+    cube = cubeMesh;
+
+    // The central tile in Klein coordinates, where its edges are straight: a fan around the
+    // centre, inset a little so the tiling's edges show
+    const HyperbolicTiling::Settings& settings = tiling->getSettings();
+    float radius = 0.95f * (float)std::tanh(tiling->getCircumradius());
+    std::vector<float> vertices;
+    for (int k = 0; k < settings.p; k++) {
+        float a0 = (float)(2.0 * PI * (k + 0.5) / settings.p);
+        float a1 = (float)(2.0 * PI * (k + 1.5) / settings.p);
+        float triangle[24] = {
+            0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f,
+            radius * std::cos(a1), 0.0f, radius * std::sin(a1), 0.0f, 1.0f, 0.0f, 0.5f + 0.5f * std::cos(a1), 0.5f + 0.5f * std::sin(a1),
+            radius * std::cos(a0), 0.0f, radius * std::sin(a0), 0.0f, 1.0f, 0.0f, 0.5f + 0.5f * std::cos(a0), 0.5f + 0.5f * std::sin(a0)
+        };
+        vertices.insert(vertices.end(), triangle, triangle + 24);
+    }
+    tileMesh = meshes.add(vertices);
+
+    // Library layout plus one camera-relative tile isometry per instance, from each region
+    instanceBuffer.initialize(settings.maxVisibleTiles * sizeof(glm::mat4), regionCount);
+    VAOs.resize(regionCount);
+    glGenVertexArrays(regionCount, VAOs.data());
+    for (int region = 0; region < regionCount; region++) {
+        glState().bindVertexArray(VAOs[region]);
+        meshes.bindLayout();
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.getBuffer());
+        for (int column = 0; column < 4; column++) {
+            glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                (void*)(instanceBuffer.getRegionOffset(region) + column * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(3 + column);
+            glVertexAttribDivisor(3 + column, 1);
+        }
+    }
+
+    glState().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void HyperbolicRenderer::waitForRegion(int region) {
+    instanceBuffer.waitForRegion(region);
+}
+
+void HyperbolicRenderer::fenceRegion(int region) {
+    instanceBuffer.fenceRegion(region);
+}
+
+void HyperbolicRenderer::record(int region, const Shader& shader, const glm::mat4& cameraView, float time,
+    CommandList& out) {
+    visibleCount = 0;
+    if (tiling == nullptr || tiling->getTiles().empty()) return;
+
+    const HyperbolicTiling::Settings& settings = tiling->getSettings();
+    const std::vector<HyperbolicTiling::Tile>& tiles = tiling->getTiles();
+
+    // Tiles within viewRadius of the camera; the camera stays in the central tile, so this
+    // is a bounded disc of the cache however far the player has walked
+    glm::dmat4 view(cameraView);
+    glm::dvec4 eye = HyperbolicTiling::inverse(view)[3];
+    double coshView = std::cosh((double)settings.viewRadius);
+
+    candidates.clear();
+    for (size_t i = 0; i < tiles.size(); i++) {
+        double coshDistance = -HyperbolicTiling::minkowskiDot(tiles[i].center, eye);
+        if (coshDistance <= coshView) candidates.push_back(std::make_pair(coshDistance, (int)i));
+    }
+    if ((int)candidates.size() > settings.maxVisibleTiles) {
+        std::nth_element(candidates.begin(), candidates.begin() + settings.maxVisibleTiles, candidates.end());
+        candidates.resize(settings.maxVisibleTiles);
+    }
+
+    visibleCount = candidates.size();
+    if (candidates.empty()) return;
+
+    // Straight into the mapped region when there is one; the region was waited for
+    glm::mat4* mapped = static_cast<glm::mat4*>(instanceBuffer.getRegionPointer(region));
+    if (!mapped) instances.resize(candidates.size());
+    glm::mat4* target = mapped ? mapped : instances.data();
+    for (size_t i = 0; i < candidates.size(); i++) {
+        target[i] = glm::mat4(view * tiles[candidates[i].second].isometry);
+    }
+    if (!mapped) instanceBuffer.upload(region, instances.data(), instances.size() * sizeof(glm::mat4));
+
+    unsigned int VAO = VAOs[region];
+    GLsizei count = (GLsizei)candidates.size();
+    out.setFloat(shader, "hyperbolicScale", settings.scale);
+
+    // Floor tiles
+    out.setMat4(shader, "model", glm::mat4(1.0f));
+    out.drawIndexed(shader, VAO, GL_TRIANGLES, tileMesh.firstIndex, tileMesh.indexCount, tileMesh.baseVertex, count);
+
+    // Decorations in Klein units, p-fold symmetric: a spinning star of p blades at the
+    // centre and a bobbing post towards every vertex
+    float postRadius = 0.7f * (float)std::tanh(tiling->getCircumradius());
+    for (int k = 0; k < settings.p; k++) {
+        float angle = (float)(2.0 * PI * k / settings.p);
+
+        glm::mat4 blade = glm::rotate(glm::mat4(1.0f), time * 0.3f + angle, glm::vec3(0.0f, 1.0f, 0.0f));
+        blade = glm::translate(blade, glm::vec3(0.04f, 0.12f, 0.0f));
+        blade = glm::scale(blade, glm::vec3(0.08f, 0.24f, 0.015f));
+        out.setMat4(shader, "model", blade);
+        out.drawIndexed(shader, VAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex, count);
+
+        float vertexAngle = angle + (float)(PI / settings.p);
+        glm::mat4 post = glm::translate(glm::mat4(1.0f), glm::vec3(
+            postRadius * std::cos(vertexAngle), 0.06f + 0.02f * std::sin(time * 0.8f), postRadius * std::sin(vertexAngle)));
+        post = glm::scale(post, glm::vec3(0.025f, 0.12f, 0.025f));
+        out.setMat4(shader, "model", post);
+        out.drawIndexed(shader, VAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex, count);
+    }
+}
+
+void HyperbolicRenderer::reportStats() const {
+    if (tiling == nullptr) return;
+    const HyperbolicTiling::Settings& settings = tiling->getSettings();
+    std::cout << "Hyperbolic {" << settings.p << "," << settings.q << "}: " << visibleCount << " of "
+        << tiling->getTiles().size() << " cached tiles drawn (view radius " << settings.viewRadius
+        << ", cache built in " << tiling->getBuildMilliseconds() << " ms)" << std::endl;
+}
@@ -0,0 +1,145 @@
+#include "instance_culler.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    // Per survivor: the four model matrix columns (g_instance_cull.glsl)
+    const GLsizei SURVIVOR_STRIDE = sizeof(glm::mat4);
+
+    // Output buffers start this large and double when a batch outgrows them
+    const GLsizei MIN_CAPACITY = 1024;
+
+    // The six planes (left, right, bottom, top, near, far) of a view-projection matrix,
+    // pointing inwards and normalized, so dot(plane.xyz, p) + plane.w is a distance
+    void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
+        glm::vec4 rows[4];
+        for (int row = 0; row < 4; row++) {
+            rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+                viewProjection[2][row], viewProjection[3][row]);
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            planes[axis * 2] = rows[3] + rows[axis];
+            planes[axis * 2 + 1] = rows[3] - rows[axis];
+        }
+        for (int i = 0; i < 6; i++) {
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+        }
+    }
+}
+
+InstanceCuller::InstanceCuller() : cullShader(nullptr), planesLocation(-1), viewsCulled(0) {
+}
+
+InstanceCuller::~InstanceCuller() {
+    for (Output& output : outputs) {
+        glDeleteQueries(1, &output.query);
+        glDeleteVertexArrays(1, &output.vao);
+        glDeleteTransformFeedbacks(1, &output.feedback);
+        glDeleteBuffers(1, &output.buffer);
+    }
+    glState().invalidate();
+}
+
+void InstanceCuller::initialize(const Shader& shader) {
+    cullShader = &shader;
+    planesLocation = glGetUniformLocation(shader.ID, "frustumPlanes");
+}
+
+void InstanceCuller::clear() {
+    batches.clear();
+    viewsCulled = 0;
+}
+
+void InstanceCuller::addBatch(unsigned int sourceVAO, GLsizei count, GLenum polygonMode) {
+    if (count <= 0) return;
+
+    Batch batch = { sourceVAO, count, polygonMode };
+    batches.push_back(batch);
+
+    if (outputs.size() < batches.size()) {
+        Output output;
+        glGenBuffers(1, &output.buffer);
+        glGenTransformFeedbacks(1, &output.feedback);
+        glGenVertexArrays(1, &output.vao);
+        glGenQueries(1, &output.query);
+        output.capacity = 0;
+
+        // Survivors are read back one per vertex: no divisor, no mesh
+        glState().bindVertexArray(output.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, output.buffer);
+        for (int attribute = 0; attribute < 4; attribute++) {
+            glVertexAttribPointer(3 + attribute, 4, GL_FLOAT, GL_FALSE, SURVIVOR_STRIDE,
+                (void*)(attribute * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(3 + attribute);
+        }
+        glState().bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        outputs.push_back(output);
+    }
+    reserve(outputs[batches.size() - 1], count);
+}
+
+void InstanceCuller::reserve(Output& output, GLsizei count) {
+    if (count <= output.capacity) return;
+
+    GLsizei capacity = std::max(output.capacity, MIN_CAPACITY);
+    while (capacity < count) capacity *= 2;
+    output.capacity = capacity;
+
+    glBindBuffer(GL_ARRAY_BUFFER, output.buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * SURVIVOR_STRIDE, nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Rebind so the feedback object captures into the whole new store
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, output.feedback);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, output.buffer);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+}
+
+void InstanceCuller::record(const Shader& drawShader, CommandList& out) const {
+    for (size_t i = 0; i < batches.size(); i++) {
+        out.drawFeedback(drawShader, outputs[i].vao, GL_POINTS, outputs[i].feedback, batches[i].polygonMode);
+    }
+}
+
+void InstanceCuller::cull(const ViewParams& view) {
+    if (batches.empty() || !cullShader) return;
+
+    glm::vec4 planes[6];
+    extractFrustumPlanes(view.projection * view.view, planes);
+
+    glState().useProgram(cullShader->ID);
+    glUniform4fv(planesLocation, 6, &planes[0][0]);
+
+    // One point per instance in, one point per survivor out
+    glEnable(GL_RASTERIZER_DISCARD);
+    for (size_t i = 0; i < batches.size(); i++) {
+        const Output& output = outputs[i];
+        glState().bindVertexArray(batches[i].sourceVAO);
+        glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, output.feedback);
+        glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, output.query);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArraysInstanced(GL_POINTS, 0, 1, batches[i].count);
+        glEndTransformFeedback();
+        glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    }
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    viewsCulled++;
+}
+
+void InstanceCuller::reportStats() const {
+    GLsizei instances = 0;
+    GLuint survivors = 0;
+    for (size_t i = 0; i < batches.size() && viewsCulled > 0; i++) {
+        GLuint written = 0;
+        glGetQueryObjectuiv(outputs[i].query, GL_QUERY_RESULT, &written);
+        instances += batches[i].count;
+        survivors += written;
+    }
+
+    std::cout << "GPU instance culling: " << survivors << " of " << instances << " instances in the last view ("
+        << batches.size() << " batches, " << viewsCulled << " views culled last frame)" << std::endl;
+}
@@ -0,0 +1,174 @@
+#include "instance_stream.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+const size_t InstanceStream::SOLID_CAPACITY;
+const size_t InstanceStream::WIREFRAME_CAPACITY;
+
+InstanceStream::InstanceStream()
+    : overflowReported(false), staticBuffer(0), staticSolidCount(0), staticWireframeCount(0),
+    staticSolidVAO(0), staticWireframeVAO(0) {
+    cube.firstIndex = cube.indexCount = cube.baseVertex = 0;
+}
+
+InstanceStream::~InstanceStream() {
+    if (!solidVAOs.empty()) glDeleteVertexArrays((GLsizei)solidVAOs.size(), solidVAOs.data());
+    if (!wireframeVAOs.empty()) glDeleteVertexArrays((GLsizei)wireframeVAOs.size(), wireframeVAOs.data());
+    glDeleteVertexArrays(1, &staticSolidVAO);
+    glDeleteVertexArrays(1, &staticWireframeVAO);
+    glDeleteBuffers(1, &staticBuffer);
+}
+
+void InstanceStream::initialize(const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh, int regionCount) {
+    cube = cubeMesh;
+
+    solid.initialize(SOLID_CAPACITY * sizeof(glm::mat4), regionCount);
+    wireframe.initialize(WIREFRAME_CAPACITY * sizeof(glm::mat4), regionCount);
+
+    for (int region = 0; region < regionCount; region++) {
+        solidVAOs.push_back(createVAO(meshes, solid.getBuffer(), solid.getRegionOffset(region)));
+        wireframeVAOs.push_back(createVAO(meshes, wireframe.getBuffer(), wireframe.getRegionOffset(region)));
+    }
+
+    // Static matrices are placed when a room is uploaded; until then nothing is drawn
+    glGenBuffers(1, &staticBuffer);
+    staticSolidVAO = createVAO(meshes, staticBuffer, 0);
+    staticWireframeVAO = createVAO(meshes, staticBuffer, 0);
+
+    glState().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+unsigned int InstanceStream::createVAO(const MeshLibrary& meshes, unsigned int buffer, size_t base) {
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    glState().bindVertexArray(VAO);
+
+    // Cube mesh from the shared library buffers
+    meshes.bindLayout();
+
+    // Model matrix: four vec4 columns starting at base
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+            (void*)(base + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+
+    return VAO;
+}
+
+void InstanceStream::bindBatch(int region, InstanceBatch& batch) const {
+    batch.solid.setExternalStorage(static_cast<glm::mat4*>(solid.getRegionPointer(region)), SOLID_CAPACITY);
+    batch.wireframe.setExternalStorage(static_cast<glm::mat4*>(wireframe.getRegionPointer(region)), WIREFRAME_CAPACITY);
+}
+
+void InstanceStream::waitForRegion(int region) {
+    solid.waitForRegion(region);
+    wireframe.waitForRegion(region);
+}
+
+void InstanceStream::uploadStatic(const StaticRoomContent& content) {
+    staticSolidCount = content.fixed.solid.size();
+    staticWireframeCount = content.fixed.wireframe.size();
+
+    // Re-specified once per room; the VAOs keep the buffer name, only the offsets move
+    size_t total = staticSolidCount + staticWireframeCount;
+    glBindBuffer(GL_ARRAY_BUFFER, staticBuffer);
+    glBufferData(GL_ARRAY_BUFFER, total * sizeof(glm::mat4), nullptr, GL_STATIC_DRAW);
+    if (staticSolidCount > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, staticSolidCount * sizeof(glm::mat4), content.fixed.solid.data());
+    }
+    if (staticWireframeCount > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, staticSolidCount * sizeof(glm::mat4),
+            staticWireframeCount * sizeof(glm::mat4), content.fixed.wireframe.data());
+    }
+
+    // Point each VAO's model matrix at its range
+    std::vector<std::pair<unsigned int, size_t> > ranges;
+    ranges.push_back(std::make_pair(staticSolidVAO, (size_t)0));
+    ranges.push_back(std::make_pair(staticWireframeVAO, staticSolidCount));
+    for (const auto& range : ranges) {
+        glState().bindVertexArray(range.first);
+        for (int column = 0; column < 4; column++) {
+            glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                (void*)(range.second * sizeof(glm::mat4) + column * sizeof(glm::vec4)));
+        }
+    }
+
+    glState().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceStream::prepareList(StreamBuffer& buffer, int region, const InstanceList& list, size_t capacity) {
+    // Generators already wrote into the mapped region
+    if (list.isExternal() || list.empty()) return;
+
+    if (list.size() > capacity && !overflowReported) {
+        std::cerr << "Instance stream: " << list.size() << " instances exceed the region capacity of "
+            << capacity << ", drawing the first " << capacity << std::endl;
+        overflowReported = true;
+    }
+    buffer.upload(region, list.data(), list.size() * sizeof(glm::mat4));
+}
+
+void InstanceStream::prepare(int region, const InstanceBatch& batch) {
+    prepareList(solid, region, batch.solid, SOLID_CAPACITY);
+    prepareList(wireframe, region, batch.wireframe, WIREFRAME_CAPACITY);
+}
+
+void InstanceStream::record(int region, const InstanceBatch& batch, const Shader& shader, CommandList& out) const {
+    GLsizei solidCount = (GLsizei)std::min(batch.solid.size(), SOLID_CAPACITY);
+    GLsizei wireframeCount = (GLsizei)std::min(batch.wireframe.size(), WIREFRAME_CAPACITY);
+
+    if (solidCount > 0) {
+        out.drawIndexed(shader, solidVAOs[region], GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex,
+            solidCount);
+    }
+    if (wireframeCount > 0) {
+        out.drawIndexed(shader, wireframeVAOs[region], GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex,
+            wireframeCount, GL_LINE);
+    }
+}
+
+void InstanceStream::recordStatic(const Shader& shader, CommandList& out) const {
+    if (staticSolidCount > 0) {
+        out.drawIndexed(shader, staticSolidVAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex,
+            (GLsizei)staticSolidCount);
+    }
+    if (staticWireframeCount > 0) {
+        out.drawIndexed(shader, staticWireframeVAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount,
+            cube.baseVertex, (GLsizei)staticWireframeCount, GL_LINE);
+    }
+}
+
+void InstanceStream::addCullBatches(int region, const InstanceBatch& batch, InstanceCuller& culler) const {
+    // Same counts as record and recordStatic
+    culler.addBatch(solidVAOs[region], (GLsizei)std::min(batch.solid.size(), SOLID_CAPACITY));
+    culler.addBatch(wireframeVAOs[region], (GLsizei)std::min(batch.wireframe.size(), WIREFRAME_CAPACITY), GL_LINE);
+    culler.addBatch(staticSolidVAO, (GLsizei)staticSolidCount);
+    culler.addBatch(staticWireframeVAO, (GLsizei)staticWireframeCount, GL_LINE);
+}
+
+void InstanceStream::fenceRegion(int region) {
+    solid.fenceRegion(region);
+    wireframe.fenceRegion(region);
+}
+
+void InstanceStream::reportStats() {
+    const StreamBuffer::Stats& solidStats = solid.getStats();
+    const StreamBuffer::Stats& wireframeStats = wireframe.getStats();
+
+    std::cout << "Instance stream (" << (solid.isPersistent() ? "persistent mapping" : "orphaning") << "): "
+        << solidStats.waits + wireframeStats.waits << " fence waits, "
+        << solidStats.stalls + wireframeStats.stalls << " stalls ("
+        << solidStats.stallMilliseconds + wireframeStats.stallMilliseconds << " ms), "
+        << solidStats.uploads + wireframeStats.uploads << " copied uploads" << std::endl;
+    std::cout << "Static instances: " << staticSolidCount + staticWireframeCount << std::endl;
+
+    solid.resetStats();
+    wireframe.resetStats();
+}
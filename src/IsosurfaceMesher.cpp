@@ -0,0 +1,344 @@
+#include "isosurface_mesher.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x4f534953;  // "SISO"
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        int32_t chunkCount;   // Chunks in the grid
+        int32_t storedCount;  // Non-empty chunks that follow
+    };
+
+    struct CacheChunk {
+        int32_t chunk[3];
+        uint32_t vertexFloats;
+        uint32_t indexCount;
+    };
+
+    // Corners of a cell in bit order (x = bit 0, y = bit 1, z = bit 2) and its 12 edges
+    struct CellEdges {
+        int from[12];
+        int to[12];
+
+        CellEdges() {
+            int edge = 0;
+            for (int corner = 0; corner < 8; corner++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    if (corner & (1 << axis)) continue;
+                    from[edge] = corner;
+                    to[edge] = corner | (1 << axis);
+                    edge++;
+                }
+            }
+        }
+    };
+    const CellEdges CELL_EDGES;
+
+    uint64_t fnv1a(const std::string& text) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+IsosurfaceMesher::IsosurfaceMesher()
+    : jobs(nullptr), extractionSeconds(0.0), chunkCount(0), uploadedChunks(0), triangles(0),
+      loadedFromCache(false), wallMs(0.0) {
+}
+
+IsosurfaceMesher::~IsosurfaceMesher() {
+    // Chunk jobs push into finished and read field
+    if (jobs) jobs->wait(group);
+}
+
+void IsosurfaceMesher::extractChunk(const Field& field, const Settings& settings, const glm::ivec3& chunk,
+    ChunkMesh& out) {
+    const int cells = settings.chunkCells;
+    const int samples = cells + 2;
+    const float spacing = settings.boxSize / settings.resolution;
+
+    // Corners from one before the chunk's first to one past its last, so the cells on
+    // its low sides and the edges on its high sides are available
+    glm::ivec3 firstCorner = chunk * cells - glm::ivec3(1);
+    glm::vec3 origin = settings.boxMin + glm::vec3(firstCorner) * spacing;
+
+    std::vector<float> values((size_t)samples * samples * samples);
+    field(origin, spacing, samples, values.data());
+
+    auto sampleIndex = [samples](int x, int y, int z) {
+        return ((size_t)z * samples + y) * samples + x;
+    };
+
+    out.chunk = chunk;
+    out.vertices.clear();
+    out.indices.clear();
+
+    // One vertex per crossed cell; cell (x, y, z) spans samples x..x+1 and so on
+    const int cellSide = cells + 1;
+    std::vector<int> cellVertex((size_t)cellSide * cellSide * cellSide, -1);
+    auto cellIndex = [cellSide](int x, int y, int z) {
+        return ((size_t)z * cellSide + y) * cellSide + x;
+    };
+
+    for (int z = 0; z < cellSide; z++) {
+        for (int y = 0; y < cellSide; y++) {
+            for (int x = 0; x < cellSide; x++) {
+                float corner[8];
+                int insideMask = 0;
+                for (int i = 0; i < 8; i++) {
+                    corner[i] = values[sampleIndex(x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1))];
+                    if (corner[i] < settings.isoLevel) insideMask |= 1 << i;
+                }
+                if (insideMask == 0 || insideMask == 0xff) continue;
+
+                // Mean of the crossings along the cell's edges
+                glm::vec3 sum(0.0f);
+                int crossings = 0;
+                for (int edge = 0; edge < 12; edge++) {
+                    int a = CELL_EDGES.from[edge], b = CELL_EDGES.to[edge];
+                    if (((insideMask >> a) & 1) == ((insideMask >> b) & 1)) continue;
+
+                    float t = (settings.isoLevel - corner[a]) / (corner[b] - corner[a]);
+                    glm::vec3 pa((float)(a & 1), (float)((a >> 1) & 1), (float)((a >> 2) & 1));
+                    glm::vec3 pb((float)(b & 1), (float)((b >> 1) & 1), (float)((b >> 2) & 1));
+                    sum += pa + (pb - pa) * t;
+                    crossings++;
+                }
+                // From the global cell so neighbouring chunks round the same way
+                glm::vec3 cell(firstCorner + glm::ivec3(x, y, z));
+                glm::vec3 position = settings.boxMin + (cell + sum / (float)crossings) * spacing;
+
+                // The field grows outwards, so its gradient across the cell is the normal
+                glm::vec3 gradient(
+                    corner[1] + corner[3] + corner[5] + corner[7] - corner[0] - corner[2] - corner[4] - corner[6],
+                    corner[2] + corner[3] + corner[6] + corner[7] - corner[0] - corner[1] - corner[4] - corner[5],
+                    corner[4] + corner[5] + corner[6] + corner[7] - corner[0] - corner[1] - corner[2] - corner[3]);
+                float length = glm::length(gradient);
+                glm::vec3 normal = length > 1e-12f ? gradient / length : glm::vec3(0.0f, 1.0f, 0.0f);
+
+                cellVertex[cellIndex(x, y, z)] = (int)(out.vertices.size() / 8);
+                float vertex[8] = { position.x, position.y, position.z, normal.x, normal.y, normal.z,
+                    (position.x + position.z) * 0.1f, position.y * 0.1f };
+                out.vertices.insert(out.vertices.end(), vertex, vertex + 8);
+            }
+        }
+    }
+
+    // A crossed edge from sample s along axis a is shared by the cells at s and s - 1 on
+    // the other two axes. The chunk owns the edges starting at its own corners (samples
+    // 1..cells), so every edge of the grid becomes exactly one quad.
+    for (int z = 1; z <= cells; z++) {
+        for (int y = 1; y <= cells; y++) {
+            for (int x = 1; x <= cells; x++) {
+                glm::ivec3 s(x, y, z);
+                bool inside = values[sampleIndex(x, y, z)] < settings.isoLevel;
+
+                for (int a = 0; a < 3; a++) {
+                    glm::ivec3 next = s;
+                    next[a]++;
+                    if ((values[sampleIndex(next.x, next.y, next.z)] < settings.isoLevel) == inside) continue;
+
+                    // b and c follow a cyclically, so the quad winds counter-clockwise seen
+                    // from +a; flipped when the inside is on the +a side
+                    int b = (a + 1) % 3, c = (a + 2) % 3;
+                    glm::ivec3 q[4] = { s, s, s, s };
+                    q[0][b]--; q[0][c]--;
+                    q[1][c]--;
+                    q[3][b]--;
+
+                    int v[4];
+                    for (int i = 0; i < 4; i++) v[i] = cellVertex[cellIndex(q[i].x, q[i].y, q[i].z)];
+
+                    const int order[2][6] = { { 0, 2, 1, 0, 3, 2 }, { 0, 1, 2, 0, 2, 3 } };
+                    for (int i = 0; i < 6; i++) {
+                        out.indices.push_back((uint16_t)v[order[inside ? 1 : 0][i]]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void IsosurfaceMesher::start(const Settings& requested, const Field& sampler, JobSystem* jobSystem) {
+    if (jobs) jobs->wait(group);
+
+    settings = requested;
+    field = sampler;
+    jobs = jobSystem;
+    finished.clear();
+    cacheChunks.clear();
+    uploaded.clear();
+    extractionSeconds = 0.0;
+    uploadedChunks = 0;
+    triangles = 0;
+    wallMs = 0.0;
+    startTime = std::chrono::high_resolution_clock::now();
+
+    if (settings.chunkCells < 1 || settings.chunkCells > 32 || settings.resolution % settings.chunkCells != 0) {
+        std::cerr << "Isosurface: " << settings.chunkCells << "-cell chunks do not fit a resolution of "
+            << settings.resolution << std::endl;
+        chunkCount = 0;
+        return;
+    }
+
+    int chunksPerSide = settings.resolution / settings.chunkCells;
+    chunkCount = chunksPerSide * chunksPerSide * chunksPerSide;
+
+    loadedFromCache = loadCache();
+    if (loadedFromCache) return;
+
+    for (int z = 0; z < chunksPerSide; z++) {
+        for (int y = 0; y < chunksPerSide; y++) {
+            for (int x = 0; x < chunksPerSide; x++) {
+                glm::ivec3 chunk(x, y, z);
+                auto job = [this, chunk]() {
+                    auto begin = std::chrono::high_resolution_clock::now();
+                    ChunkMesh mesh;
+                    extractChunk(field, settings, chunk, mesh);
+                    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+                    std::lock_guard<std::mutex> lock(finishedMutex);
+                    finished.push_back(std::move(mesh));
+                    extractionSeconds += seconds;
+                };
+                if (jobs) jobs->spawn(group, job);
+                else job();
+            }
+        }
+    }
+}
+
+void IsosurfaceMesher::update(MeshLibrary& meshes) {
+    if (uploadedChunks == chunkCount) return;
+
+    std::vector<ChunkMesh> ready;
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        ready.swap(finished);
+    }
+
+    for (ChunkMesh& chunk : ready) {
+        uploadedChunks++;
+        if (chunk.indices.empty()) continue;
+
+        UploadedChunk entry;
+        entry.mesh = meshes.add(chunk.vertices, chunk.indices);
+        glm::vec3 chunkSize(settings.boxSize * settings.chunkCells / settings.resolution);
+        entry.center = settings.boxMin + (glm::vec3(chunk.chunk) + glm::vec3(0.5f)) * chunkSize;
+        if (entry.mesh.indexCount > 0) {
+            uploaded.push_back(entry);
+            triangles += entry.mesh.indexCount / 3;
+        }
+        if (!loadedFromCache) cacheChunks.push_back(std::move(chunk));
+    }
+
+    if (uploadedChunks == chunkCount) {
+        wallMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        if (!loadedFromCache) saveCache();
+        cacheChunks.clear();
+        cacheChunks.shrink_to_fit();
+        reportStats();
+    }
+}
+
+void IsosurfaceMesher::record(const Shader& shader, const glm::mat4& model, const MeshLibrary& meshes,
+    CommandList& out) const {
+    if (uploaded.empty()) return;
+
+    out.setMat4(shader, "model", model);
+    for (const UploadedChunk& chunk : uploaded) {
+        out.setDepthCenter(glm::vec3(model * glm::vec4(chunk.center, 1.0f)));
+        out.drawIndexed(shader, meshes.getVAO(), GL_TRIANGLES, chunk.mesh.firstIndex, chunk.mesh.indexCount,
+            chunk.mesh.baseVertex);
+    }
+}
+
+void IsosurfaceMesher::reportStats() const {
+    long long cells = (long long)settings.resolution * settings.resolution * settings.resolution;
+    std::cout << "Isosurface: " << uploadedChunks << " of " << chunkCount << " chunks, " << uploaded.size()
+        << " meshes, " << triangles << " triangles";
+    if (loadedFromCache) {
+        std::cout << ", loaded from " << cachePath();
+    }
+    else if (isComplete() && extractionSeconds > 0.0) {
+        // Chunk job time summed over threads, so this is per core regardless of thread count
+        std::cout << ", " << settings.resolution << "^3 voxels in " << wallMs << " ms ("
+            << cells / extractionSeconds / 1e6 << " M voxels/s per core)";
+    }
+    std::cout << std::endl;
+}
+
+std::string IsosurfaceMesher::cachePath() const {
+    std::ostringstream key;
+    key << std::setprecision(9) << CACHE_VERSION << ' ' << settings.fieldKey << ' '
+        << settings.boxMin.x << ' ' << settings.boxMin.y << ' ' << settings.boxMin.z << ' ' << settings.boxSize << ' '
+        << settings.resolution << ' ' << settings.chunkCells << ' ' << settings.isoLevel;
+
+    std::ostringstream path;
+    path << "isosurface_" << std::hex << std::setw(16) << std::setfill('0') << fnv1a(key.str()) << ".cache";
+    return path.str();
+}
+
+bool IsosurfaceMesher::loadCache() {
+    if (settings.fieldKey.empty()) return false;
+
+    std::ifstream file(cachePath(), std::ios::binary);
+    if (!file) return false;
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.chunkCount != chunkCount) {
+        return false;
+    }
+
+    std::vector<ChunkMesh> chunks(header.storedCount);
+    for (ChunkMesh& chunk : chunks) {
+        CacheChunk entry;
+        if (!file.read(reinterpret_cast<char*>(&entry), sizeof(entry))) return false;
+
+        chunk.chunk = glm::ivec3(entry.chunk[0], entry.chunk[1], entry.chunk[2]);
+        chunk.vertices.resize(entry.vertexFloats);
+        chunk.indices.resize(entry.indexCount);
+        file.read(reinterpret_cast<char*>(chunk.vertices.data()), entry.vertexFloats * sizeof(float));
+        file.read(reinterpret_cast<char*>(chunk.indices.data()), entry.indexCount * sizeof(uint16_t));
+        if (!file) {
+            std::cerr << "Isosurface: cache " << cachePath() << " is truncated, extracting" << std::endl;
+            return false;
+        }
+    }
+
+    // Empty chunks are not stored; the rest go through the usual upload path
+    std::lock_guard<std::mutex> lock(finishedMutex);
+    finished = std::move(chunks);
+    finished.resize(chunkCount);
+    return true;
+}
+
+void IsosurfaceMesher::saveCache() const {
+    if (settings.fieldKey.empty()) return;
+
+    std::ofstream file(cachePath(), std::ios::binary | std::ios::trunc);
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, chunkCount, (int32_t)cacheChunks.size() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const ChunkMesh& chunk : cacheChunks) {
+        CacheChunk entry = { { chunk.chunk.x, chunk.chunk.y, chunk.chunk.z },
+            (uint32_t)chunk.vertices.size(), (uint32_t)chunk.indices.size() };
+        file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        file.write(reinterpret_cast<const char*>(chunk.vertices.data()), chunk.vertices.size() * sizeof(float));
+        file.write(reinterpret_cast<const char*>(chunk.indices.data()), chunk.indices.size() * sizeof(uint16_t));
+    }
+    if (!file) {
+        std::cerr << "Isosurface: could not write cache " << cachePath() << std::endl;
+    }
+}
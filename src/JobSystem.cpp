@@ -0,0 +1,162 @@
+#include "job_system.h"
+#include <algorithm>
+
+namespace {
+    // Identity of the current thread within the job system that spawned it
+    thread_local const JobSystem* tlsOwner = nullptr;
+    thread_local int tlsWorkerIndex = 0;
+}
+
+JobSystem::JobSystem(unsigned int workerCount) : queuedJobs(0), running(true) {
+    // One injection queue for outside threads plus one deque per worker
+    for (unsigned int i = 0; i <= workerCount; i++) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+
+    for (unsigned int i = 1; i <= workerCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, (int)i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running.store(false);
+    }
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int JobSystem::defaultWorkerCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+}
+
+int JobSystem::currentThreadIndex() {
+    return tlsOwner ? tlsWorkerIndex : 0;
+}
+
+unsigned int JobSystem::getThreadCount() const {
+    return (unsigned int)workers.size() + 1;
+}
+
+unsigned int JobSystem::getWorkerCount() const {
+    return (unsigned int)workers.size();
+}
+
+void JobSystem::spawn(JobGroup& group, Job job) {
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    // Without workers the job runs immediately on the caller
+    if (workers.empty()) {
+        QueuedJob inlineJob = { std::move(job), &group };
+        execute(inlineJob);
+        return;
+    }
+
+    // Workers push onto their own deque, everyone else onto the injection queue
+    int queueIndex = (tlsOwner == this) ? tlsWorkerIndex : 0;
+    {
+        std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+        queues[queueIndex]->jobs.push_back({ std::move(job), &group });
+    }
+    queuedJobs.fetch_add(1, std::memory_order_release);
+
+    // Taking the sleep lock orders this wake-up after any worker's predicate check
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wakeCondition.notify_one();
+}
+
+void JobSystem::wait(JobGroup& group) {
+    int queueIndex = (tlsOwner == this) ? tlsWorkerIndex : 0;
+
+    // Help with queued work instead of blocking so fork/join never deadlocks
+    while (!group.isDone()) {
+        if (!tryRunOne(queueIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& fn) {
+    if (end <= begin) return;
+    grainSize = std::max(grainSize, 1);
+
+    // A single chunk is not worth the scheduling overhead
+    if (workers.empty() || end - begin <= grainSize) {
+        fn(begin, end);
+        return;
+    }
+
+    JobGroup group;
+    for (int chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize) {
+        int chunkEnd = std::min(chunkBegin + grainSize, end);
+        spawn(group, [&fn, chunkBegin, chunkEnd]() { fn(chunkBegin, chunkEnd); });
+    }
+    wait(group);
+}
+
+void JobSystem::workerLoop(int workerIndex) {
+    tlsOwner = this;
+    tlsWorkerIndex = workerIndex;
+
+    while (running.load(std::memory_order_acquire)) {
+        if (tryRunOne(workerIndex)) continue;
+
+        // Nothing to run or steal - sleep until new work is queued
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeCondition.wait(lock, [this]() {
+            return !running.load() || queuedJobs.load() > 0;
+        });
+    }
+
+    tlsOwner = nullptr;
+    tlsWorkerIndex = 0;
+}
+
+bool JobSystem::popOwn(int queueIndex, QueuedJob& out) {
+    WorkQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+
+    out = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(int thiefIndex, QueuedJob& out) {
+    int queueCount = (int)queues.size();
+
+    // Start with the neighbour so thieves spread out over the victims
+    for (int offset = 1; offset < queueCount; offset++) {
+        WorkQueue& victim = *queues[(thiefIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty()) continue;
+
+        out = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::tryRunOne(int queueIndex) {
+    if (queuedJobs.load(std::memory_order_acquire) == 0) return false;
+
+    QueuedJob queued;
+    if (!popOwn(queueIndex, queued) && !steal(queueIndex, queued)) {
+        return false;
+    }
+
+    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    execute(queued);
+    return true;
+}
+
+void JobSystem::execute(QueuedJob& queued) {
+    queued.job();
+    queued.group->pending.fetch_sub(1, std::memory_order_release);
+}
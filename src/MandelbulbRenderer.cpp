@@ -0,0 +1,153 @@
+#include "mandelbulb_renderer.h"
+#include "gl_state.h"
+#include <iostream>
+
+const int MandelbulbRenderer::TILE_SIZE;
+const int MandelbulbRenderer::TEXTURE_UNIT_TILES;
+const int MandelbulbRenderer::TEXTURE_UNIT_COLOR;
+const int MandelbulbRenderer::TEXTURE_UNIT_DEPTH;
+
+namespace {
+    // Encloses the bulb for every power the shaders animate through (4 to 12), in fractal units
+    const float BOUND_RADIUS = 1.5f;
+
+    unsigned int createTarget(GLenum internalFormat, GLenum format, GLenum type, int width, int height) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glState().bindTexture2D(0, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+
+        // Read back with texelFetch only
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+
+    bool checkFramebuffer(const char* name) {
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Mandelbulb renderer: " << name << " framebuffer not complete" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+MandelbulbRenderer::Settings MandelbulbRenderer::defaultSettings(const glm::vec3& spawnPosition) {
+    Settings settings;
+    settings.center = spawnPosition + glm::vec3(0.0f, 8.0f, -45.0f);
+    settings.scale = 10.0f;
+    return settings;
+}
+
+MandelbulbRenderer::MandelbulbRenderer()
+    : width(0), height(0), marchWidth(0), marchHeight(0), tilesX(0), tilesY(0), VAO(0),
+      tileFramebuffer(0), tileTexture(0), marchFramebuffer(0), colorTexture(0), depthTexture(0) {
+    settings = defaultSettings(glm::vec3(0.0f));
+}
+
+MandelbulbRenderer::~MandelbulbRenderer() {
+    unsigned int textures[3] = { tileTexture, colorTexture, depthTexture };
+    unsigned int framebuffers[2] = { tileFramebuffer, marchFramebuffer };
+    glDeleteTextures(3, textures);
+    glDeleteFramebuffers(2, framebuffers);
+    glDeleteVertexArrays(1, &VAO);
+    glState().invalidate();
+}
+
+bool MandelbulbRenderer::initialize(const Settings& requested, int windowWidth, int windowHeight) {
+    settings = requested;
+    width = windowWidth;
+    height = windowHeight;
+    marchWidth = (width + 1) / 2;
+    marchHeight = (height + 1) / 2;
+    tilesX = (marchWidth + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (marchHeight + TILE_SIZE - 1) / TILE_SIZE;
+
+    if (VAO == 0) glGenVertexArrays(1, &VAO);
+
+    // Cone pass: one start distance per tile
+    tileTexture = createTarget(GL_R32F, GL_RED, GL_FLOAT, tilesX, tilesY);
+    glGenFramebuffers(1, &tileFramebuffer);
+    glState().bindFramebuffer(tileFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tileTexture, 0);
+    bool complete = checkFramebuffer("cone");
+
+    // March pass: colour and linear depth; no depth buffer, every fragment writes both
+    colorTexture = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, marchWidth, marchHeight);
+    depthTexture = createTarget(GL_R32F, GL_RED, GL_FLOAT, marchWidth, marchHeight);
+    glGenFramebuffers(1, &marchFramebuffer);
+    glState().bindFramebuffer(marchFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, depthTexture, 0);
+    const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    complete = checkFramebuffer("march") && complete;
+
+    glState().bindFramebuffer(0);
+
+    std::cout << "Mandelbulb renderer: marching " << marchWidth << "x" << marchHeight << ", "
+        << tilesX * tilesY << " cone tiles" << std::endl;
+    return complete;
+}
+
+void MandelbulbRenderer::setRayUniforms(const Shader& shader, const ViewParams& view, float time) const {
+    glm::mat4 viewProjection = view.projection * view.view;
+
+    shader.setMat4("inverseViewProjection", glm::inverse(viewProjection));
+    shader.setVec3("viewPos", view.viewPos);
+    shader.setVec2("targetSize", glm::vec2((float)marchWidth, (float)marchHeight));
+    // Height of one march pixel per unit of distance along the view axis
+    shader.setFloat("pixelAngle", 2.0f / (view.projection[1][1] * marchHeight));
+    shader.setInt("tileSize", TILE_SIZE);
+    shader.setVec3("bulbCenter", settings.center);
+    shader.setFloat("bulbScale", settings.scale);
+    shader.setFloat("bulbRadius", BOUND_RADIUS);
+    shader.setFloat("time", time);
+}
+
+void MandelbulbRenderer::render(const Shader& coneShader, const Shader& marchShader, const Shader& compositeShader,
+    const ViewParams& view, float time) const {
+    if (VAO == 0) return;
+
+    // The passes overwrite their targets; the scene's blending and wireframe do not apply
+    glState().setBlend(false);
+    glState().setDepthTest(false);
+    glState().polygonMode(GL_FILL);
+    glState().bindVertexArray(VAO);
+
+    // The composite goes back to the window's viewport, whatever size it has now
+    int windowViewport[4];
+    glState().getViewport(windowViewport);
+
+    glState().bindFramebuffer(tileFramebuffer);
+    glState().viewport(0, 0, tilesX, tilesY);
+    coneShader.use();
+    setRayUniforms(coneShader, view, time);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glState().bindFramebuffer(marchFramebuffer);
+    glState().viewport(0, 0, marchWidth, marchHeight);
+    marchShader.use();
+    setRayUniforms(marchShader, view, time);
+    marchShader.setMat4("viewProjection", view.projection * view.view);
+    glState().bindTexture2D(TEXTURE_UNIT_TILES, tileTexture);
+    marchShader.setInt("tileStart", TEXTURE_UNIT_TILES);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glState().bindFramebuffer(0);
+    glState().viewport(windowViewport[0], windowViewport[1], windowViewport[2], windowViewport[3]);
+    glState().setDepthTest(true);
+    compositeShader.use();
+    compositeShader.setMat4("projection", view.projection);
+    compositeShader.setVec4("viewport", glm::vec4((float)windowViewport[0], (float)windowViewport[1],
+        (float)windowViewport[2], (float)windowViewport[3]));
+    glState().bindTexture2D(TEXTURE_UNIT_COLOR, colorTexture);
+    glState().bindTexture2D(TEXTURE_UNIT_DEPTH, depthTexture);
+    compositeShader.setInt("marchColor", TEXTURE_UNIT_COLOR);
+    compositeShader.setInt("marchDepth", TEXTURE_UNIT_DEPTH);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glState().setBlend(true);
+}
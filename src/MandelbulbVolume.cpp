@@ -0,0 +1,295 @@
+#include "mandelbulb_volume.h"
+#include "anim_math.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+const int MandelbulbVolume::TEXTURE_UNIT_A;
+const int MandelbulbVolume::TEXTURE_UNIT_B;
+const int MandelbulbVolume::SLICES_PER_JOB;
+
+namespace {
+    // Same constants as mandelbulbDE() and its caller in f_room_psychedelic.glsl
+    const int ITERATIONS = 7;
+    const float BAILOUT = 2.0f;
+    const float EPSILON = 0.0001f;
+    const float POSITION_SCALE = 0.1f;
+
+    const float LN_2 = 0.693147180559945f;
+
+    // Scratch arrays for one row of points, in structure-of-arrays form
+    enum RowArray {
+        C_X, C_Y, C_Z,       // Point being estimated
+        Z_X, Z_Y, Z_Z,       // Iterate
+        RADIUS, DERIVATIVE,
+        SIN_THETA, COS_THETA, // Before the polar conversion
+        THETA, PHI,
+        BASE, EXPONENT, POWERED,
+        SIN_T, COS_T, SIN_P, COS_P,
+        ROW_ARRAYS
+    };
+}
+
+MandelbulbVolume::Settings MandelbulbVolume::defaultSettings(const glm::vec3& center) {
+    Settings settings;
+    settings.center = center;
+    settings.halfExtent = 40.0f;
+    settings.size = 64;
+    settings.keyframeInterval = 2.0f;
+    return settings;
+}
+
+MandelbulbVolume::MandelbulbVolume()
+    : jobs(nullptr), keyframe(0), blend(0.0f), stagingKeyframe(-1), bakeMs(0.0), bakes(0), lateFrames(0) {
+    settings = defaultSettings(glm::vec3(0.0f));
+    textures[0] = textures[1] = 0;
+}
+
+MandelbulbVolume::~MandelbulbVolume() {
+    // Background jobs write into staging
+    if (jobs) jobs->wait(pending);
+    glDeleteTextures(2, textures);
+    glState().invalidate();
+}
+
+float MandelbulbVolume::powerAt(float time) {
+    return 8.0f + 4.0f * std::sin(time * 0.1f);
+}
+
+float MandelbulbVolume::distanceAt(const glm::vec3& position, float power) {
+    glm::vec3 c = position * POSITION_SCALE;
+    glm::vec3 z = c;
+    float dr = 1.0f;
+    float r = 0.0f;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        r = glm::length(z);
+        if (r > BAILOUT) break;
+
+        float theta = r > EPSILON ? std::acos(glm::clamp(z.z / r, -1.0f, 1.0f)) : 0.0f;
+        float phi = std::atan2(z.y, z.x);
+        dr = std::pow(std::max(r, EPSILON), power - 1.0f) * power * dr + 1.0f;
+
+        float zr = std::pow(r, power);
+        theta *= power;
+        phi *= power;
+
+        z = zr * glm::vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)) + c;
+    }
+    return 0.5f * std::log(std::max(r, EPSILON)) * r / std::max(dr, EPSILON);
+}
+
+void MandelbulbVolume::bake(const glm::vec3& boxMin, float texelSize, int size, float power,
+    int zBegin, int zEnd, float* out) {
+    std::vector<float> scratch((size_t)ROW_ARRAYS * size);
+    float* row[ROW_ARRAYS];
+    for (int i = 0; i < ROW_ARRAYS; i++) row[i] = &scratch[(size_t)i * size];
+    std::vector<char> active(size);
+
+    std::fill(row[EXPONENT], row[EXPONENT] + size, power - 1.0f);
+
+    for (int z = zBegin; z < zEnd; z++) {
+        for (int y = 0; y < size; y++) {
+            float cy = (boxMin.y + (y + 0.5f) * texelSize) * POSITION_SCALE;
+            float cz = (boxMin.z + (z + 0.5f) * texelSize) * POSITION_SCALE;
+            for (int x = 0; x < size; x++) {
+                float cx = (boxMin.x + (x + 0.5f) * texelSize) * POSITION_SCALE;
+                row[C_X][x] = row[Z_X][x] = cx;
+                row[C_Y][x] = row[Z_Y][x] = cy;
+                row[C_Z][x] = row[Z_Z][x] = cz;
+                row[RADIUS][x] = 0.0f;
+                row[DERIVATIVE][x] = 1.0f;
+                active[x] = 1;
+            }
+
+            for (int i = 0; i < ITERATIONS; i++) {
+                // Points past the bailout keep their radius and derivative; the others get
+                // the inputs of the polar conversion. acos(c) is taken as atan2(sqrt(1 - c^2), c).
+                bool anyActive = false;
+                for (int x = 0; x < size; x++) {
+                    if (!active[x]) continue;
+
+                    float zx = row[Z_X][x], zy = row[Z_Y][x], zz = row[Z_Z][x];
+                    float r = std::sqrt(zx * zx + zy * zy + zz * zz);
+                    row[RADIUS][x] = r;
+                    if (r > BAILOUT) {
+                        active[x] = 0;
+                        continue;
+                    }
+                    anyActive = true;
+
+                    float cosTheta = r > EPSILON ? glm::clamp(zz / r, -1.0f, 1.0f) : 1.0f;
+                    row[COS_THETA][x] = cosTheta;
+                    row[SIN_THETA][x] = std::sqrt(1.0f - cosTheta * cosTheta);
+                    row[BASE][x] = std::max(r, EPSILON);
+                }
+                if (!anyActive) break;
+
+                // Inactive lanes run through the kernels on stale but finite values
+                atan2Array(row[SIN_THETA], row[COS_THETA], row[THETA], size);
+                atan2Array(row[Z_Y], row[Z_X], row[PHI], size);
+                powArray(row[BASE], row[EXPONENT], row[POWERED], size);
+                for (int x = 0; x < size; x++) {
+                    row[THETA][x] *= power;
+                    row[PHI][x] *= power;
+                }
+                sinCosArray(row[THETA], row[SIN_T], row[COS_T], size);
+                sinCosArray(row[PHI], row[SIN_P], row[COS_P], size);
+
+                for (int x = 0; x < size; x++) {
+                    if (!active[x]) continue;
+
+                    // r^power as r^(power - 1) * r; the two differ only below EPSILON
+                    float powered = row[POWERED][x];
+                    float zr = powered * row[RADIUS][x];
+                    row[DERIVATIVE][x] = powered * power * row[DERIVATIVE][x] + 1.0f;
+
+                    row[Z_X][x] = zr * row[SIN_T][x] * row[COS_P][x] + row[C_X][x];
+                    row[Z_Y][x] = zr * row[SIN_T][x] * row[SIN_P][x] + row[C_Y][x];
+                    row[Z_Z][x] = zr * row[COS_T][x] + row[C_Z][x];
+                }
+            }
+
+            float* texels = out + ((size_t)z * size + y) * size;
+            for (int x = 0; x < size; x++) {
+                float r = row[RADIUS][x];
+                float logR = fastLog2(std::max(r, EPSILON)) * LN_2;
+                texels[x] = 0.5f * logR * r / std::max(row[DERIVATIVE][x], EPSILON);
+            }
+        }
+    }
+}
+
+bool MandelbulbVolume::initialize(const Settings& requested, JobSystem* jobSystem, float time) {
+    settings = requested;
+    jobs = jobSystem;
+    if (settings.size < 2 || settings.size > 256 || settings.keyframeInterval <= 0.0f) {
+        std::cerr << "Mandelbulb volume: invalid settings, using the analytic estimate" << std::endl;
+        return false;
+    }
+
+    if (textures[0] == 0) glGenTextures(2, textures);
+    for (int i = 0; i < 2; i++) {
+        glState().bindTexture3D(TEXTURE_UNIT_A + i, textures[i]);
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_R16F, settings.size, settings.size, settings.size, 0,
+            GL_RED, GL_FLOAT, nullptr);
+
+        // Re-uploaded every keyframe, so no mipmaps; the shader only samples inside the box
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // Anything above keyframe + 1 forces the synchronous bake of both keyframes
+    keyframe = -2;
+    update(time);
+
+    std::cout << "Mandelbulb volume: " << settings.size << "^3 R16F, keyframes every "
+        << settings.keyframeInterval << " s, baked in " << bakeMs << " ms" << std::endl;
+    return true;
+}
+
+void MandelbulbVolume::update(float time) {
+    if (textures[0] == 0) return;
+
+    int current = (int)std::floor(time / settings.keyframeInterval);
+    if (current != keyframe && current != keyframe + 1) {
+        // First bake, or the room was left for a while: rebuild both keyframes now
+        if (jobs) jobs->wait(pending);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        bakeNow(current, staging);
+        upload(textures[0], staging);
+        bakeNow(current + 1, staging);
+        upload(textures[1], staging);
+        auto end = std::chrono::high_resolution_clock::now();
+        bakeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        keyframe = current;
+        stagingKeyframe = -1;
+    }
+    else if (current == keyframe + 1) {
+        if (stagingKeyframe == keyframe + 2 && pending.isDone()) {
+            // The older keyframe's texture takes the next one
+            upload(textures[0], staging);
+            std::swap(textures[0], textures[1]);
+            keyframe++;
+            stagingKeyframe = -1;
+        }
+        else {
+            lateFrames++;
+        }
+    }
+
+    if (stagingKeyframe != keyframe + 2 && pending.isDone()) {
+        startBake(keyframe + 2);
+    }
+
+    // Held at the newer keyframe while its successor is still baking
+    float start = keyframe * settings.keyframeInterval;
+    blend = glm::clamp((time - start) / settings.keyframeInterval, 0.0f, 1.0f);
+}
+
+void MandelbulbVolume::apply(const Shader& shader, bool enabled) const {
+    bool available = textures[0] != 0;
+    if (available) {
+        glState().bindTexture3D(TEXTURE_UNIT_A, textures[0]);
+        glState().bindTexture3D(TEXTURE_UNIT_B, textures[1]);
+    }
+
+    shader.setInt("mandelbulbVolumeA", TEXTURE_UNIT_A);
+    shader.setInt("mandelbulbVolumeB", TEXTURE_UNIT_B);
+    shader.setFloat("mandelbulbBlend", blend);
+    shader.setVec3("mandelbulbVolumeMin", boxMin());
+    shader.setFloat("mandelbulbVolumeSize", 2.0f * settings.halfExtent);
+    shader.setBool("useMandelbulbVolume", enabled && available);
+}
+
+void MandelbulbVolume::bakeNow(int frameIndex, std::vector<float>& out) {
+    int size = settings.size;
+    out.resize((size_t)size * size * size);
+    float power = powerAt(frameIndex * settings.keyframeInterval);
+    glm::vec3 origin = boxMin();
+    float step = texelSize();
+    float* texels = out.data();
+
+    auto bakeSlices = [&](int zBegin, int zEnd) {
+        bake(origin, step, size, power, zBegin, zEnd, texels);
+    };
+    if (jobs) jobs->parallelFor(0, size, 1, bakeSlices);
+    else bakeSlices(0, size);
+    bakes++;
+}
+
+void MandelbulbVolume::startBake(int frameIndex) {
+    int size = settings.size;
+    staging.resize((size_t)size * size * size);
+    stagingKeyframe = frameIndex;
+    bakes++;
+
+    float power = powerAt(frameIndex * settings.keyframeInterval);
+    glm::vec3 origin = boxMin();
+    float step = texelSize();
+    float* texels = staging.data();
+
+    for (int zBegin = 0; zBegin < size; zBegin += SLICES_PER_JOB) {
+        int zEnd = std::min(zBegin + SLICES_PER_JOB, size);
+        auto job = [origin, step, size, power, zBegin, zEnd, texels]() {
+            bake(origin, step, size, power, zBegin, zEnd, texels);
+        };
+        // Without workers the bake runs here, all at once
+        if (jobs) jobs->spawn(pending, job);
+        else job();
+    }
+}
+
+void MandelbulbVolume::upload(unsigned int texture, const std::vector<float>& values) {
+    glState().bindTexture3D(TEXTURE_UNIT_A, texture);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, settings.size, settings.size, settings.size,
+        GL_RED, GL_FLOAT, values.data());
+}
@@ -0,0 +1,163 @@
+#include "mesh_library.h"
+#include "gl_state.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <utility>
+
+const size_t MeshLibrary::VERTEX_CAPACITY;
+const size_t MeshLibrary::INDEX_CAPACITY;
+const size_t MeshLibrary::VERTEX_SIZE;
+
+namespace {
+    // Octahedral normal encoding: project onto the octahedron |x| + |y| + |z| = 1 and fold
+    // the lower half over the diagonals, so the direction fits in two [-1, 1] values
+    glm::vec2 encodeOctahedral(glm::vec3 n) {
+        n /= (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+        glm::vec2 e(n.x, n.y);
+        if (n.z < 0.0f) {
+            e = glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+        }
+        return e;
+    }
+}
+
+MeshLibrary::MeshLibrary() : vertexSpace(VERTEX_CAPACITY), indexSpace(INDEX_CAPACITY) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glState().bindVertexArray(VAO);
+    bindLayout();
+    glBufferData(GL_ARRAY_BUFFER, VERTEX_CAPACITY * sizeof(PackedVertex), NULL, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, INDEX_CAPACITY * sizeof(uint16_t), NULL, GL_STATIC_DRAW);
+
+    glState().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+MeshLibrary::~MeshLibrary() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+MeshLibrary::PackedVertex MeshLibrary::pack(const float* v) {
+    PackedVertex packed;
+    for (int axis = 0; axis < 3; axis++) {
+        packed.position[axis] = glm::packHalf1x16(v[axis]);
+    }
+    packed.position[3] = glm::packHalf1x16(1.0f);
+
+    glm::vec2 normal = encodeOctahedral(glm::vec3(v[3], v[4], v[5]));
+    packed.normal[0] = (int16_t)glm::packSnorm1x16(normal.x);
+    packed.normal[1] = (int16_t)glm::packSnorm1x16(normal.y);
+
+    packed.texCoord[0] = glm::packHalf1x16(v[6]);
+    packed.texCoord[1] = glm::packHalf1x16(v[7]);
+    return packed;
+}
+
+MeshLibrary::Mesh MeshLibrary::add(const std::vector<float>& source) {
+    Mesh mesh = { 0, 0, 0, 0 };
+    if (source.size() < 8) return mesh;
+
+    // Staging data only lives until the upload below
+    std::vector<PackedVertex> vertices;
+    std::vector<uint16_t> indices;
+    indices.reserve(source.size() / 8);
+
+    // Indices are 16-bit and relative to the mesh's base vertex
+    std::map<std::pair<uint64_t, uint64_t>, uint16_t> unique;
+    size_t vertexCount = source.size() / 8;
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        PackedVertex packed = pack(&source[i * 8]);
+
+        std::pair<uint64_t, uint64_t> key;
+        std::memcpy(&key.first, &packed, sizeof(uint64_t));
+        std::memcpy(&key.second, reinterpret_cast<const char*>(&packed) + sizeof(uint64_t), sizeof(uint64_t));
+
+        auto it = unique.find(key);
+        if (it == unique.end()) {
+            if (vertices.size() > 0xFFFF) {
+                std::cerr << "ERROR: Mesh has more than 65536 unique vertices" << std::endl;
+                return mesh;
+            }
+            it = unique.insert(std::make_pair(key, (uint16_t)vertices.size())).first;
+            vertices.push_back(packed);
+        }
+        indices.push_back(it->second);
+    }
+
+    return upload(vertices, indices);
+}
+
+MeshLibrary::Mesh MeshLibrary::add(const std::vector<float>& source, const std::vector<uint16_t>& indices) {
+    Mesh mesh = { 0, 0, 0, 0 };
+    if (source.size() < 8 || indices.empty()) return mesh;
+    if (source.size() / 8 > 0x10000) {
+        std::cerr << "ERROR: Mesh has more than 65536 vertices" << std::endl;
+        return mesh;
+    }
+
+    std::vector<PackedVertex> vertices(source.size() / 8);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        vertices[i] = pack(&source[i * 8]);
+    }
+    return upload(vertices, indices);
+}
+
+MeshLibrary::Mesh MeshLibrary::upload(const std::vector<PackedVertex>& vertices, const std::vector<uint16_t>& indices) {
+    Mesh mesh = { 0, 0, 0, 0 };
+
+    size_t vertexOffset = vertexSpace.allocate(vertices.size());
+    size_t indexOffset = indexSpace.allocate(indices.size());
+    if (vertexOffset == FreeListAllocator::INVALID_OFFSET || indexOffset == FreeListAllocator::INVALID_OFFSET) {
+        std::cerr << "ERROR: Mesh library is full (" << vertices.size() << " vertices, "
+            << indices.size() << " indices requested)" << std::endl;
+        vertexSpace.release(vertexOffset, vertices.size());
+        indexSpace.release(indexOffset, indices.size());
+        return mesh;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * sizeof(PackedVertex),
+        vertices.size() * sizeof(PackedVertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The element buffer binding belongs to the VAO, so upload through the library's own
+    glState().bindVertexArray(VAO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset * sizeof(uint16_t),
+        indices.size() * sizeof(uint16_t), indices.data());
+
+    mesh.firstIndex = (GLint)indexOffset;
+    mesh.indexCount = (GLsizei)indices.size();
+    mesh.baseVertex = (GLint)vertexOffset;
+    mesh.vertexCount = (GLsizei)vertices.size();
+    return mesh;
+}
+
+void MeshLibrary::remove(const Mesh& mesh) {
+    if (mesh.indexCount == 0) return;
+    vertexSpace.release(mesh.baseVertex, mesh.vertexCount);
+    indexSpace.release(mesh.firstIndex, mesh.indexCount);
+}
+
+void MeshLibrary::bindLayout() const {
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoord));
+    glEnableVertexAttribArray(2);
+
+    // Element buffer binding is VAO state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+}
@@ -0,0 +1,188 @@
+#include "metric_field.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    const int SYMBOLS_PER_POINT = 18;
+
+    // Index of the symmetric pair (j, k) in Christoffel::symbols
+    const int PAIR_INDEX[3][3] = {
+        { 0, 1, 2 },
+        { 1, 3, 4 },
+        { 2, 4, 5 }
+    };
+
+    double secondsNow() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+MetricField::MetricField() : jobs(nullptr), started(false), slicesLeft(0), bakeMs(0.0) {
+    settings.origin = glm::vec3(0.0f);
+    settings.extent = glm::vec3(1.0f);
+    settings.resolution = glm::ivec3(2);
+}
+
+MetricField::~MetricField() {
+    // Background jobs write into symbols
+    if (jobs) jobs->wait(pending);
+}
+
+void MetricField::bake(const Settings& newSettings, const Metric& newMetric, JobSystem* jobSystem) {
+    if (started) return;
+    started = true;
+
+    settings = newSettings;
+    settings.resolution = glm::max(settings.resolution, glm::ivec3(2));
+    metric = newMetric;
+    jobs = jobSystem;
+
+    const glm::ivec3& r = settings.resolution;
+    symbols.assign((size_t)r.x * r.y * r.z * SYMBOLS_PER_POINT, 0.0f);
+    slicesLeft.store(r.z);
+
+    double start = secondsNow();
+    for (int z = 0; z < r.z; z++) {
+        if (jobs) {
+            jobs->spawn(pending, [this, z, start]() { bakeSlice(z, start); });
+        }
+        else {
+            bakeSlice(z, start);
+        }
+    }
+}
+
+bool MetricField::isReady() const {
+    return started && pending.isDone() && slicesLeft.load(std::memory_order_acquire) == 0;
+}
+
+void MetricField::bakeSlice(int z, double startSeconds) {
+    const glm::ivec3& r = settings.resolution;
+    glm::dvec3 spacing = glm::dvec3(settings.extent) / glm::dvec3(r - 1);
+
+    // Half a cell: finer differences would only resolve detail the trilinear lookup loses,
+    // and would turn the warp's seam at y = 0 into a spike
+    glm::dvec3 h = spacing * 0.5;
+
+    for (int y = 0; y < r.y; y++) {
+        for (int x = 0; x < r.x; x++) {
+            glm::dvec3 p = glm::dvec3(settings.origin) + glm::dvec3(x, y, z) * spacing;
+            glm::dmat3 inverse = glm::inverse(metric(p));
+
+            // dg[l][a][b] = d g_ab / d x^l
+            glm::dmat3 dg[3];
+            for (int l = 0; l < 3; l++) {
+                glm::dvec3 offset(0.0);
+                offset[l] = h[l];
+                dg[l] = (metric(p + offset) - metric(p - offset)) * (0.5 / h[l]);
+            }
+
+            float* out = &symbols[(((size_t)z * r.y + y) * r.x + x) * SYMBOLS_PER_POINT];
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    for (int k = j; k < 3; k++) {
+                        double sum = 0.0;
+                        for (int l = 0; l < 3; l++) {
+                            sum += inverse[i][l] * (dg[j][l][k] + dg[k][l][j] - dg[l][j][k]);
+                        }
+                        out[i * 6 + PAIR_INDEX[j][k]] = (float)(0.5 * sum);
+                    }
+                }
+            }
+        }
+    }
+
+    if (slicesLeft.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        bakeMs = (secondsNow() - startSeconds) * 1000.0;
+    }
+}
+
+bool MetricField::sample(const glm::vec3& position, Christoffel& out) const {
+    std::fill(&out.symbols[0][0], &out.symbols[0][0] + SYMBOLS_PER_POINT, 0.0f);
+    if (!isReady()) return false;
+
+    const glm::ivec3& r = settings.resolution;
+    glm::vec3 grid = (position - settings.origin) / settings.extent * glm::vec3(r - 1);
+    if (glm::any(glm::lessThan(grid, glm::vec3(0.0f))) ||
+        glm::any(glm::greaterThan(grid, glm::vec3(r - 1)))) {
+        return false;
+    }
+
+    glm::ivec3 cell = glm::min(glm::ivec3(grid), r - 2);
+    glm::vec3 f = grid - glm::vec3(cell);
+
+    for (int corner = 0; corner < 8; corner++) {
+        glm::ivec3 offset(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+        float weight = (offset.x ? f.x : 1.0f - f.x) * (offset.y ? f.y : 1.0f - f.y) *
+            (offset.z ? f.z : 1.0f - f.z);
+        glm::ivec3 point = cell + offset;
+        const float* in = &symbols[(((size_t)point.z * r.y + point.y) * r.x + point.x) * SYMBOLS_PER_POINT];
+
+        float* dst = &out.symbols[0][0];
+        for (int s = 0; s < SYMBOLS_PER_POINT; s++) {
+            dst[s] += weight * in[s];
+        }
+    }
+    return true;
+}
+
+glm::vec3 MetricField::contract(const Christoffel& c, const glm::vec3& a, const glm::vec3& b) {
+    // Symmetric in j and k: the off-diagonal pairs appear twice
+    float pairs[6] = {
+        a.x * b.x,
+        a.x * b.y + a.y * b.x,
+        a.x * b.z + a.z * b.x,
+        a.y * b.y,
+        a.y * b.z + a.z * b.y,
+        a.z * b.z
+    };
+
+    glm::vec3 result(0.0f);
+    for (int i = 0; i < 3; i++) {
+        for (int p = 0; p < 6; p++) {
+            result[i] += c.symbols[i][p] * pairs[p];
+        }
+    }
+    return result;
+}
+
+void MetricField::step(glm::vec3& position, glm::vec3& front, const glm::vec3& displacement) const {
+    Christoffel start, middle;
+    if (!sample(position, start)) {
+        position += displacement;
+        return;
+    }
+
+    // Midpoint rule for x'' = -Gamma(x', x') (the path) and F' = -Gamma(x', F) (the
+    // transported front): velocity and front at the half step come from the start's
+    // symbols, the full step uses them with the midpoint's
+    glm::vec3 halfFront = front - 0.5f * contract(start, displacement, front);
+    glm::vec3 halfDisplacement = displacement - 0.5f * contract(start, displacement, displacement);
+    sample(position + 0.5f * displacement, middle);
+
+    glm::vec3 newFront = front - contract(middle, halfDisplacement, halfFront);
+
+    position += halfDisplacement;
+    if (glm::dot(newFront, newFront) > 1e-12f) {
+        front = glm::normalize(newFront);
+    }
+}
+
+void MetricField::reportStats(int roomIndex) const {
+    const glm::ivec3& r = settings.resolution;
+    std::cout << "Metric field room " << roomIndex << ": ";
+    if (!started) {
+        std::cout << "not baked" << std::endl;
+        return;
+    }
+    std::cout << r.x << "x" << r.y << "x" << r.z << " Christoffel points ("
+        << symbols.size() * sizeof(float) / 1024 << " KB)";
+    if (isReady()) {
+        std::cout << ", baked in " << bakeMs << " ms on " << r.z << " jobs" << std::endl;
+    }
+    else {
+        std::cout << ", still baking" << std::endl;
+    }
+}
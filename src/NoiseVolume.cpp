@@ -0,0 +1,273 @@
+#include "noise_volume.h"
+#include "gl_state.h"
+#include "simd_ops.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+const int NoiseVolume::TEXTURE_UNIT;
+
+namespace {
+    // Same octave count, gain and inter-octave shift as fbm() in f_room_psychedelic.glsl
+    const int OCTAVES = 5;
+    const float OCTAVE_SHIFT = 100.0f;
+
+    const uint32_t CACHE_MAGIC = 0x4c4f564e;  // "NVOL"
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        int32_t size;
+        int32_t format;
+    };
+
+    const int32_t LANE_INDEX[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    // One row of lattice cells in an octave: the four (y, z) corners around the row and
+    // the weights to blend them
+    struct LatticeRow {
+        int cells;
+        int32_t base[4];  // Cell index of x = 0 at (y, z), (y + 1, z), (y, z + 1), (y + 1, z + 1)
+        float weightY;
+        float weightZ;
+        int32_t seed;
+    };
+
+    // Hash of a wrapped cell index to [0, 1)
+    template <typename Ops>
+    typename Ops::Vec latticeValue(typename Ops::VecI index, int32_t seed) {
+        typedef typename Ops::VecI VecI;
+        VecI h = Ops::xorI(Ops::mulI(index, Ops::set1I(0x27d4eb2d)), Ops::set1I(seed));
+        h = Ops::xorI(h, Ops::shiftRightI(h, 15));
+        h = Ops::mulI(h, Ops::set1I(0x2c1b3c6d));
+        h = Ops::xorI(h, Ops::shiftRightI(h, 12));
+        h = Ops::mulI(h, Ops::set1I(0x297a2d39));
+        h = Ops::xorI(h, Ops::shiftRightI(h, 15));
+        return Ops::mul(Ops::toFloat(Ops::shiftRightI(h, 8)), Ops::set1(1.0f / 16777216.0f));
+    }
+
+    // Lattice values of cells [begin, row.cells) already interpolated in y and z, so only
+    // the x interpolation is left per texel. Returns the first cell not written.
+    template <typename Ops>
+    int buildLatticeRow(const LatticeRow& row, int begin, float* out) {
+        typedef typename Ops::Vec Vec;
+        typedef typename Ops::VecI VecI;
+        const Vec weightY = Ops::set1(row.weightY);
+        const Vec weightZ = Ops::set1(row.weightZ);
+
+        int x = begin;
+        for (; x + Ops::LANES <= row.cells; x += Ops::LANES) {
+            VecI cell = Ops::addI(Ops::set1I(x), Ops::loadI(LANE_INDEX));
+            Vec v00 = latticeValue<Ops>(Ops::addI(cell, Ops::set1I(row.base[0])), row.seed);
+            Vec v10 = latticeValue<Ops>(Ops::addI(cell, Ops::set1I(row.base[1])), row.seed);
+            Vec v01 = latticeValue<Ops>(Ops::addI(cell, Ops::set1I(row.base[2])), row.seed);
+            Vec v11 = latticeValue<Ops>(Ops::addI(cell, Ops::set1I(row.base[3])), row.seed);
+
+            Vec near = Ops::add(v00, Ops::mul(Ops::sub(v10, v00), weightY));
+            Vec far = Ops::add(v01, Ops::mul(Ops::sub(v11, v01), weightY));
+            Ops::store(out + x, Ops::add(near, Ops::mul(Ops::sub(far, near), weightZ)));
+        }
+        return x;
+    }
+
+    bool isValidSize(int size) {
+        return size >= 16 && size <= 256 && (size & (size - 1)) == 0;
+    }
+}
+
+NoiseVolume::Settings NoiseVolume::defaultSettings() {
+    Settings settings;
+    settings.size = 128;
+    settings.format = FORMAT_R16F;
+    settings.cachePath = "noise_volume.cache";
+    return settings;
+}
+
+NoiseVolume::NoiseVolume() : texture(0), generationMs(0.0), loadedFromCache(false) {
+    settings = defaultSettings();
+}
+
+NoiseVolume::~NoiseVolume() {
+    glDeleteTextures(1, &texture);
+    glState().invalidate();
+}
+
+void NoiseVolume::generate(int size, JobSystem* jobs, std::vector<float>& out) {
+    out.assign((size_t)size * size * size, 0.0f);
+    float period = periodFor(size);
+
+    // Cell and smoothstep weight of every texel centre per octave; identical on all three axes
+    std::vector<int> cellOf(OCTAVES * size);
+    std::vector<float> weightOf(OCTAVES * size);
+    std::vector<int> cellCount(OCTAVES);
+    for (int octave = 0; octave < OCTAVES; octave++) {
+        float frequency = (float)(1 << octave);
+        float shift = OCTAVE_SHIFT * (frequency - 1.0f);
+        int cells = (int)period << octave;
+        cellCount[octave] = cells;
+
+        for (int i = 0; i < size; i++) {
+            float p = (i + 0.5f) * period / size * frequency + shift;
+            float whole = std::floor(p);
+            float f = p - whole;
+            cellOf[octave * size + i] = (int)whole % cells;
+            weightOf[octave * size + i] = f * f * (3.0f - 2.0f * f);
+        }
+    }
+
+    auto fillSlices = [&](int zBegin, int zEnd) {
+        // Lattice row plus a wrapped copy of its first cell
+        std::vector<float> lattice(size + 1);
+
+        for (int z = zBegin; z < zEnd; z++) {
+            for (int y = 0; y < size; y++) {
+                float* texels = &out[((size_t)z * size + y) * size];
+                float amplitude = 0.5f;
+
+                for (int octave = 0; octave < OCTAVES; octave++) {
+                    const int* cells = &cellOf[octave * size];
+                    const float* weights = &weightOf[octave * size];
+                    int count = cellCount[octave];
+
+                    int y0 = cells[y], y1 = (y0 + 1) % count;
+                    int z0 = cells[z], z1 = (z0 + 1) % count;
+                    LatticeRow row;
+                    row.cells = count;
+                    row.base[0] = count * (y0 + count * z0);
+                    row.base[1] = count * (y1 + count * z0);
+                    row.base[2] = count * (y0 + count * z1);
+                    row.base[3] = count * (y1 + count * z1);
+                    row.weightY = weights[y];
+                    row.weightZ = weights[z];
+                    row.seed = (int32_t)(0x9e3779b9u * (uint32_t)(octave + 1));
+
+                    int done = buildLatticeRow<SimdOps>(row, 0, lattice.data());
+                    buildLatticeRow<ScalarOps>(row, done, lattice.data());
+                    lattice[count] = lattice[0];
+
+                    for (int x = 0; x < size; x++) {
+                        float a = lattice[cells[x]];
+                        float b = lattice[cells[x] + 1];
+                        texels[x] += amplitude * (a + (b - a) * weights[x]);
+                    }
+                    amplitude *= 0.5f;
+                }
+            }
+        }
+    };
+
+    if (jobs) jobs->parallelFor(0, size, 1, fillSlices);
+    else fillSlices(0, size);
+}
+
+bool NoiseVolume::initialize(const Settings& requested, JobSystem* jobs) {
+    settings = requested;
+    if (!isValidSize(settings.size)) {
+        std::cerr << "Noise volume: size " << settings.size
+            << " is not a power of two from 16 to 256, using analytic noise" << std::endl;
+        return false;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t texelCount = (size_t)settings.size * settings.size * settings.size;
+    size_t texelSize = settings.format == FORMAT_R8 ? 1 : 2;
+    std::vector<unsigned char> texels;
+    loadedFromCache = loadCache(texels);
+
+    if (!loadedFromCache) {
+        std::vector<float> values;
+        generate(settings.size, jobs, values);
+
+        texels.resize(texelCount * texelSize);
+        for (size_t i = 0; i < texelCount; i++) {
+            if (settings.format == FORMAT_R8) {
+                texels[i] = (unsigned char)(glm::clamp(values[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+            else {
+                uint16_t half = glm::packHalf1x16(values[i]);
+                texels[i * 2] = (unsigned char)(half & 0xff);
+                texels[i * 2 + 1] = (unsigned char)(half >> 8);
+            }
+        }
+        saveCache(texels);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    generationMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    if (texture == 0) glGenTextures(1, &texture);
+    glState().bindTexture3D(TEXTURE_UNIT, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (settings.format == FORMAT_R8) {
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_R8, settings.size, settings.size, settings.size, 0,
+            GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    }
+    else {
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_R16F, settings.size, settings.size, settings.size, 0,
+            GL_RED, GL_HALF_FLOAT, texels.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // Tiles seamlessly; mipmaps keep distant surfaces from shimmering
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glGenerateMipmap(GL_TEXTURE_3D);
+
+    std::cout << "Noise volume: " << settings.size << "^3 " << (settings.format == FORMAT_R8 ? "R8" : "R16F")
+        << (loadedFromCache ? " loaded from " + settings.cachePath : std::string(" generated"))
+        << " in " << generationMs << " ms" << std::endl;
+    return true;
+}
+
+void NoiseVolume::apply(const Shader& shader, bool enabled) const {
+    bool available = texture != 0;
+    if (available) glState().bindTexture3D(TEXTURE_UNIT, texture);
+
+    shader.setInt("noiseVolume", TEXTURE_UNIT);
+    shader.setFloat("noiseVolumePeriod", periodFor(settings.size));
+    shader.setBool("useNoiseVolume", enabled && available);
+}
+
+bool NoiseVolume::loadCache(std::vector<unsigned char>& texels) const {
+    if (settings.cachePath.empty()) return false;
+
+    std::ifstream file(settings.cachePath, std::ios::binary);
+    if (!file) return false;
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+        header.size != settings.size || header.format != (int32_t)settings.format) {
+        return false;
+    }
+
+    size_t bytes = (size_t)settings.size * settings.size * settings.size * (settings.format == FORMAT_R8 ? 1 : 2);
+    texels.resize(bytes);
+    if (!file.read(reinterpret_cast<char*>(texels.data()), bytes)) {
+        std::cerr << "Noise volume: cache " << settings.cachePath << " is truncated, regenerating" << std::endl;
+        texels.clear();
+        return false;
+    }
+    return true;
+}
+
+void NoiseVolume::saveCache(const std::vector<unsigned char>& texels) const {
+    if (settings.cachePath.empty()) return;
+
+    std::ofstream file(settings.cachePath, std::ios::binary | std::ios::trunc);
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, settings.size, (int32_t)settings.format };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(texels.data()), texels.size());
+    if (!file) {
+        std::cerr << "Noise volume: could not write cache " << settings.cachePath << std::endl;
+    }
+}
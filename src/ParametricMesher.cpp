@@ -0,0 +1,131 @@
+#include "parametric_mesher.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Parameter step for the normals' central differences
+    const float NORMAL_STEP = 1e-3f;
+
+    std::vector<float> uniformBreakpoints(int segments) {
+        std::vector<float> breakpoints(segments + 1);
+        for (int i = 0; i <= segments; i++) breakpoints[i] = (float)i / segments;
+        return breakpoints;
+    }
+
+    // Lines to judge the other direction along: every breakpoint and the middle of every interval
+    std::vector<float> sampleLines(const std::vector<float>& breakpoints) {
+        std::vector<float> lines;
+        lines.reserve(breakpoints.size() * 2);
+        for (size_t i = 0; i < breakpoints.size(); i++) {
+            lines.push_back(breakpoints[i]);
+            if (i + 1 < breakpoints.size()) lines.push_back(0.5f * (breakpoints[i] + breakpoints[i + 1]));
+        }
+        return lines;
+    }
+}
+
+ParametricMesher::Settings ParametricMesher::defaultSettings() {
+    Settings settings;
+    settings.minSegmentsU = 8;
+    settings.minSegmentsV = 4;
+    settings.maxSegmentsU = 256;
+    settings.maxSegmentsV = 128;
+    settings.maxAngle = 0.15f;
+    settings.maxScreenError = 0.5f;
+    settings.viewPoint = glm::vec3(0.0f);
+    settings.focalPixels = 870.0f;  // 720 pixels high at 45 degrees
+    settings.time = 0.0f;
+    return settings;
+}
+
+void ParametricMesher::refine(const Surface& surface, const Settings& settings, bool alongU,
+    const std::vector<float>& across, int maxSegments, std::vector<float>& breakpoints) {
+    auto at = [&](float along, float other) {
+        return alongU ? surface(along, other, settings.time) : surface(other, along, settings.time);
+    };
+    std::vector<float> lines = sampleLines(across);
+    float cosMaxAngle = std::cos(settings.maxAngle);
+
+    auto needsSplit = [&](float a, float b) {
+        float middle = 0.5f * (a + b);
+        for (float other : lines) {
+            glm::vec3 p0 = at(a, other);
+            glm::vec3 pm = at(middle, other);
+            glm::vec3 p1 = at(b, other);
+
+            // Screen error: the midpoint's distance from the chord, in pixels
+            float deviation = glm::length(pm - 0.5f * (p0 + p1));
+            float distance = std::max(glm::length(pm - settings.viewPoint), 1e-3f);
+            if (deviation * settings.focalPixels / distance > settings.maxScreenError) return true;
+
+            // Curvature: the turn between the two halves of the segment
+            glm::vec3 first = pm - p0;
+            glm::vec3 second = p1 - pm;
+            float lengths = glm::length(first) * glm::length(second);
+            if (lengths > 1e-12f && glm::dot(first, second) < cosMaxAngle * lengths) return true;
+        }
+        return false;
+    };
+
+    // Halve every interval that fails, a level at a time so the budget is spent evenly
+    std::vector<float> next;
+    while ((int)breakpoints.size() - 1 < maxSegments) {
+        int segments = (int)breakpoints.size() - 1;
+        bool split = false;
+
+        next.clear();
+        next.push_back(breakpoints[0]);
+        for (size_t i = 0; i + 1 < breakpoints.size(); i++) {
+            float a = breakpoints[i], b = breakpoints[i + 1];
+            if (segments < maxSegments && needsSplit(a, b)) {
+                next.push_back(0.5f * (a + b));
+                segments++;
+                split = true;
+            }
+            next.push_back(b);
+        }
+        breakpoints.swap(next);
+        if (!split) break;
+    }
+}
+
+void ParametricMesher::tessellate(const Surface& surface, const Settings& settings,
+    std::vector<float>& vertices, std::vector<uint16_t>& indices) {
+    std::vector<float> us = uniformBreakpoints(std::max(settings.minSegmentsU, 1));
+    std::vector<float> vs = uniformBreakpoints(std::max(settings.minSegmentsV, 1));
+
+    // u again after v, since v's refinement adds lines the first pass did not look at
+    refine(surface, settings, true, vs, settings.maxSegmentsU, us);
+    refine(surface, settings, false, us, settings.maxSegmentsV, vs);
+    refine(surface, settings, true, vs, settings.maxSegmentsU, us);
+
+    size_t columns = us.size();
+    vertices.clear();
+    vertices.reserve(columns * vs.size() * 8);
+    for (float v : vs) {
+        for (float u : us) {
+            glm::vec3 position = surface(u, v, settings.time);
+            glm::vec3 dU = surface(u + NORMAL_STEP, v, settings.time) - surface(u - NORMAL_STEP, v, settings.time);
+            glm::vec3 dV = surface(u, v + NORMAL_STEP, settings.time) - surface(u, v - NORMAL_STEP, settings.time);
+            glm::vec3 normal = glm::cross(dU, dV);
+            float length = glm::length(normal);
+            normal = length > 1e-12f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+
+            float vertex[8] = { position.x, position.y, position.z, normal.x, normal.y, normal.z, u, v };
+            vertices.insert(vertices.end(), vertex, vertex + 8);
+        }
+    }
+
+    indices.clear();
+    indices.reserve((columns - 1) * (vs.size() - 1) * 6);
+    for (size_t j = 0; j + 1 < vs.size(); j++) {
+        for (size_t i = 0; i + 1 < columns; i++) {
+            uint16_t a = (uint16_t)(j * columns + i);
+            uint16_t b = (uint16_t)(a + 1);
+            uint16_t c = (uint16_t)(a + columns);
+            uint16_t d = (uint16_t)(c + 1);
+            uint16_t quad[6] = { a, b, d, a, d, c };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+}
@@ -0,0 +1,180 @@
+#include "particle_system.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <iostream>
+
+const int ParticleSystem::MAX_EMITTERS;
+const int ParticleSystem::VEC4_PER_EMITTER;
+
+namespace {
+    // Per particle: position and age, then velocity and seed (v_particle_update.glsl)
+    const GLsizei PARTICLE_STRIDE = 2 * sizeof(glm::vec4);
+
+    // Frames further apart than this (a stall, a long load) advance by this much
+    const float MAX_STEP = 0.1f;
+}
+
+ParticleEmitter ParticleEmitter::stream(const glm::vec3& from, const glm::vec3& to, int capacity) {
+    ParticleEmitter emitter;
+    emitter.type = STREAM;
+    emitter.capacity = capacity;
+    emitter.active = capacity;
+    emitter.lifetime = 2.0f;
+    emitter.size = 0.2f;
+    emitter.spread = 0.5f;
+    emitter.stiffness = 40.0f;
+    emitter.origin = from;
+    emitter.target = to;
+    emitter.radius = 0.0f;
+    emitter.sway = 0.0f;
+    emitter.turns = 0.0f;
+    emitter.angularSpeed = 0.0f;
+    emitter.height = 0.0f;
+    emitter.heightFrequency = glm::vec3(0.0f);
+    return emitter;
+}
+
+ParticleEmitter ParticleEmitter::orbit(const glm::vec3& center, const glm::vec3& normal, float radius, int capacity) {
+    ParticleEmitter emitter = stream(center, normal, capacity);
+    emitter.type = ORBIT;
+    emitter.lifetime = 4.0f;
+    emitter.radius = radius;
+    emitter.turns = 1.0f;
+    return emitter;
+}
+
+ParticleSystem::Settings ParticleSystem::defaultSettings() {
+    Settings settings;
+    settings.capacity = 131072;
+    return settings;
+}
+
+ParticleSystem::ParticleSystem() : current(0), updateEmittersLocation(-1), renderEmittersLocation(-1), usedSlots(0),
+    activeParticles(0), lastTime(0.0f), started(false) {
+    settings = defaultSettings();
+    cube.firstIndex = cube.indexCount = cube.baseVertex = cube.vertexCount = 0;
+    stateBuffers[0] = stateBuffers[1] = 0;
+    updateVAOs[0] = updateVAOs[1] = 0;
+    renderVAOs[0] = renderVAOs[1] = 0;
+}
+
+ParticleSystem::~ParticleSystem() {
+    glDeleteVertexArrays(2, updateVAOs);
+    glDeleteVertexArrays(2, renderVAOs);
+    glDeleteBuffers(2, stateBuffers);
+    glState().invalidate();
+}
+
+void ParticleSystem::initialize(const Settings& newSettings, const MeshLibrary& meshes, const MeshLibrary::Mesh& cubeMesh,
+    const Shader& updateShader, const Shader& renderShader) {
+    settings = newSettings;
+    cube = cubeMesh;
+    updateEmittersLocation = glGetUniformLocation(updateShader.ID, "emitters");
+    renderEmittersLocation = glGetUniformLocation(renderShader.ID, "emitters");
+
+    // Zero seeds mark particles the update has never seen; it gives them a seed and a birth time
+    std::vector<glm::vec4> zeros((size_t)settings.capacity * 2, glm::vec4(0.0f));
+    glGenBuffers(2, stateBuffers);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_ARRAY_BUFFER, stateBuffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, zeros.size() * sizeof(glm::vec4), zeros.data(), GL_DYNAMIC_COPY);
+    }
+
+    glGenVertexArrays(2, updateVAOs);
+    glGenVertexArrays(2, renderVAOs);
+    for (int i = 0; i < 2; i++) {
+        glState().bindVertexArray(updateVAOs[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, stateBuffers[i]);
+        for (int attribute = 0; attribute < 2; attribute++) {
+            glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, PARTICLE_STRIDE,
+                (void*)(attribute * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(attribute);
+        }
+
+        glState().bindVertexArray(renderVAOs[i]);
+        meshes.bindLayout();
+        glBindBuffer(GL_ARRAY_BUFFER, stateBuffers[i]);
+        for (int attribute = 0; attribute < 2; attribute++) {
+            glVertexAttribPointer(3 + attribute, 4, GL_FLOAT, GL_FALSE, PARTICLE_STRIDE,
+                (void*)(attribute * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(3 + attribute);
+            glVertexAttribDivisor(3 + attribute, 1);
+        }
+    }
+
+    glState().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    emitterTable.assign(MAX_EMITTERS * VEC4_PER_EMITTER, glm::vec4(0.0f));
+}
+
+void ParticleSystem::update(const Shader& updateShader, const Shader& renderShader,
+    const std::vector<ParticleEmitter>& emitters, float time) {
+    float deltaTime = started ? glm::clamp(time - lastTime, 0.0f, MAX_STEP) : 0.0f;
+    lastTime = time;
+    started = true;
+
+    // Emitters take consecutive slot ranges in order, as far as the capacity goes
+    int count = std::min((int)emitters.size(), MAX_EMITTERS);
+    std::vector<int> newLayout;
+    usedSlots = 0;
+    activeParticles = 0;
+    for (int e = 0; e < count; e++) {
+        const ParticleEmitter& emitter = emitters[e];
+        int capacity = std::max(0, std::min(emitter.capacity, settings.capacity - usedSlots));
+        int active = std::max(0, std::min(emitter.active, capacity));
+        newLayout.push_back(capacity);
+
+        glm::vec4* row = &emitterTable[e * VEC4_PER_EMITTER];
+        row[0] = glm::vec4(emitter.origin, (float)emitter.type);
+        row[1] = glm::vec4(emitter.target, emitter.lifetime);
+        row[2] = glm::vec4((float)usedSlots, (float)capacity, (float)active, emitter.size);
+        row[3] = glm::vec4(emitter.spread, emitter.stiffness, emitter.radius, emitter.sway);
+        row[4] = glm::vec4(emitter.turns, emitter.angularSpeed, emitter.height, 0.0f);
+        row[5] = glm::vec4(emitter.heightFrequency, 0.0f);
+
+        usedSlots += capacity;
+        activeParticles += active;
+    }
+
+    // A slot that now belongs to another emitter must not carry its old particle over
+    bool reset = newLayout != layout;
+    layout = newLayout;
+    if (usedSlots == 0) return;
+
+    GLsizei tableSize = count * VEC4_PER_EMITTER;
+    renderShader.use();
+    glUniform4fv(renderEmittersLocation, tableSize, &emitterTable[0][0]);
+    renderShader.setInt("emitterCount", count);
+
+    updateShader.use();
+    glUniform4fv(updateEmittersLocation, tableSize, &emitterTable[0][0]);
+    updateShader.setInt("emitterCount", count);
+    updateShader.setFloat("time", time);
+    updateShader.setFloat("deltaTime", deltaTime);
+    updateShader.setBool("resetParticles", reset);
+
+    // Read the current state as points, capture the next one into the other buffer
+    int next = 1 - current;
+    glEnable(GL_RASTERIZER_DISCARD);
+    glState().bindVertexArray(updateVAOs[current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, stateBuffers[next]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, usedSlots);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    current = next;
+}
+
+void ParticleSystem::record(const Shader& renderShader, CommandList& out) const {
+    if (usedSlots == 0) return;
+
+    // Slots that are not alive collapse to a point in the vertex shader
+    out.drawIndexed(renderShader, renderVAOs[current], GL_TRIANGLES, cube.firstIndex, cube.indexCount,
+        cube.baseVertex, usedSlots);
+}
+
+void ParticleSystem::reportStats() const {
+    std::cout << "Particles: " << activeParticles << " active in " << usedSlots << " of " << settings.capacity
+        << " slots (" << layout.size() << " emitters), 1 transform feedback pass and 1 instanced draw" << std::endl;
+}
@@ -0,0 +1,137 @@
+#include "portal_geometry.h"
+#include <glm/glm.hpp>
+
+namespace {
+    void addVertex(std::vector<float>& out, const glm::vec3& position, const glm::vec3& normal, float u, float v) {
+        const float vertex[8] = { position.x, position.y, position.z, normal.x, normal.y, normal.z, u, v };
+        out.insert(out.end(), vertex, vertex + 8);
+    }
+
+    // Two triangles (p1, p2, p3) and (p1, p3, p4)
+    void addQuad(std::vector<float>& out, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3,
+        const glm::vec3& p4, const glm::vec3& normal) {
+        addVertex(out, p1, normal, 0.0f, 0.0f);
+        addVertex(out, p2, normal, 1.0f, 0.0f);
+        addVertex(out, p3, normal, 1.0f, 1.0f);
+        addVertex(out, p1, normal, 0.0f, 0.0f);
+        addVertex(out, p3, normal, 1.0f, 1.0f);
+        addVertex(out, p4, normal, 0.0f, 1.0f);
+    }
+
+    // Box of the given size, its front face flush with the portal plane
+    void addBox(std::vector<float>& out, glm::vec3 center, float width, float height, float depth) {
+        glm::vec3 h(width / 2.0f, height / 2.0f, depth / 2.0f);
+        center.z -= depth / 2.0f;
+
+        glm::vec3 c = center;
+        // Front and back
+        addQuad(out, c + glm::vec3(-h.x, -h.y, h.z), c + glm::vec3(h.x, -h.y, h.z),
+            c + glm::vec3(h.x, h.y, h.z), c + glm::vec3(-h.x, h.y, h.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        addQuad(out, c + glm::vec3(h.x, -h.y, -h.z), c + glm::vec3(-h.x, -h.y, -h.z),
+            c + glm::vec3(-h.x, h.y, -h.z), c + glm::vec3(h.x, h.y, -h.z), glm::vec3(0.0f, 0.0f, -1.0f));
+        // Top and bottom
+        addQuad(out, c + glm::vec3(-h.x, h.y, h.z), c + glm::vec3(h.x, h.y, h.z),
+            c + glm::vec3(h.x, h.y, -h.z), c + glm::vec3(-h.x, h.y, -h.z), glm::vec3(0.0f, 1.0f, 0.0f));
+        addQuad(out, c + glm::vec3(-h.x, -h.y, -h.z), c + glm::vec3(h.x, -h.y, -h.z),
+            c + glm::vec3(h.x, -h.y, h.z), c + glm::vec3(-h.x, -h.y, h.z), glm::vec3(0.0f, -1.0f, 0.0f));
+        // Left and right
+        addQuad(out, c + glm::vec3(-h.x, -h.y, -h.z), c + glm::vec3(-h.x, -h.y, h.z),
+            c + glm::vec3(-h.x, h.y, h.z), c + glm::vec3(-h.x, h.y, -h.z), glm::vec3(-1.0f, 0.0f, 0.0f));
+        addQuad(out, c + glm::vec3(h.x, -h.y, h.z), c + glm::vec3(h.x, -h.y, -h.z),
+            c + glm::vec3(h.x, h.y, -h.z), c + glm::vec3(h.x, h.y, h.z), glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+
+    // Bar from start to end along X (horizontal) or Y (vertical)
+    void addSegment(std::vector<float>& out, const glm::vec3& start, const glm::vec3& end,
+        float thickness, float depth, bool vertical) {
+        float length = glm::length(end - start);
+        glm::vec3 center = (start + end) / 2.0f;
+        if (vertical) addBox(out, center, thickness, length, depth);
+        else addBox(out, center, length, thickness, depth);
+    }
+
+    // Small ornamental piece at a corner
+    void addCorner(std::vector<float>& out, const glm::vec3& position, const glm::vec3& upPosition,
+        float size, float depth) {
+        addBox(out, (position + upPosition) / 2.0f, size, size, depth * 1.5f);
+    }
+
+    void buildSurface(float width, float height, std::vector<float>& out) {
+        glm::vec3 normal(0.0f, 0.0f, 1.0f);
+        glm::vec3 topLeft(-width / 2.0f, height / 2.0f, 0.0f);
+        glm::vec3 topRight(width / 2.0f, height / 2.0f, 0.0f);
+        glm::vec3 bottomLeft(-width / 2.0f, -height / 2.0f, 0.0f);
+        glm::vec3 bottomRight(width / 2.0f, -height / 2.0f, 0.0f);
+
+        addVertex(out, topLeft, normal, 0.0f, 1.0f);
+        addVertex(out, bottomLeft, normal, 0.0f, 0.0f);
+        addVertex(out, topRight, normal, 1.0f, 1.0f);
+        addVertex(out, bottomLeft, normal, 0.0f, 0.0f);
+        addVertex(out, bottomRight, normal, 1.0f, 0.0f);
+        addVertex(out, topRight, normal, 1.0f, 1.0f);
+    }
+
+    // Thin gate-like frame with decorative corners
+    void buildFrame(float width, float height, std::vector<float>& out) {
+        float thickness = 0.05f * width;
+        float depth = 0.1f;
+
+        glm::vec3 halfWidth(width / 2.0f, 0.0f, 0.0f);
+        glm::vec3 fullHeight(0.0f, height, 0.0f);
+        glm::vec3 ornament(0.0f, thickness * 3.0f, 0.0f);
+
+        // 4 bars + 4 corners, 6 faces of 6 vertices each
+        out.reserve(8 * 36 * 8);
+
+        addSegment(out, -halfWidth, -halfWidth + fullHeight, thickness, depth, true);               // Left vertical
+        addSegment(out, halfWidth, halfWidth + fullHeight, thickness, depth, true);                 // Right vertical
+        addSegment(out, -halfWidth, halfWidth, thickness, depth, false);                            // Bottom horizontal
+        addSegment(out, -halfWidth + fullHeight, halfWidth + fullHeight, thickness, depth, false);  // Top horizontal
+
+        addCorner(out, -halfWidth, -halfWidth + ornament, thickness * 1.5f, depth);                          // Bottom left
+        addCorner(out, halfWidth, halfWidth + ornament, thickness * 1.5f, depth);                            // Bottom right
+        addCorner(out, -halfWidth + fullHeight, -halfWidth + fullHeight + ornament, thickness * 1.5f, depth); // Top left
+        addCorner(out, halfWidth + fullHeight, halfWidth + fullHeight + ornament, thickness * 1.5f, depth);   // Top right
+    }
+}
+
+PortalGeometry::PortalGeometry(MeshLibrary& library) : meshes(library) {}
+
+PortalGeometry::~PortalGeometry() {
+    for (auto& entry : entries) {
+        meshes.remove(entry.second.shapes.surface);
+        meshes.remove(entry.second.shapes.frame);
+    }
+}
+
+PortalGeometry::Shapes PortalGeometry::acquire(float width, float height) {
+    std::pair<float, float> key(width, height);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        it->second.users++;
+        return it->second.shapes;
+    }
+
+    Entry entry;
+    entry.users = 1;
+
+    std::vector<float> vertices;
+    buildSurface(width, height, vertices);
+    entry.shapes.surface = meshes.add(vertices);
+
+    vertices.clear();
+    buildFrame(width, height, vertices);
+    entry.shapes.frame = meshes.add(vertices);
+
+    entries[key] = entry;
+    return entry.shapes;
+}
+
+void PortalGeometry::release(float width, float height) {
+    auto it = entries.find(std::make_pair(width, height));
+    if (it == entries.end() || --it->second.users > 0) return;
+
+    meshes.remove(it->second.shapes.surface);
+    meshes.remove(it->second.shapes.frame);
+    entries.erase(it);
+}
@@ -0,0 +1,39 @@
+#include "render_queue.h"
+#include <cstring>
+
+uint64_t RenderQueue::makeKey(Pass pass, unsigned int program, unsigned int material, float depth) {
+    // Non-negative floats order the same as their bit patterns
+    if (!(depth > 0.0f)) depth = 0.0f;
+    uint32_t depthBits;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+    return ((uint64_t)(pass & 0x3) << 62) |
+        ((uint64_t)(program & 0x3FFF) << 48) |
+        ((uint64_t)(material & 0xFFFF) << 32) |
+        depthBits;
+}
+
+void RenderQueue::sort() {
+    if (items.size() < 2) return;
+    scratch.resize(items.size());
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (const Item& item : items) {
+            counts[(item.key >> shift) & 0xFF]++;
+        }
+        // One bucket holding everything: this digit doesn't change the order
+        if (counts[(items[0].key >> shift) & 0xFF] == items.size()) continue;
+
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            size_t count = counts[digit];
+            counts[digit] = offset;
+            offset += count;
+        }
+        for (const Item& item : items) {
+            scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
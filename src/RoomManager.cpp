@@ -1,7 +1,12 @@
 #include "Room.h"
+#include "transform_batch.h"
+#include "anim_math.h"
+#include "parametric_mesher.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-RoomManager::RoomManager() : currentRoom(0) {
+RoomManager::RoomManager() : currentRoom(0), jobSystem(nullptr), kleinSurface(), mobiusSurface() {
     // Constructor initializes with room 0 (dev space)
 }
 
@@ -150,6 +155,14 @@ void RoomManager::teleportToRoom(int roomIndex, Camera& camera, float& nonEuclid
     }
 }
 
+void RoomManager::setJobSystem(JobSystem* jobs) {
+    jobSystem = jobs;
+}
+
+JobSystem* RoomManager::getJobSystem() const {
+    return jobSystem;
+}
+
 int RoomManager::getCurrentRoomIndex() const {
     return currentRoom;
 }
@@ -162,136 +175,178 @@ size_t RoomManager::getRoomCount() const {
     return rooms.size();
 }
 
-void RoomManager::renderFloatingFractals(Shader& shader, unsigned int cubeVAO,
-    const Room& room, float time) {
-    const int numObjects = 30;
-
-    for (int i = 0; i < numObjects; i++) {
-        float t = float(i) / numObjects;
-        float angle = t * 20.0f * 3.14159f + time * 0.1f;
-        float height = sin(angle * 0.5f) * 10.0f;
-        float radius = 10.0f + 5.0f * cos(angle * 0.7f);
+void RoomManager::generateRoomContent(int roomIndex, float time, InstanceBatch& out) {
+    const Room& room = rooms[roomIndex];
 
-        glm::vec3 position = room.spawnPosition + glm::vec3(
-            cos(angle) * radius,
-            height,
-            sin(angle) * radius
-        );
+    // Call the specific generator for the current room
+    switch (roomIndex) {
+    case 1: generateMandelbulbFractalSpace(room, time, out); break;
+    case 2: break; // Static only
+    case 3: generateHyperbolicSpace(room, time, out); break;
+    case 4: generateKleinBottleSpace(room, time, out); break;
+    case 5: generateRecursiveScalingEnvironment(room, time, out); break;
+    case 6: generateQuantumSuperpositionSpace(room, time, out); break;
+    case 7: generateMobiusTopology(room, time, out); break;
+    case 8: generateNonCommutativeRotationSpace(room, time, out); break;
+    case 9: generateInfiniteRegressionChamber(room, time, out); break;
+    }
+}
 
-        // Create a twisted, morphing shape
-        float scale = 0.5f + 0.3f * sin(time * 0.5f + t * 10.0f);
+void RoomManager::generateStaticContent(int roomIndex, StaticRoomContent& out) {
+    const Room& room = rooms[roomIndex];
+    out.clear();
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, position);
-        model = glm::rotate(model, time * 0.5f + i,
-            glm::normalize(glm::vec3(sin(t * 5.0f), cos(t * 7.0f), sin(t * 3.0f))));
-        model = glm::scale(model, glm::vec3(scale));
-
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+    switch (roomIndex) {
+    case 2: generateEscherImpossibleArchitecture(room, out.fixed); break;
     }
 }
 
-void RoomManager::renderRoomSpecificContent(int roomIndex, Shader& shader,
-    unsigned int cubeVAO, float time) {
-    // Set room-specific shader parameters
-    setupRoomShader(shader, roomIndex, time);
+void RoomManager::recordRoomSpecificContent(const Shader& shader, const InstanceStream& stream, int region,
+    const InstanceBatch& content, CommandList& out) {
+    // Room shader parameters are set by setupRoomShader before the frame is replayed;
+    // the room's static instances come from the static buffer, the instances generated
+    // for this frame straight from the stream region
+    stream.recordStatic(shader, out);
+    stream.record(region, content, shader, out);
+}
+
+void RoomManager::recordFractalHierarchy(int roomIndex, const Shader& shader, const FractalHierarchy& fractal,
+    const ViewParams& view, CommandList& out) {
+    if (roomIndex != 1) return;
 
-    const Room& room = rooms[roomIndex];
+    // Nodes under 2 pixels at 1080p are not drawn
+    fractal.record(shader, rooms[roomIndex].spawnPosition, 15.0f, view, 2.0f / 1080.0f, out);
+}
 
-    // Call the specific rendering function for the current room
-    switch (roomIndex) {
-    case 1: renderMandelbulbFractalSpace(shader, cubeVAO, room, time); break;
-    case 2: renderEscherImpossibleArchitecture(shader, cubeVAO, room, time); break;
-    case 3: renderHyperbolicSpace(shader, cubeVAO, room, time); break;
-    case 4: renderKleinBottleSpace(shader, cubeVAO, room, time); break;
-    case 5: renderRecursiveScalingEnvironment(shader, cubeVAO, room, time); break;
-    case 6: renderQuantumSuperpositionSpace(shader, cubeVAO, room, time); break;
-    case 7: renderMobiusTopology(shader, cubeVAO, room, time); break;
-    case 8: renderNonCommutativeRotationSpace(shader, cubeVAO, room, time); break;
-    case 9: renderInfiniteRegressionChamber(shader, cubeVAO, room, time); break;
+namespace {
+    // The continuous surfaces of the Klein bottle and Mbius rooms, around the origin. Their
+    // time terms must match surfaceOffset in v_parametric_surface.glsl
+
+    // Figure-8 immersion of the Klein bottle, closed in both directions
+    glm::vec3 kleinBottle(float u, float v, float t) {
+        float a = u * 2.0f * 3.14159f;
+        float b = v * 2.0f * 3.14159f;
+        float tube = cos(a * 0.5f) * sin(b) - sin(a * 0.5f) * sin(2.0f * b);
+        float ring = 15.0f + 3.0f * tube;
+        float height = 3.0f * (sin(a * 0.5f) * sin(b) + cos(a * 0.5f) * sin(2.0f * b));
+
+        // The neck sways around the ring while the whole bottle bobs
+        float neck = 0.5f - 0.5f * cos(a);
+        glm::vec3 motion(neck * 5.0f * sin(t * 0.2f), sin(a * 3.0f + t * 0.5f), -neck * 5.0f * cos(t * 0.2f));
+
+        return glm::vec3(ring * cos(a), height, ring * sin(a)) + motion;
+    }
+
+    // Mbius strip with a half twist and a wave running around it
+    glm::vec3 mobiusStrip(float u, float v, float t) {
+        const float mobiusRadius = 20.0f;
+        const float stripWidth = 4.0f;
+        float angle = u * 2.0f * 3.14159f;
+        float s = (v - 0.5f) * stripWidth;
+        float twistAngle = angle * 0.5f;
+
+        return glm::vec3(
+            (mobiusRadius + s * cos(twistAngle)) * cos(angle),
+            s * sin(twistAngle) + sin(t * 0.2f + angle),
+            (mobiusRadius + s * cos(twistAngle)) * sin(angle)
+        );
     }
 }
 
+void RoomManager::buildSurfaces(MeshLibrary& meshes, float focalPixels) {
+    // Screen error is judged from the spawn point, the surfaces' origin
+    ParametricMesher::Settings settings = ParametricMesher::defaultSettings();
+    settings.focalPixels = focalPixels;
+
+    std::vector<float> vertices;
+    std::vector<uint16_t> indices;
+    ParametricMesher::tessellate(kleinBottle, settings, vertices, indices);
+    kleinSurface = meshes.add(vertices, indices);
+    ParametricMesher::tessellate(mobiusStrip, settings, vertices, indices);
+    mobiusSurface = meshes.add(vertices, indices);
+
+    std::cout << "Parametric surfaces: Klein bottle " << kleinSurface.vertexCount << " vertices, "
+        << kleinSurface.indexCount / 3 << " triangles; Mobius strip " << mobiusSurface.vertexCount
+        << " vertices, " << mobiusSurface.indexCount / 3 << " triangles" << std::endl;
+}
+
+void RoomManager::recordParametricSurface(int roomIndex, const Shader& shader, const MeshLibrary& meshes,
+    CommandList& out) {
+    const MeshLibrary::Mesh* surface = nullptr;
+    int motion = 0;
+    if (roomIndex == 4) {
+        surface = &kleinSurface;
+        motion = 1;
+    }
+    else if (roomIndex == 7) {
+        surface = &mobiusSurface;
+        motion = 2;
+    }
+    if (surface == nullptr || surface->indexCount == 0) return;
+
+    glm::vec3 center = rooms[roomIndex].spawnPosition;
+    out.setInt(shader, "surfaceMotion", motion);
+    out.setMat4(shader, "model", glm::translate(glm::mat4(1.0f), center));
+    out.setDepthCenter(center);
+    out.drawIndexed(shader, meshes.getVAO(), GL_TRIANGLES, surface->firstIndex, surface->indexCount,
+        surface->baseVertex);
+}
+
 // 1. Mandelbulb Fractal Space
-void RoomManager::renderMandelbulbFractalSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
-    // Create a recursive fractal structure
-    renderFractalStructure(shader, cubeVAO, room.spawnPosition, 15.0f, 3, time);
+void RoomManager::generateMandelbulbFractalSpace(const Room& room, float time, InstanceBatch& out) {
+    // The recursive fractal structure itself is drawn by recordFractalHierarchy
 
     // Create floating orbital structures
     const int orbitCount = 5;
     const float orbitRadius = 25.0f;
 
-    for (int orbit = 0; orbit < orbitCount; orbit++) {
+    parallelGenerate(jobSystem, orbitCount, 1, out, [&](int orbit, InstanceBatch& local) {
         float orbitHeight = -10.0f + orbit * 8.0f;
         float orbitPhase = orbit * 0.5f + time * 0.2f;
         int cubesInOrbit = 10 + orbit * 5;
 
+        // Plain translate-rotate-scale cubes: collect them and build the matrices in one batch
+        TransformSoA transforms;
+        transforms.reserve(cubesInOrbit);
+
+        // Every term is linear in i, so step the phases instead of calling sin/cos
+        PhaseSeries angle(orbitPhase, 2.0f * 3.14159f / cubesInOrbit);
+        PhaseSeries pulse(time * 0.5f, 0.2f);
+        PhaseSeries tilt(0.0f, 0.1f);
+
         for (int i = 0; i < cubesInOrbit; i++) {
-            float angle = i * (2.0f * 3.14159f / cubesInOrbit) + orbitPhase;
-            float x = cos(angle) * orbitRadius;
-            float z = sin(angle) * orbitRadius;
+            float x = angle.cos() * orbitRadius;
+            float z = angle.sin() * orbitRadius;
 
             glm::vec3 position = room.spawnPosition + glm::vec3(x, orbitHeight, z);
-            float scale = 0.5f + 0.3f * sin(time * 0.5f + i * 0.2f);
+            float scale = 0.5f + 0.3f * pulse.sin();
 
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, position);
-            model = glm::rotate(model, time * 0.5f + i * 0.1f,
-                glm::vec3(sin(i * 0.1f), 1.0f, cos(i * 0.1f)));
-            model = glm::scale(model, glm::vec3(scale));
+            transforms.push(position, time * 0.5f + i * 0.1f,
+                glm::vec3(tilt.sin(), 1.0f, tilt.cos()), glm::vec3(scale));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            angle.advance();
+            pulse.advance();
+            tilt.advance();
         }
-    }
+
+        appendTransforms(transforms, local.solid);
+    });
 
     // Create special portal-like structures
-    for (int i = 0; i < 4; i++) {
+    parallelGenerate(jobSystem, 4, 1, out, [&](int i, InstanceBatch& local) {
         float angle = i * (2.0f * 3.14159f / 4.0f);
         float distance = 20.0f;
         glm::vec3 portalPos = room.spawnPosition + glm::vec3(cos(angle) * distance, 0.0f, sin(angle) * distance);
 
         // Create frame
-        renderPortalFrame(shader, cubeVAO, portalPos, angle + 3.14159f * 0.5f, 5.0f, 8.0f, time);
-    }
-}
-
-// Helper for creating fractal structures
-void RoomManager::renderFractalStructure(Shader& shader, unsigned int cubeVAO,
-    glm::vec3 center, float size, int depth, float time) {
-    if (depth <= 0) return;
-
-    // Center cube
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, center);
-    model = glm::rotate(model, time * (4 - depth) * 0.1f,
-        glm::vec3(sin(time * 0.3f), cos(time * 0.2f), sin(time * 0.1f)));
-    model = glm::scale(model, glm::vec3(size));
-
-    shader.setMat4("model", model);
-    glBindVertexArray(cubeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-
-    if (depth > 1) {
-        float newSize = size * 0.3f;
-        float offset = size * 0.7f;
-
-        for (int i = 0; i < 8; i++) {
-            float xDir = (i & 1) ? 1.0f : -1.0f;
-            float yDir = (i & 2) ? 1.0f : -1.0f;
-            float zDir = (i & 4) ? 1.0f : -1.0f;
-
-            glm::vec3 newCenter = center + glm::vec3(xDir * offset, yDir * offset, zDir * offset);
-            renderFractalStructure(shader, cubeVAO, newCenter, newSize, depth - 1, time);
-        }
-    }
+        generatePortalFrame(portalPos, angle + 3.14159f * 0.5f, 5.0f, 8.0f, time, local);
+    });
 }
 
 // 2. Escher's Impossible Architecture
-void RoomManager::renderEscherImpossibleArchitecture(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
+void RoomManager::generateEscherImpossibleArchitecture(const Room& room, InstanceBatch& out) {
+    // Nothing here moves: generated once when the room is entered, so no need to fork
+
     // Create an impossible staircase
     const int numSteps = 40;
     for (int i = 0; i < numSteps; i++) {
@@ -314,9 +369,7 @@ void RoomManager::renderEscherImpossibleArchitecture(Shader& shader, unsigned in
         model = glm::rotate(model, angle + 3.14159f * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
         model = glm::scale(model, glm::vec3(3.0f, 0.25f, 1.0f));
 
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
 
         // Create stair support
         model = glm::mat4(1.0f);
@@ -324,9 +377,7 @@ void RoomManager::renderEscherImpossibleArchitecture(Shader& shader, unsigned in
         model = glm::rotate(model, angle + 3.14159f * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
         model = glm::scale(model, glm::vec3(0.25f, 2.0f, 0.25f));
 
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
     }
 
     // Create an "impossible triangle" structure
@@ -352,15 +403,13 @@ void RoomManager::renderEscherImpossibleArchitecture(Shader& shader, unsigned in
                 glm::vec3(0.0f, 1.0f, 0.0f));
             model = glm::scale(model, glm::vec3(2.0f, 1.0f, 2.0f));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            out.solid.push_back(model);
         }
     }
 }
 
 // 3. Hyperbolic Space
-void RoomManager::renderHyperbolicSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
+void RoomManager::generateHyperbolicSpace(const Room& room, float time, InstanceBatch& out) {
     // In hyperbolic space, parallel lines diverge and there's exponentially more space 
     // as you move away from a point
 
@@ -369,7 +418,7 @@ void RoomManager::renderHyperbolicSpace(Shader& shader, unsigned int cubeVAO, co
     const int segmentsPerLine = 20;
     const float maxRadius = 50.0f;
 
-    for (int line = 0; line < radialLines; line++) {
+    parallelGenerate(jobSystem, radialLines, 1, out, [&](int line, InstanceBatch& local) {
         float angle = line * (2.0f * 3.14159f / radialLines);
 
         for (int seg = 0; seg < segmentsPerLine; seg++) {
@@ -392,16 +441,14 @@ void RoomManager::renderHyperbolicSpace(Shader& shader, unsigned int cubeVAO, co
                 glm::vec3(0.0f, 1.0f, 0.0f));
             model = glm::scale(model, glm::vec3(scale * 1.5f));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model);
         }
-    }
+    });
 
     // Create circular hoops that demonstrate the exponential nature of hyperbolic space
     const int numHoops = 8;
 
-    for (int h = 0; h < numHoops; h++) {
+    parallelGenerate(jobSystem, numHoops, 1, out, [&](int h, InstanceBatch& local) {
         float hoopRadius = 5.0f + h * 5.0f;
         int segmentsInHoop = 16 + h * 8; // More segments needed for larger hoops
 
@@ -422,109 +469,48 @@ void RoomManager::renderHyperbolicSpace(Shader& shader, unsigned int cubeVAO, co
             model = glm::rotate(model, angle + 3.14159f * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
             model = glm::scale(model, glm::vec3(scale * 1.0f, scale * 0.5f, scale * 2.0f));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model);
         }
-    }
+    });
 }
 
 // 4. Klein Bottle Space
-void RoomManager::renderKleinBottleSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
-    // Create a visual representation of a Klein bottle
-    // A Klein bottle is a surface that has no inside or outside
-
-    const int uSegments = 24;
-    const int vSegments = 12;
-    const float kleinRadius = 15.0f;
-    const float tubeRadius = 3.0f;
-
-    for (int u = 0; u < uSegments; u++) {
-        float uT = (float)u / uSegments;
-        float uAngle = uT * 2.0f * 3.14159f;
-
-        for (int v = 0; v < vSegments; v++) {
-            float vT = (float)v / vSegments;
-            float vAngle = vT * 2.0f * 3.14159f;
-
-            // Klein bottle parametric equations (simplified for visualization)
-            glm::vec3 pos;
-            if (uT < 0.5f) {
-                // First half (standard torus)
-                pos = room.spawnPosition + glm::vec3(
-                    (kleinRadius + tubeRadius * cos(vAngle)) * cos(uAngle),
-                    tubeRadius * sin(vAngle),
-                    (kleinRadius + tubeRadius * cos(vAngle)) * sin(uAngle)
-                );
-            }
-            else {
-                // Second half (bottle neck that passes through itself)
-                float newUT = (uT - 0.5f) * 2.0f; // Remap to 0-1
-                pos = room.spawnPosition + glm::vec3(
-                    (kleinRadius - tubeRadius * cos(vAngle)) * cos(uAngle),
-                    tubeRadius * sin(vAngle),
-                    (kleinRadius - tubeRadius * cos(vAngle)) * sin(uAngle)
-                );
-
-                // Apply twist based on v to create the self-intersection
-                if (vT > 0.25f && vT < 0.75f) {
-                    float twist = (vT - 0.25f) * 2.0f; // 0 to 1
-                    twist = sin(twist * 3.14159f);
-                    pos.x += twist * 5.0f * sin(time * 0.2f);
-                    pos.z -= twist * 5.0f * cos(time * 0.2f);
-                }
-            }
-
-            // Add time-based movement
-            pos.y += sin(uAngle * 3.0f + time * 0.5f) * 1.0f;
-
-            // Draw cube at point
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-            model = glm::rotate(model, uAngle, glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::rotate(model, vAngle, glm::vec3(1.0f, 0.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.5f));
-
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
+void RoomManager::generateKleinBottleSpace(const Room& room, float time, InstanceBatch& out) {
+    // The bottle itself is one mesh drawn by recordParametricSurface
 
     // Add special portal pairs that connect in a way that inverts orientation
-    for (int i = 0; i < 2; i++) {
+    parallelGenerate(jobSystem, 2, 1, out, [&](int i, InstanceBatch& local) {
         float angle = i * 3.14159f;
         glm::vec3 portalPos = room.spawnPosition + glm::vec3(cos(angle) * 25.0f, 0.0f, sin(angle) * 25.0f);
 
-        renderPortalFrame(shader, cubeVAO, portalPos, angle + 3.14159f, 6.0f, 10.0f, time);
-    }
+        generatePortalFrame(portalPos, angle + 3.14159f, 6.0f, 10.0f, time, local);
+    });
 }
 
 // 5. Recursive Scaling Environment
-void RoomManager::renderRecursiveScalingEnvironment(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
+void RoomManager::generateRecursiveScalingEnvironment(const Room& room, float time, InstanceBatch& out) {
     // Create nested structures of different scales
 
     // Central structure - series of nested cubes
+    GeometricSeries scale(10.0f, 0.8f);
+    PhaseSeries tilt(0.0f, 0.1f);
     for (int i = 0; i < 10; i++) {
-        float scale = 10.0f * pow(0.8f, i);
         float rotation = time * (0.1f + i * 0.05f);
 
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, room.spawnPosition);
-        model = glm::rotate(model, rotation, glm::vec3(sin(i * 0.1f), 1.0f, cos(i * 0.1f)));
-        model = glm::scale(model, glm::vec3(scale));
-
-        shader.setMat4("model", model);
+        model = glm::rotate(model, rotation, glm::vec3(tilt.sin(), 1.0f, tilt.cos()));
+        model = glm::scale(model, glm::vec3(scale.get()));
 
         // Use wireframe for better visualization of nesting
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        out.wireframe.push_back(model);
+
+        scale.advance();
+        tilt.advance();
     }
 
     // Create scale-recursion portals
-    for (int i = 0; i < 4; i++) {
+    parallelGenerate(jobSystem, 4, 1, out, [&](int i, InstanceBatch& local) {
         float angle = i * (2.0f * 3.14159f / 4.0f);
 
         // Each portal leads to a scaled version of the same space
@@ -535,7 +521,7 @@ void RoomManager::renderRecursiveScalingEnvironment(Shader& shader, unsigned int
         );
 
         // Create portal frame
-        renderPortalFrame(shader, cubeVAO, portalPos, angle + 3.14159f, 5.0f, 8.0f, time);
+        generatePortalFrame(portalPos, angle + 3.14159f, 5.0f, 8.0f, time, local);
 
         // Create a visual hint of what's through each portal by showing
         // a scaled preview structure
@@ -556,32 +542,34 @@ void RoomManager::renderRecursiveScalingEnvironment(Shader& shader, unsigned int
                 glm::vec3(0.0f, 1.0f, 0.0f));
             previewModel = glm::scale(previewModel, glm::vec3(subScale));
 
-            shader.setMat4("model", previewModel);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(previewModel);
         }
-    }
+    });
 }
 
 // 6. Quantum Superposition Space
-void RoomManager::renderQuantumSuperpositionSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
+void RoomManager::generateQuantumSuperpositionSpace(const Room& room, float time, InstanceBatch& out) {
     // Create objects that exist in multiple states simultaneously
 
     // Wave function visualization
     const int gridSize = 10;
     const float spacing = 5.0f;
 
-    for (int x = -gridSize; x <= gridSize; x++) {
-        for (int z = -gridSize; z <= gridSize; z++) {
+    parallelGenerate(jobSystem, 2 * gridSize + 1, 1, out, [&](int xIndex, InstanceBatch& local) {
+        int x = xIndex - gridSize;
+        PhaseSeries flicker(time * 2.0f + x * 0.1f - gridSize * 0.1f, 0.1f);
+        PhaseSeries axisTilt(-gridSize * 0.1f, 0.1f);
+
+        for (int z = -gridSize; z <= gridSize; z++, flicker.advance(), axisTilt.advance()) {
             float dist = sqrt(x * x + z * z);
             if (dist > gridSize) continue;
 
             // Wave function parameters
             float phase = dist * 0.5f - time * 1.0f;
-            float amplitude = sin(phase) * 0.5f + 0.5f;
+            float amplitude = fastSin(phase) * 0.5f + 0.5f;
 
             // Probability collapse - objects flicker in and out of existence
-            float existence = sin(time * 2.0f + x * 0.1f + z * 0.1f) * 0.5f + 0.5f;
+            float existence = flicker.sin() * 0.5f + 0.5f;
             float height = amplitude * 3.0f;
 
             // Skip rendering some cubes based on quantum probability
@@ -596,17 +584,15 @@ void RoomManager::renderQuantumSuperpositionSpace(Shader& shader, unsigned int c
             glm::mat4 model = glm::mat4(1.0f);
             model = glm::translate(model, pos);
             model = glm::rotate(model, time * existence,
-                glm::vec3(sin(x * 0.1f), cos(z * 0.1f), sin(time * 0.3f)));
+                glm::vec3(sin(x * 0.1f), axisTilt.cos(), sin(time * 0.3f)));
             model = glm::scale(model, glm::vec3(existence));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model);
         }
-    }
+    });
 
     // Entangled portals - pairs of portals that show quantum entanglement
-    for (int i = 0; i < 3; i++) {
+    parallelGenerate(jobSystem, 3, 1, out, [&](int i, InstanceBatch& local) {
         float angle1 = i * (2.0f * 3.14159f / 3.0f);
         float angle2 = angle1 + 3.14159f;
 
@@ -623,134 +609,35 @@ void RoomManager::renderQuantumSuperpositionSpace(Shader& shader, unsigned int c
         );
 
         // Render first portal
-        renderPortalFrame(shader, cubeVAO, portal1Pos, angle1 + 3.14159f, 5.0f, 8.0f, time);
-
-        // Render second portal (entangled)
-        renderPortalFrame(shader, cubeVAO, portal2Pos, angle2 + 3.14159f, 5.0f, 8.0f, time);
-
-        // Visualize entanglement with particle stream between portals
-        const int particleCount = 20;
-        for (int p = 0; p < particleCount; p++) {
-            float t = (float)p / particleCount;
-            float particlePhase = t + time * 0.5f;
-
-            // Particles follow a curved path between portals
-            float heightOffset = sin(particlePhase * 3.14159f) * 5.0f;
-            float radialOffset = sin(particlePhase * 3.14159f * 2.0f) * 3.0f;
+        generatePortalFrame(portal1Pos, angle1 + 3.14159f, 5.0f, 8.0f, time, local);
 
-            glm::vec3 particlePos = glm::mix(portal1Pos, portal2Pos, t);
-            particlePos.y += heightOffset;
-
-            // Add radial offset to particle path
-            glm::vec3 toCenter = glm::normalize(room.spawnPosition - particlePos);
-            glm::vec3 radialDir = glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), toCenter);
-            particlePos += radialDir * radialOffset;
-
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, particlePos);
-            model = glm::scale(model, glm::vec3(0.2f));
-
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
+        // Render second portal (entangled); the particle stream between them is an emitter
+        generatePortalFrame(portal2Pos, angle2 + 3.14159f, 5.0f, 8.0f, time, local);
+    });
 }
 
 // 7. Mbius Topology
-void RoomManager::renderMobiusTopology(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
-    // Create a Mbius strip structure
-    const int segmentsAround = 40;
-    const int segmentsAcross = 8;
-    const float mobiusRadius = 20.0f;
-    const float stripWidth = 4.0f;
-
-    for (int i = 0; i < segmentsAround; i++) {
-        float t = (float)i / segmentsAround;
-        float angle = t * 2.0f * 3.14159f;
-
-        for (int j = 0; j < segmentsAcross; j++) {
-            float s = (float)j / (segmentsAcross - 1) - 0.5f;
-
-            // Mbius strip parametric equations
-            float twistAngle = angle * 0.5f; // Half twist
-
-            glm::vec3 pos = room.spawnPosition + glm::vec3(
-                (mobiusRadius + s * stripWidth * cos(twistAngle)) * cos(angle),
-                s * stripWidth * sin(twistAngle) + sin(time * 0.2f + t * 5.0f) * 1.0f, // Add wave
-                (mobiusRadius + s * stripWidth * cos(twistAngle)) * sin(angle)
-            );
-
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-
-            // Orient cubes to follow the strip
-            glm::vec3 tangent = glm::normalize(glm::vec3(
-                -sin(angle),
-                0.0f,
-                cos(angle)
-            ));
-
-            glm::vec3 normal = glm::normalize(glm::vec3(
-                cos(angle) * sin(twistAngle),
-                cos(twistAngle),
-                sin(angle) * sin(twistAngle)
-            ));
-
-            glm::vec3 binormal = glm::cross(tangent, normal);
-
-            glm::mat4 rotation = glm::mat4(
-                glm::vec4(tangent, 0.0f),
-                glm::vec4(normal, 0.0f),
-                glm::vec4(binormal, 0.0f),
-                glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)
-            );
-
-            model = model * rotation;
-            model = glm::scale(model, glm::vec3(0.5f));
-
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
+void RoomManager::generateMobiusTopology(const Room& room, float time, InstanceBatch& out) {
+    // The strip itself is one mesh drawn by recordParametricSurface
 
     // Create portal pair with Mbius twist
     // When going through this portal, you come out flipped
     glm::vec3 portalPos = room.spawnPosition + glm::vec3(0.0f, 0.0f, -30.0f);
-    renderPortalFrame(shader, cubeVAO, portalPos, 0.0f, 6.0f, 10.0f, time);
-
-    // Visual indicator of the twist - particle stream that twists
-    const int particleCount = 50;
-    for (int p = 0; p < particleCount; p++) {
-        float t = (float)p / particleCount;
-        float particleAngle = t * 4.0f * 3.14159f + time * 0.5f;
-
-        glm::vec3 particlePos = portalPos + glm::vec3(
-            3.0f * cos(particleAngle),
-            3.0f * sin(particleAngle),
-            sin(time * 0.3f + t * 5.0f) * 2.0f
-        );
+    generatePortalFrame(portalPos, 0.0f, 6.0f, 10.0f, time, out);
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, particlePos);
-        model = glm::scale(model, glm::vec3(0.2f));
-
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-    }
+    // The twisting particle stream around it is an emitter (generateParticleEmitters)
 }
 
 // 8. Non-Commutative Rotation Space (continued)
-void RoomManager::renderNonCommutativeRotationSpace(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
+void RoomManager::generateNonCommutativeRotationSpace(const Room& room, float time, InstanceBatch& out) {
     // In this space, order of rotations matters - rotating X then Y is not the same as Y then X
 
     // Create grid of objects demonstrating rotational asymmetry
     const int gridSize = 5;
     const float spacing = 8.0f;
 
-    for (int x = -gridSize; x <= gridSize; x++) {
+    parallelGenerate(jobSystem, 2 * gridSize + 1, 1, out, [&](int xIndex, InstanceBatch& local) {
+        int x = xIndex - gridSize;
         for (int y = -gridSize; y <= gridSize; y++) {
             // Skip some grid positions to create more interesting patterns
             if ((x + y) % 3 == 0) continue;
@@ -772,9 +659,7 @@ void RoomManager::renderNonCommutativeRotationSpace(Shader& shader, unsigned int
             model1 = glm::rotate(model1, rotY, glm::vec3(0.0f, 1.0f, 0.0f));
             model1 = glm::scale(model1, glm::vec3(1.0f, 3.0f, 1.0f)); // Elongated to show orientation
 
-            shader.setMat4("model", model1);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model1);
 
             // Second rotation sequence: Y then X
             glm::mat4 model2 = glm::mat4(1.0f);
@@ -783,23 +668,19 @@ void RoomManager::renderNonCommutativeRotationSpace(Shader& shader, unsigned int
             model2 = glm::rotate(model2, rotX, glm::vec3(1.0f, 0.0f, 0.0f));
             model2 = glm::scale(model2, glm::vec3(1.0f, 3.0f, 1.0f));
 
-            shader.setMat4("model", model2);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model2);
 
             // Connection beam to show they're related
             glm::mat4 connector = glm::mat4(1.0f);
             connector = glm::translate(connector, basePos + glm::vec3(0.0f, 3.0f, 0.0f));
             connector = glm::scale(connector, glm::vec3(4.5f, 0.2f, 0.2f));
 
-            shader.setMat4("model", connector);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(connector);
         }
-    }
+    });
 
     // Create portals that apply different rotation sequences
-    for (int i = 0; i < 4; i++) {
+    parallelGenerate(jobSystem, 4, 1, out, [&](int i, InstanceBatch& local) {
         float angle = i * (2.0f * 3.14159f / 4.0f) + time * 0.1f;
 
         glm::vec3 portalPos = room.spawnPosition + glm::vec3(
@@ -809,7 +690,7 @@ void RoomManager::renderNonCommutativeRotationSpace(Shader& shader, unsigned int
         );
 
         // Create portal frame with rotation indicator
-        renderPortalFrame(shader, cubeVAO, portalPos, angle + 3.14159f, 5.0f, 8.0f, time);
+        generatePortalFrame(portalPos, angle + 3.14159f, 5.0f, 8.0f, time, local);
 
         // Add rotation indicators
         const int indicatorCount = 3;
@@ -828,51 +709,50 @@ void RoomManager::renderNonCommutativeRotationSpace(Shader& shader, unsigned int
                 glm::vec3(i % 2, (i + 1) % 2, (i + 2) % 2));
             model = glm::scale(model, glm::vec3(0.5f, 2.0f, 0.5f));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model);
         }
-    }
+    });
 }
 
 // 9. Infinite Regression Chamber
-void RoomManager::renderInfiniteRegressionChamber(Shader& shader, unsigned int cubeVAO, const Room& room, float time) {
+void RoomManager::generateInfiniteRegressionChamber(const Room& room, float time, InstanceBatch& out) {
     // Create an environment where structures repeat at different scales inward/outward
 
     // Create nested spheres of cubes, getting denser as they get smaller
     const int numLayers = 10;
 
-    for (int layer = 0; layer < numLayers; layer++) {
-        float scale = pow(0.7f, layer); // Each layer is 70% size of previous
+    parallelGenerate(jobSystem, numLayers, 1, out, [&](int layer, InstanceBatch& local) {
+        float scale = fastPow(0.7f, (float)layer); // Each layer is 70% size of previous
         float radius = 30.0f * scale;
 
         // More points for outer layers, fewer for inner
         int pointsInLayer = 150 * scale + 10;
 
-        for (int i = 0; i < pointsInLayer; i++) {
-            // Fibonacci sphere distribution for uniform points
-            float phi = 3.14159f * (3.0f - sqrt(5.0f)); // Golden angle
-            float y = 1.0f - (i / (float)(pointsInLayer - 1)) * 2.0f; // -1 to 1
-            float radiusAtY = sqrt(1.0f - y * y); // Radius at y position
+        // Add time-based animation - inner layers rotate faster. The layer rotation is
+        // the same for every point, so build it once.
+        float layerTime = time * (1.0f + layer * 0.5f);
+        float rotX = fastSin(layerTime * 0.3f) * 3.14159f;
+        float rotY = layerTime * 0.2f;
+        float rotZ = fastCos(layerTime * 0.4f) * 3.14159f;
 
-            float theta = phi * i; // Golden angle increment
+        glm::mat4 rotation = glm::mat4(1.0f);
+        rotation = glm::rotate(rotation, rotX, glm::vec3(1.0f, 0.0f, 0.0f));
+        rotation = glm::rotate(rotation, rotY, glm::vec3(0.0f, 1.0f, 0.0f));
+        rotation = glm::rotate(rotation, rotZ, glm::vec3(0.0f, 0.0f, 1.0f));
 
-            float x = cos(theta) * radiusAtY;
-            float z = sin(theta) * radiusAtY;
+        // Fibonacci sphere distribution for uniform points
+        float phi = 3.14159f * (3.0f - sqrt(5.0f)); // Golden angle
+        PhaseSeries theta(0.0f, phi); // Golden angle increment
 
-            // Add time-based animation - inner layers rotate faster
-            float layerTime = time * (1.0f + layer * 0.5f);
-            float rotX = sin(layerTime * 0.3f) * 3.14159f;
-            float rotY = layerTime * 0.2f;
-            float rotZ = cos(layerTime * 0.4f) * 3.14159f;
+        for (int i = 0; i < pointsInLayer; i++, theta.advance()) {
+            float y = 1.0f - (i / (float)(pointsInLayer - 1)) * 2.0f; // -1 to 1
+            float radiusAtY = sqrt(1.0f - y * y); // Radius at y position
+
+            float x = theta.cos() * radiusAtY;
+            float z = theta.sin() * radiusAtY;
 
             // Rotate the point
-            glm::vec4 rotatedPoint = glm::vec4(x, y, z, 1.0f);
-            glm::mat4 rotation = glm::mat4(1.0f);
-            rotation = glm::rotate(rotation, rotX, glm::vec3(1.0f, 0.0f, 0.0f));
-            rotation = glm::rotate(rotation, rotY, glm::vec3(0.0f, 1.0f, 0.0f));
-            rotation = glm::rotate(rotation, rotZ, glm::vec3(0.0f, 0.0f, 1.0f));
-            rotatedPoint = rotation * rotatedPoint;
+            glm::vec4 rotatedPoint = rotation * glm::vec4(x, y, z, 1.0f);
 
             glm::vec3 pos = room.spawnPosition + glm::vec3(
                 rotatedPoint.x * radius,
@@ -889,14 +769,12 @@ void RoomManager::renderInfiniteRegressionChamber(Shader& shader, unsigned int c
             float cubeScale = 0.3f * scale;
             model = glm::scale(model, glm::vec3(cubeScale));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model);
         }
-    }
+    });
 
     // Create recursion portals - visually these should appear to lead to smaller versions of the same space
-    for (int i = 0; i < 6; i++) {
+    parallelGenerate(jobSystem, 6, 1, out, [&](int i, InstanceBatch& local) {
         // Position at vertices of octahedron
         float theta = i < 4 ? (i * 3.14159f / 2.0f) : 0.0f;
         float phi = i < 4 ? 0.0f : (i == 4 ? 3.14159f / 2.0f : -3.14159f / 2.0f);
@@ -914,7 +792,7 @@ void RoomManager::renderInfiniteRegressionChamber(Shader& shader, unsigned int c
         float pitch = asin(direction.y);
 
         // Create portal frame with size suggesting recursion
-        renderPortalFrame(shader, cubeVAO, portalPos, angle, 5.0f, 8.0f, time);
+        generatePortalFrame(portalPos, angle, 5.0f, 8.0f, time, local);
 
         // Add visual hint of recursion through the portal
         for (int j = 0; j < 3; j++) {
@@ -928,16 +806,13 @@ void RoomManager::renderInfiniteRegressionChamber(Shader& shader, unsigned int c
             model = glm::rotate(model, time * (0.5f + j * 0.2f), direction);
             model = glm::scale(model, glm::vec3(previewScale));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            local.solid.push_back(model);
         }
-    }
+    });
 }
 
-void RoomManager::renderPortalFrame(Shader& shader, unsigned int cubeVAO,
-    glm::vec3 position, float angle,
-    float width, float height, float time) {
+void RoomManager::generatePortalFrame(glm::vec3 position, float angle,
+    float width, float height, float time, InstanceBatch& out) {
     // Create a portal frame with animation
     const int segments = 20;
     float thickness = 0.3f;
@@ -959,9 +834,7 @@ void RoomManager::renderPortalFrame(Shader& shader, unsigned int cubeVAO,
         topModel = glm::rotate(topModel, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         topModel = glm::scale(topModel, glm::vec3(thickness * topScale, thickness, thickness * topScale));
 
-        shader.setMat4("model", topModel);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(topModel);
 
         // Bottom frame piece
         glm::vec3 bottomPos = position + right * xOffset - up * (height / 2.0f);
@@ -972,9 +845,7 @@ void RoomManager::renderPortalFrame(Shader& shader, unsigned int cubeVAO,
         bottomModel = glm::rotate(bottomModel, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         bottomModel = glm::scale(bottomModel, glm::vec3(thickness * bottomScale, thickness, thickness * bottomScale));
 
-        shader.setMat4("model", bottomModel);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(bottomModel);
     }
 
     // Left and right segments
@@ -991,9 +862,7 @@ void RoomManager::renderPortalFrame(Shader& shader, unsigned int cubeVAO,
         leftModel = glm::rotate(leftModel, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         leftModel = glm::scale(leftModel, glm::vec3(thickness * leftScale, thickness, thickness * leftScale));
 
-        shader.setMat4("model", leftModel);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(leftModel);
 
         // Right frame piece
         glm::vec3 rightPos = position + right * (width / 2.0f) + up * yOffset;
@@ -1004,15 +873,13 @@ void RoomManager::renderPortalFrame(Shader& shader, unsigned int cubeVAO,
         rightModel = glm::rotate(rightModel, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         rightModel = glm::scale(rightModel, glm::vec3(thickness * rightScale, thickness, thickness * rightScale));
 
-        shader.setMat4("model", rightModel);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(rightModel);
     }
 }
 
 // Implementation of room-specific rendering functions
 
-void RoomManager::renderHyperbolicRoom(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateHyperbolicRoom(float time, InstanceBatch& out) {
     // Create a circular arrangement of pillars with hyperbolic distortion
     const int numPillars = 16;
     const float radius = 15.0f;
@@ -1038,9 +905,7 @@ void RoomManager::renderHyperbolicRoom(Shader& shader, unsigned int cubeVAO, flo
         model = glm::translate(model, basePos);
         model = glm::scale(model, glm::vec3(1.0f, heightDistortion, 1.0f));
 
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
 
         // Add connecting arches between pillars
         float nextAngle = (i + 1) % numPillars * (2.0f * 3.14159f / numPillars);
@@ -1067,8 +932,7 @@ void RoomManager::renderHyperbolicRoom(Shader& shader, unsigned int cubeVAO, flo
             model = glm::translate(model, archPos);
             model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            out.solid.push_back(model);
         }
     }
 
@@ -1077,11 +941,10 @@ void RoomManager::renderHyperbolicRoom(Shader& shader, unsigned int cubeVAO, flo
     model = glm::translate(model, room.spawnPosition + glm::vec3(0.0f, 5.0f, 0.0f));
     model = glm::scale(model, glm::vec3(3.0f, 3.0f, 3.0f));
     model = glm::rotate(model, time * 0.2f, glm::vec3(0.0f, 1.0f, 0.0f));
-    shader.setMat4("model", model);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    out.solid.push_back(model);
 }
 
-void RoomManager::renderImpossibleArchitecture(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateImpossibleArchitecture(float time, InstanceBatch& out) {
     // Get room properties
     const Room& room = rooms[2];
 
@@ -1105,9 +968,7 @@ void RoomManager::renderImpossibleArchitecture(Shader& shader, unsigned int cube
         model = glm::scale(model, glm::vec3(2.0f, 0.25f, 1.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
 
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
     }
 
     // Create walls that bend in impossible ways
@@ -1128,21 +989,19 @@ void RoomManager::renderImpossibleArchitecture(Shader& shader, unsigned int cube
         model = glm::scale(model, glm::vec3(3.0f, 5.0f, 0.2f));
         model = glm::rotate(model, angle + 3.14159f * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
 
-        shader.setMat4("model", model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
     }
 }
 
-void RoomManager::renderFractalSpace(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateFractalSpace(float time, InstanceBatch& out) {
     // Get room properties
     const Room& room = rooms[3];
 
     // Render a recursive structure
-    renderFractalCube(shader, cubeVAO, room.spawnPosition, 10.0f, 3, time);
+    generateFractalCube(room.spawnPosition, 10.0f, 3, time, out);
 }
 
-void RoomManager::renderFractalCube(Shader& shader, unsigned int cubeVAO,
-    glm::vec3 center, float size, int depth, float time) {
+void RoomManager::generateFractalCube(glm::vec3 center, float size, int depth, float time, InstanceBatch& out) {
     if (depth <= 0) return;
 
     // Render center cube
@@ -1152,9 +1011,7 @@ void RoomManager::renderFractalCube(Shader& shader, unsigned int cubeVAO,
     model = glm::rotate(model, time * (4 - depth) * 0.1f,
         glm::vec3(sin(time * 0.3f), cos(time * 0.2f), sin(time * 0.1f)));
 
-    shader.setMat4("model", model);
-    glBindVertexArray(cubeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    out.solid.push_back(model);
 
     // Recursively add smaller cubes at corners if depth > 1
     if (depth > 1) {
@@ -1177,14 +1034,14 @@ void RoomManager::renderFractalCube(Shader& shader, unsigned int cubeVAO,
             );
 
             // Recursively render smaller cube
-            renderFractalCube(shader, cubeVAO, newCenter, newSize * scaleFactor,
-                depth - 1, time);
+            generateFractalCube(newCenter, newSize * scaleFactor,
+                depth - 1, time, out);
         }
     }
 }
 
 // Implement the remaining room-specific rendering functions
-void RoomManager::renderKleinBottleSpace(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateKleinBottleSpace(float time, InstanceBatch& out) {
     const Room& room = rooms[4];
 
     // Create a Klein bottle-inspired space where paths loop back upon themselves
@@ -1232,9 +1089,7 @@ void RoomManager::renderKleinBottleSpace(Shader& shader, unsigned int cubeVAO, f
                 model = glm::translate(model, cubePos);
                 model = glm::scale(model, glm::vec3(0.5f + 0.2f * sin(time * 0.5f + t * 10.0f)));
 
-                shader.setMat4("model", model);
-                glBindVertexArray(cubeVAO);
-                glDrawArrays(GL_TRIANGLES, 0, 36);
+                out.solid.push_back(model);
             }
         }
         else {
@@ -1259,15 +1114,13 @@ void RoomManager::renderKleinBottleSpace(Shader& shader, unsigned int cubeVAO, f
                 model = glm::translate(model, cubePos);
                 model = glm::scale(model, glm::vec3(0.5f + 0.2f * sin(time * 0.5f + t * 10.0f)));
 
-                shader.setMat4("model", model);
-                glBindVertexArray(cubeVAO);
-                glDrawArrays(GL_TRIANGLES, 0, 36);
+                out.solid.push_back(model);
             }
         }
     }
 }
 
-void RoomManager::renderEscherPlayground(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateEscherPlayground(float time, InstanceBatch& out) {
     const Room& room = rooms[5];
 
     // Create an M.C. Escher-inspired space with impossible connections
@@ -1311,9 +1164,7 @@ void RoomManager::renderEscherPlayground(Shader& shader, unsigned int cubeVAO, f
         model = glm::translate(model, glm::vec3(x, y, z));
         model = glm::scale(model, glm::vec3(2.0f, 0.2f, 2.0f));
 
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
 
         // Add some flowing "water" particles
         float flowT = fmod(t + time * 0.1f, 1.0f);
@@ -1345,12 +1196,11 @@ void RoomManager::renderEscherPlayground(Shader& shader, unsigned int cubeVAO, f
         model = glm::translate(model, glm::vec3(flowX, flowY, flowZ));
         model = glm::scale(model, glm::vec3(0.3f));
 
-        shader.setMat4("model", model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
     }
 }
 
-void RoomManager::renderPsychedelicVortex(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generatePsychedelicVortex(float time, InstanceBatch& out) {
     const Room& room = rooms[6];
 
     // Create a spiraling vortex of cubes with intense color shifts
@@ -1385,9 +1235,7 @@ void RoomManager::renderPsychedelicVortex(Shader& shader, unsigned int cubeVAO,
                 glm::vec3(sin(time + t), cos(time * 0.7f), sin(time * 0.5f)));
             model = glm::scale(model, glm::vec3(scale));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            out.solid.push_back(model);
         }
     }
 
@@ -1397,11 +1245,10 @@ void RoomManager::renderPsychedelicVortex(Shader& shader, unsigned int cubeVAO,
     model = glm::rotate(model, time, glm::vec3(0.0f, 1.0f, 0.0f));
     model = glm::scale(model, glm::vec3(5.0f + sin(time * 2.0f) * 1.0f));
 
-    shader.setMat4("model", model);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    out.solid.push_back(model);
 }
 
-void RoomManager::renderRotatingHyperspace(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateRotatingHyperspace(float time, InstanceBatch& out) {
     const Room& room = rooms[7];
 
     // Create a 4D-inspired space with objects that seem to rotate through higher dimensions
@@ -1453,9 +1300,7 @@ void RoomManager::renderRotatingHyperspace(Shader& shader, unsigned int cubeVAO,
 
             model = glm::scale(model, scale);
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            out.solid.push_back(model);
         }
     }
 
@@ -1481,12 +1326,11 @@ void RoomManager::renderRotatingHyperspace(Shader& shader, unsigned int cubeVAO,
             glm::vec3(cos(i), sin(i), 0.5f));
         model = glm::scale(model, glm::vec3(1.5f * (0.7f + 0.3f * w)));
 
-        shader.setMat4("model", model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
     }
 }
 
-void RoomManager::renderSphericalGeometry(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateSphericalGeometry(float time, InstanceBatch& out) {
     const Room& room = rooms[8];
 
     // Create a spherical geometry space - where parallel lines converge
@@ -1530,9 +1374,7 @@ void RoomManager::renderSphericalGeometry(Shader& shader, unsigned int cubeVAO,
             model = model * rotationMatrix;
             model = glm::scale(model, glm::vec3(0.5f + 0.3f * sin(time + lat * 0.2f + lon * 0.1f)));
 
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            out.solid.push_back(model);
         }
     }
 
@@ -1558,13 +1400,12 @@ void RoomManager::renderSphericalGeometry(Shader& shader, unsigned int cubeVAO,
             model = glm::translate(model, greatCirclePos);
             model = glm::scale(model, glm::vec3(0.3f));
 
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            out.solid.push_back(model);
         }
     }
 }
 
-void RoomManager::renderInfiniteCorridor(Shader& shader, unsigned int cubeVAO, float time) {
+void RoomManager::generateInfiniteCorridor(float time, InstanceBatch& out) {
     const Room& room = rooms[9];
 
     // Create a corridor that appears to extend infinitely
@@ -1596,30 +1437,25 @@ void RoomManager::renderInfiniteCorridor(Shader& shader, unsigned int cubeVAO, f
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, segmentPos + glm::vec3(0.0f, -currentHeight / 2.0f, 0.0f));
         model = glm::scale(model, glm::vec3(currentWidth, 0.1f * distanceScale, segmentLength * distanceScale));
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
 
         // Ceiling
         model = glm::mat4(1.0f);
         model = glm::translate(model, segmentPos + glm::vec3(0.0f, currentHeight / 2.0f, 0.0f));
         model = glm::scale(model, glm::vec3(currentWidth, 0.1f * distanceScale, segmentLength * distanceScale));
-        shader.setMat4("model", model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
 
         // Left wall
         model = glm::mat4(1.0f);
         model = glm::translate(model, segmentPos + glm::vec3(-currentWidth / 2.0f, 0.0f, 0.0f));
         model = glm::scale(model, glm::vec3(0.1f * distanceScale, currentHeight, segmentLength * distanceScale));
-        shader.setMat4("model", model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
 
         // Right wall
         model = glm::mat4(1.0f);
         model = glm::translate(model, segmentPos + glm::vec3(currentWidth / 2.0f, 0.0f, 0.0f));
         model = glm::scale(model, glm::vec3(0.1f * distanceScale, currentHeight, segmentLength * distanceScale));
-        shader.setMat4("model", model);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        out.solid.push_back(model);
 
         // Add some decorative elements that highlight the infinite nature
         if (i % 2 == 0) {
@@ -1631,8 +1467,7 @@ void RoomManager::renderInfiniteCorridor(Shader& shader, unsigned int cubeVAO, f
             model = glm::translate(model, segmentPos + glm::vec3(0.0f, hoverHeight, 0.0f));
             model = glm::rotate(model, time + i * 0.2f, glm::vec3(0.3f, 1.0f, 0.7f));
             model = glm::scale(model, glm::vec3(cubeSize));
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            out.solid.push_back(model);
         }
     }
 
@@ -1641,8 +1476,154 @@ void RoomManager::renderInfiniteCorridor(Shader& shader, unsigned int cubeVAO, f
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, corridorStart + glm::vec3(0.0f, 0.0f, corridorSegments * segmentLength));
     model = glm::scale(model, glm::vec3(corridorWidth * 0.1f, corridorHeight * 0.1f, 0.1f));
-    shader.setMat4("model", model);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    out.solid.push_back(model);
+}
+
+void RoomManager::generateParticleEmitters(int roomIndex, float time, std::vector<ParticleEmitter>& out) {
+    const Room& room = rooms[roomIndex];
+    out.clear();
+
+    if (roomIndex == 6) {
+        // Entanglement streams between the portal pairs of generateQuantumSuperpositionSpace
+        for (int i = 0; i < 3; i++) {
+            float angle1 = i * (2.0f * 3.14159f / 3.0f);
+            float angle2 = angle1 + 3.14159f;
+            glm::vec3 portal1Pos = room.spawnPosition + glm::vec3(
+                cos(angle1) * 30.0f, sin(time * 0.3f + i) * 2.0f, sin(angle1) * 30.0f);
+            glm::vec3 portal2Pos = room.spawnPosition + glm::vec3(
+                cos(angle2) * 30.0f, sin(time * 0.3f + i + 3.14159f) * 2.0f, sin(angle2) * 30.0f);
+
+            ParticleEmitter stream = ParticleEmitter::stream(portal1Pos, portal2Pos, 40000);
+            stream.radius = 5.0f;  // Arc height
+            stream.sway = 3.0f;
+            stream.spread = 0.4f;
+            out.push_back(stream);
+        }
+    }
+    else if (roomIndex == 7) {
+        // The twisting stream around generateMobiusTopology's portal
+        glm::vec3 portalPos = room.spawnPosition + glm::vec3(0.0f, 0.0f, -30.0f);
+        ParticleEmitter twist = ParticleEmitter::orbit(portalPos, glm::vec3(0.0f, 0.0f, 1.0f), 3.0f, 80000);
+        twist.turns = 2.0f;
+        twist.angularSpeed = 0.5f;
+        twist.height = 2.0f;
+        twist.heightFrequency = glm::vec3(0.0f, 5.0f, 0.3f);
+        twist.spread = 0.15f;
+        out.push_back(twist);
+
+        // Orbiters on a wobbling, rising and falling ring around the spawn point
+        ParticleEmitter orbiters = ParticleEmitter::orbit(room.spawnPosition, glm::vec3(0.0f, 1.0f, 0.0f), 10.0f, 40000);
+        orbiters.sway = 0.5f;
+        orbiters.turns = 10.0f;
+        orbiters.angularSpeed = 0.1f;
+        orbiters.height = 10.0f;
+        orbiters.heightFrequency = glm::vec3(0.5f, 0.0f, 0.0f);
+        orbiters.size = 0.3f;
+        orbiters.spread = 1.0f;
+        orbiters.lifetime = 6.0f;
+        out.push_back(orbiters);
+    }
+}
+
+namespace {
+    // v_room_warping.glsl's vertex warp with its time terms at 0, its displacement scaled by
+    // the room's nonEuclideanIntensity. The shader applies it unscaled to each object's
+    // model-space vertices, so on screen it only bends every cube a little within itself;
+    // the camera reads it over world space instead, one strength per room.
+    glm::dvec3 roomWarp(const glm::dvec3& p, double intensity) {
+        if (p.y <= 0.0) return p;
+
+        double dist = std::sqrt(p.x * p.x + p.z * p.z);
+        glm::dvec3 position = p;
+        position.y += std::sin(dist * 0.5) * 0.1 * p.y;
+
+        double angle = dist * 0.1;
+        glm::dvec3 warped = position;
+        warped.x = position.x * std::cos(angle) - position.z * std::sin(angle) * 0.2;
+        warped.z = position.z * std::cos(angle) + position.x * std::sin(angle) * 0.2;
+        warped = glm::mix(position, warped, std::min(1.0, dist * 0.05));
+        return p + intensity * (warped - p);
+    }
+
+    // Eigenvectors (columns of vectors) and eigenvalues of a symmetric matrix, by cyclic
+    // Jacobi rotations
+    void symmetricEigen(glm::dmat3 m, glm::dmat3& vectors, glm::dvec3& values) {
+        vectors = glm::dmat3(1.0);
+        for (int sweep = 0; sweep < 16; sweep++) {
+            double offDiagonal = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+            if (offDiagonal < 1e-24) break;
+
+            for (int p = 0; p < 2; p++) {
+                for (int q = p + 1; q < 3; q++) {
+                    if (std::abs(m[p][q]) < 1e-30) continue;
+
+                    double theta = (m[q][q] - m[p][p]) / (2.0 * m[p][q]);
+                    double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                    double c = 1.0 / std::sqrt(t * t + 1.0), s = t * c;
+
+                    glm::dmat3 rotation(1.0);
+                    rotation[p][p] = c; rotation[q][q] = c;
+                    rotation[q][p] = s; rotation[p][q] = -s;
+                    m = glm::transpose(rotation) * m * rotation;
+                    vectors = vectors * rotation;
+                }
+            }
+        }
+        values = glm::dvec3(m[0][0], m[1][1], m[2][2]);
+    }
+
+    // Euclidean metric pulled back through the warp, g = J^T J. The shader's warp folds
+    // space over itself in places (J singular), where g would be degenerate and the
+    // symbols unbounded, so its stretch factors are clamped to [1/2, 2]
+    glm::dmat3 warpMetric(const glm::dvec3& p, double intensity) {
+        const double h = 1e-4;
+        glm::dmat3 jacobian;
+        for (int axis = 0; axis < 3; axis++) {
+            glm::dvec3 offset(0.0);
+            offset[axis] = h;
+            jacobian[axis] = (roomWarp(p + offset, intensity) - roomWarp(p - offset, intensity)) / (2.0 * h);
+        }
+
+        glm::dmat3 vectors;
+        glm::dvec3 values;
+        symmetricEigen(glm::transpose(jacobian) * jacobian, vectors, values);
+        values = glm::clamp(values, glm::dvec3(0.25), glm::dvec3(4.0));
+
+        glm::dmat3 scaled = vectors;
+        for (int axis = 0; axis < 3; axis++) scaled[axis] *= values[axis];
+        return scaled * glm::transpose(vectors);
+    }
+}
+
+const MetricField& RoomManager::getMetricField(int roomIndex) {
+    if (metricFields.size() < rooms.size()) metricFields.resize(rooms.size());
+
+    std::unique_ptr<MetricField>& field = metricFields[roomIndex];
+    if (!field) {
+        field.reset(new MetricField());
+
+        // Room 0 is drawn without the warp and stays flat (never baked)
+        if (roomIndex > 0) {
+            // The warp's model-space origin is placed on the room's spawn column with y = 0
+            // at the floor; 2 unit cells over 80 x 40 x 80 units
+            const Room& room = rooms[roomIndex];
+            glm::dvec3 center(room.spawnPosition.x, 0.0, room.spawnPosition.z);
+            double intensity = room.nonEuclideanIntensity;
+
+            MetricField::Settings settings;
+            settings.origin = glm::vec3(center) - glm::vec3(40.0f, 0.0f, 40.0f);
+            settings.extent = glm::vec3(80.0f, 40.0f, 80.0f);
+            settings.resolution = glm::ivec3(41, 21, 41);
+            field->bake(settings, [center, intensity](const glm::dvec3& position) {
+                return warpMetric(position - center, intensity);
+            }, jobSystem);
+        }
+    }
+    return *field;
+}
+
+void RoomManager::releaseMetricFields() {
+    metricFields.clear();
 }
 
 void RoomManager::setupRoomShader(Shader& shader, int roomIndex, float time) {
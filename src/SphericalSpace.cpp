@@ -0,0 +1,205 @@
+#include "spherical_space.h"
+#include "gl_state.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // A camera jump longer than this (world units) is a teleport, not a walk
+    const float TELEPORT_DISTANCE = 5.0f;
+
+    glm::vec4 toVec4(const glm::quat& q) {
+        return glm::vec4(q.x, q.y, q.z, q.w);
+    }
+
+    // Rotation of the sphere carrying (0, 0, 0, 1) by angle |displacement| towards displacement
+    glm::dmat4 sphereTranslation(const glm::dvec3& displacement) {
+        double d = glm::length(displacement);
+        if (d < 1e-12) return glm::dmat4(1.0);
+
+        glm::dvec3 n = displacement / d;
+        double c = std::cos(d), s = std::sin(d);
+        glm::dmat4 m(1.0);
+        for (int col = 0; col < 3; col++) {
+            for (int row = 0; row < 3; row++) m[col][row] += (c - 1.0) * n[row] * n[col];
+            m[col][3] = -s * n[col];
+            m[3][col] = s * n[col];
+        }
+        m[3][3] = c;
+        return m;
+    }
+
+    // Gram-Schmidt, starting from the position column
+    void orthonormalize(glm::dmat4& m) {
+        m[3] = glm::normalize(m[3]);
+        for (int col = 0; col < 3; col++) {
+            m[col] -= glm::dot(m[col], m[3]) * m[3];
+            for (int previous = 0; previous < col; previous++) {
+                m[col] -= glm::dot(m[col], m[previous]) * m[previous];
+            }
+            m[col] = glm::normalize(m[col]);
+        }
+    }
+}
+
+glm::mat4 sphereIsometry(const glm::quat& left, const glm::quat& right) {
+    // Columns are the images of i, j, k and 1
+    const glm::quat basis[4] = {
+        glm::quat(0.0f, 1.0f, 0.0f, 0.0f),
+        glm::quat(0.0f, 0.0f, 1.0f, 0.0f),
+        glm::quat(0.0f, 0.0f, 0.0f, 1.0f),
+        glm::quat(1.0f, 0.0f, 0.0f, 0.0f)
+    };
+    glm::mat4 m;
+    for (int col = 0; col < 4; col++) m[col] = toVec4(left * basis[col] * right);
+    return m;
+}
+
+SphericalCamera::SphericalCamera() : started(false), lastPosition(0.0f), player(1.0) {
+}
+
+void SphericalCamera::reset() {
+    started = false;
+}
+
+void SphericalCamera::update(const glm::vec3& worldPosition, float radius) {
+    glm::vec3 delta = worldPosition - lastPosition;
+    lastPosition = worldPosition;
+
+    if (!started || glm::length(delta) > TELEPORT_DISTANCE) {
+        player = glm::dmat4(1.0);
+        started = true;
+        return;
+    }
+
+    player = player * sphereTranslation(glm::dvec3(delta) / (double)radius);
+    orthonormalize(player);
+}
+
+glm::mat4 SphericalCamera::getView() const {
+    return glm::mat4(glm::transpose(player));
+}
+
+SphericalRenderer::Settings SphericalRenderer::defaultSettings() {
+    Settings settings;
+    settings.radius = 20.0f;
+    settings.fibreCount = 12;
+    settings.cubesPerFibre = 24;
+    return settings;
+}
+
+SphericalRenderer::SphericalRenderer()
+    : instanceBuffer(0), fibreVAO(0), latticeVAO(0), fibreInstances(0), latticeInstances(0) {
+    settings = defaultSettings();
+    cube.firstIndex = cube.indexCount = cube.baseVertex = cube.vertexCount = 0;
+}
+
+SphericalRenderer::~SphericalRenderer() {
+    glDeleteVertexArrays(1, &fibreVAO);
+    glDeleteVertexArrays(1, &latticeVAO);
+    glDeleteBuffers(1, &instanceBuffer);
+    glState().invalidate();
+}
+
+void SphericalRenderer::initialize(const Settings& newSettings, const MeshLibrary& meshes,
+    const MeshLibrary::Mesh& cubeMesh) {
+    settings = newSettings;
+    cube = cubeMesh;
+    std::vector<glm::mat4> instances;
+
+    // Hopf fibres over the icosahedron's vertices: the fibre over b is q_b e^(it), where q_b
+    // turns i into b
+    const float phi = 1.618034f;
+    const glm::vec3 basePoints[12] = {
+        glm::vec3(0.0f, 1.0f, phi), glm::vec3(0.0f, -1.0f, phi), glm::vec3(0.0f, 1.0f, -phi), glm::vec3(0.0f, -1.0f, -phi),
+        glm::vec3(1.0f, phi, 0.0f), glm::vec3(-1.0f, phi, 0.0f), glm::vec3(1.0f, -phi, 0.0f), glm::vec3(-1.0f, -phi, 0.0f),
+        glm::vec3(phi, 0.0f, 1.0f), glm::vec3(-phi, 0.0f, 1.0f), glm::vec3(phi, 0.0f, -1.0f), glm::vec3(-phi, 0.0f, -1.0f)
+    };
+    int fibres = std::max(0, std::min(settings.fibreCount, 12));
+    for (int f = 0; f < fibres; f++) {
+        glm::vec3 base = glm::normalize(basePoints[f]);
+        glm::vec3 axis = glm::normalize(glm::cross(glm::vec3(1.0f, 0.0f, 0.0f), base));
+        glm::quat toBase = glm::angleAxis(std::acos(base.x), axis);
+
+        for (int k = 0; k < settings.cubesPerFibre; k++) {
+            float t = 2.0f * 3.14159265f * k / settings.cubesPerFibre;
+            instances.push_back(sphereIsometry(toBase, glm::quat(std::cos(t), std::sin(t), 0.0f, 0.0f)));
+        }
+    }
+    fibreInstances = instances.size();
+
+    // 24-cell: the permutations of (+-1, +-1, 0, 0) / sqrt(2)
+    for (int a = 0; a < 4; a++) {
+        for (int b = a + 1; b < 4; b++) {
+            for (int signs = 0; signs < 4; signs++) {
+                glm::vec4 vertex(0.0f);
+                vertex[a] = (signs & 1) ? -0.70710678f : 0.70710678f;
+                vertex[b] = (signs & 2) ? -0.70710678f : 0.70710678f;
+                instances.push_back(sphereIsometry(glm::quat(vertex.w, vertex.x, vertex.y, vertex.z), glm::quat(1.0f, 0.0f, 0.0f, 0.0f)));
+            }
+        }
+    }
+    latticeInstances = instances.size() - fibreInstances;
+
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::mat4), instances.data(), GL_STATIC_DRAW);
+
+    // GL 4.1 has no base instance, so each group gets a VAO starting at its first matrix
+    fibreVAO = createVAO(meshes, 0);
+    latticeVAO = createVAO(meshes, fibreInstances * sizeof(glm::mat4));
+
+    glState().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+unsigned int SphericalRenderer::createVAO(const MeshLibrary& meshes, size_t base) const {
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    glState().bindVertexArray(VAO);
+    meshes.bindLayout();
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+            (void*)(base + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    return VAO;
+}
+
+void SphericalRenderer::record(const Shader& shader, const glm::mat4& cameraView, float time, CommandList& out) const {
+    if (fibreInstances + latticeInstances == 0) return;
+
+    out.setMat4(shader, "sphereView", cameraView);
+    out.setFloat(shader, "sphereRadius", settings.radius);
+
+    // Fibre cubes slide along their fibres at one world unit per second
+    float slide = time / settings.radius;
+    out.setMat4(shader, "sphereMotion", sphereIsometry(glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+        glm::quat(std::cos(slide), std::sin(slide), 0.0f, 0.0f)));
+    out.setMat4(shader, "model", glm::scale(glm::mat4(1.0f), glm::vec3(0.8f / settings.radius)));
+    for (int image = 0; image < 2; image++) {
+        out.setInt(shader, "antipodalImage", image);
+        out.drawIndexed(shader, fibreVAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex,
+            (GLsizei)fibreInstances);
+    }
+
+    // Lattice cubes spin in place: conjugation fixes (0, 0, 0, 1) and rotates around it
+    glm::quat spin = glm::angleAxis(time * 0.5f, glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)));
+    out.setMat4(shader, "sphereMotion", sphereIsometry(spin, glm::conjugate(spin)));
+    out.setMat4(shader, "model", glm::scale(glm::mat4(1.0f), glm::vec3(2.0f / settings.radius)));
+    for (int image = 0; image < 2; image++) {
+        out.setInt(shader, "antipodalImage", image);
+        out.drawIndexed(shader, latticeVAO, GL_TRIANGLES, cube.firstIndex, cube.indexCount, cube.baseVertex,
+            (GLsizei)latticeInstances);
+    }
+}
+
+void SphericalRenderer::reportStats() const {
+    std::cout << "Spherical space: " << fibreInstances << " fibre and " << latticeInstances
+        << " lattice instances, radius " << settings.radius << ", 4 instanced draws (2 images per group)"
+        << std::endl;
+}
@@ -0,0 +1,106 @@
+#include "stream_buffer.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::StreamBuffer() : buffer(0), regionSize(0), mapped(nullptr) {
+    resetStats();
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (GLsync fence : fences) {
+        if (fence) glDeleteSync(fence);
+    }
+    if (buffer) {
+        if (mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+void StreamBuffer::initialize(size_t size, int regionCount) {
+    regionSize = size;
+    fences.assign(regionCount, nullptr);
+
+    size_t totalSize = regionSize * regionCount;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    if (GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags));
+    }
+
+    if (!mapped) {
+        // Orphaning fallback; a failed persistent map leaves an immutable store behind,
+        // so start over with a fresh buffer name
+        if (GLEW_ARB_buffer_storage) {
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        }
+        glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        std::cout << "Stream buffer: ARB_buffer_storage unavailable, using buffer orphaning" << std::endl;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void* StreamBuffer::getRegionPointer(int region) const {
+    return mapped ? mapped + getRegionOffset(region) : nullptr;
+}
+
+void StreamBuffer::waitForRegion(int region) {
+    GLsync& fence = fences[region];
+    if (!fence) return;
+
+    stats.waits++;
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        // The GPU is still reading this region: block, flushing so the fence can signal
+        stats.stalls++;
+        auto start = std::chrono::high_resolution_clock::now();
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+        } while (result == GL_TIMEOUT_EXPIRED);
+        auto end = std::chrono::high_resolution_clock::now();
+        stats.stallMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::fenceRegion(int region) {
+    GLsync& fence = fences[region];
+    if (fence) glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+size_t StreamBuffer::upload(int region, const void* data, size_t bytes) {
+    if (bytes > regionSize) bytes = regionSize;
+    if (bytes == 0) return 0;
+    stats.uploads++;
+
+    if (mapped) {
+        std::memcpy(mapped + getRegionOffset(region), data, bytes);
+        return bytes;
+    }
+
+    // Orphan the old store (draws still in flight keep it alive) and fill the new one
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, regionSize * fences.size(), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, getRegionOffset(region), bytes, data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return bytes;
+}
+
+void StreamBuffer::resetStats() {
+    stats.waits = 0;
+    stats.stalls = 0;
+    stats.stallMilliseconds = 0.0;
+    stats.uploads = 0;
+}
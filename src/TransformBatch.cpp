@@ -0,0 +1,171 @@
+#include "transform_batch.h"
+#include "anim_math.h"
+#include "simd_ops.h"
+
+void TransformSoA::clear() {
+    posX.clear(); posY.clear(); posZ.clear();
+    rotX.clear(); rotY.clear(); rotZ.clear(); rotW.clear();
+    scaleX.clear(); scaleY.clear(); scaleZ.clear();
+}
+
+void TransformSoA::reserve(size_t count) {
+    posX.reserve(count); posY.reserve(count); posZ.reserve(count);
+    rotX.reserve(count); rotY.reserve(count); rotZ.reserve(count); rotW.reserve(count);
+    scaleX.reserve(count); scaleY.reserve(count); scaleZ.reserve(count);
+}
+
+void TransformSoA::push(const glm::vec3& position, float angle, const glm::vec3& axis, const glm::vec3& scale) {
+    posX.push_back(position.x); posY.push_back(position.y); posZ.push_back(position.z);
+    rotX.push_back(axis.x); rotY.push_back(axis.y); rotZ.push_back(axis.z); rotW.push_back(angle);
+    scaleX.push_back(scale.x); scaleY.push_back(scale.y); scaleZ.push_back(scale.z);
+}
+
+void TransformSoA::push(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    posX.push_back(position.x); posY.push_back(position.y); posZ.push_back(position.z);
+    rotX.push_back(rotation.x); rotY.push_back(rotation.y); rotZ.push_back(rotation.z); rotW.push_back(rotation.w);
+    scaleX.push_back(scale.x); scaleY.push_back(scale.y); scaleZ.push_back(scale.z);
+}
+
+namespace {
+    // Sines and cosines of every axis-angle rotation, precomputed in one vectorized pass
+    struct RotationTrig {
+        const float* sines;
+        const float* cosines;
+    };
+
+    // Rotation * scale block of LANES transforms, R[row][column] already scaled per column
+    template <typename Ops>
+    struct LinearBlock {
+        typename Ops::Vec m[3][3];
+    };
+
+    template <typename Ops>
+    void computeLinear(const TransformSoA& in, const RotationTrig& trig, size_t i, LinearBlock<Ops>& block) {
+        typedef typename Ops::Vec Vec;
+        const Vec one = Ops::set1(1.0f);
+        const Vec two = Ops::set1(2.0f);
+
+        Vec x = Ops::load(&in.rotX[i]);
+        Vec y = Ops::load(&in.rotY[i]);
+        Vec z = Ops::load(&in.rotZ[i]);
+
+        Vec r[3][3];
+        if (in.rotationFormat == ROTATION_AXIS_ANGLE) {
+            // Rodrigues' formula with the axis normalized, as glm::rotate does
+            Vec invLength = Ops::rsqrt(Ops::add(Ops::add(Ops::mul(x, x), Ops::mul(y, y)), Ops::mul(z, z)));
+            x = Ops::mul(x, invLength);
+            y = Ops::mul(y, invLength);
+            z = Ops::mul(z, invLength);
+
+            Vec c = Ops::load(trig.cosines + i);
+            Vec s = Ops::load(trig.sines + i);
+            Vec t = Ops::sub(one, c);
+
+            Vec tx = Ops::mul(t, x), ty = Ops::mul(t, y), tz = Ops::mul(t, z);
+            Vec sx = Ops::mul(s, x), sy = Ops::mul(s, y), sz = Ops::mul(s, z);
+            Vec txy = Ops::mul(tx, y), txz = Ops::mul(tx, z), tyz = Ops::mul(ty, z);
+
+            r[0][0] = Ops::add(Ops::mul(tx, x), c);
+            r[0][1] = Ops::sub(txy, sz);
+            r[0][2] = Ops::add(txz, sy);
+            r[1][0] = Ops::add(txy, sz);
+            r[1][1] = Ops::add(Ops::mul(ty, y), c);
+            r[1][2] = Ops::sub(tyz, sx);
+            r[2][0] = Ops::sub(txz, sy);
+            r[2][1] = Ops::add(tyz, sx);
+            r[2][2] = Ops::add(Ops::mul(tz, z), c);
+        }
+        else {
+            Vec w = Ops::load(&in.rotW[i]);
+            Vec xx = Ops::mul(x, x), yy = Ops::mul(y, y), zz = Ops::mul(z, z);
+            Vec xy = Ops::mul(x, y), xz = Ops::mul(x, z), yz = Ops::mul(y, z);
+            Vec wx = Ops::mul(w, x), wy = Ops::mul(w, y), wz = Ops::mul(w, z);
+
+            r[0][0] = Ops::sub(one, Ops::mul(two, Ops::add(yy, zz)));
+            r[0][1] = Ops::mul(two, Ops::sub(xy, wz));
+            r[0][2] = Ops::mul(two, Ops::add(xz, wy));
+            r[1][0] = Ops::mul(two, Ops::add(xy, wz));
+            r[1][1] = Ops::sub(one, Ops::mul(two, Ops::add(xx, zz)));
+            r[1][2] = Ops::mul(two, Ops::sub(yz, wx));
+            r[2][0] = Ops::mul(two, Ops::sub(xz, wy));
+            r[2][1] = Ops::mul(two, Ops::add(yz, wx));
+            r[2][2] = Ops::sub(one, Ops::mul(two, Ops::add(xx, yy)));
+        }
+
+        Vec scale[3] = { Ops::load(&in.scaleX[i]), Ops::load(&in.scaleY[i]), Ops::load(&in.scaleZ[i]) };
+        for (int row = 0; row < 3; row++) {
+            for (int column = 0; column < 3; column++) {
+                block.m[row][column] = Ops::mul(r[row][column], scale[column]);
+            }
+        }
+    }
+
+    template <typename Ops>
+    size_t buildPacked(const TransformSoA& in, const RotationTrig& trig, size_t begin, size_t end, PackedTransform* out) {
+        size_t i = begin;
+        for (; i + Ops::LANES <= end; i += Ops::LANES) {
+            LinearBlock<Ops> block;
+            computeLinear<Ops>(in, trig, i, block);
+
+            typename Ops::Vec position[3] = {
+                Ops::load(&in.posX[i]), Ops::load(&in.posY[i]), Ops::load(&in.posZ[i])
+            };
+            for (int row = 0; row < 3; row++) {
+                Ops::storeRows(block.m[row][0], block.m[row][1], block.m[row][2], position[row],
+                    out[i].rows[row], 12);
+            }
+        }
+        return i;
+    }
+
+    template <typename Ops>
+    size_t buildMat4(const TransformSoA& in, const RotationTrig& trig, size_t begin, size_t end, glm::mat4* out) {
+        const typename Ops::Vec zero = Ops::set1(0.0f);
+        const typename Ops::Vec one = Ops::set1(1.0f);
+
+        size_t i = begin;
+        for (; i + Ops::LANES <= end; i += Ops::LANES) {
+            LinearBlock<Ops> block;
+            computeLinear<Ops>(in, trig, i, block);
+
+            // glm is column-major: each stored group of four floats is one column
+            for (int column = 0; column < 3; column++) {
+                Ops::storeRows(block.m[0][column], block.m[1][column], block.m[2][column], zero,
+                    &out[i][column][0], 16);
+            }
+            Ops::storeRows(Ops::load(&in.posX[i]), Ops::load(&in.posY[i]), Ops::load(&in.posZ[i]), one,
+                &out[i][3][0], 16);
+        }
+        return i;
+    }
+
+    RotationTrig computeTrig(const TransformSoA& in) {
+        RotationTrig trig = { nullptr, nullptr };
+        if (in.rotationFormat != ROTATION_AXIS_ANGLE) return trig;
+
+        // Per-thread scratch so generator jobs can build batches concurrently
+        thread_local std::vector<float> sines;
+        thread_local std::vector<float> cosines;
+        sines.resize(in.size());
+        cosines.resize(in.size());
+        sinCosArray(in.rotW.data(), sines.data(), cosines.data(), in.size());
+
+        trig.sines = sines.data();
+        trig.cosines = cosines.data();
+        return trig;
+    }
+}
+
+void buildTransforms(const TransformSoA& in, PackedTransform* out) {
+    size_t count = in.size();
+    RotationTrig trig = computeTrig(in);
+    size_t done = buildPacked<SimdOps>(in, trig, 0, count, out);
+    buildPacked<ScalarOps>(in, trig, done, count, out);
+}
+
+void buildTransforms(const TransformSoA& in, glm::mat4* out) {
+    size_t count = in.size();
+    RotationTrig trig = computeTrig(in);
+    size_t done = buildMat4<SimdOps>(in, trig, 0, count, out);
+    buildMat4<ScalarOps>(in, trig, done, count, out);
+}
@@ -7,10 +7,37 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "camera.h"
 #include "shader.h"
 #include "portal.h"
 #include "room.h"
+#include "fractal_hierarchy.h"
+#include "mandelbulb_renderer.h"
+#include "mandelbulb_volume.h"
+#include "noise_volume.h"
+#include "gpu_timer.h"
+#include "job_system.h"
+#include "instancing.h"
+#include "isosurface_mesher.h"
+#include "hyperbolic_space.h"
+#include "spherical_space.h"
+#include "particle_system.h"
+#include "dev_space.h"
+#include "command_list.h"
+#include "instance_stream.h"
+#include "instance_culler.h"
+#include "mesh_library.h"
+#include "diagnostics.h"
+#include "frame_packet.h"
+#include "triple_buffer.h"
+#include "input_events.h"
+#include "fixed_step_clock.h"
+#include "frame_arena.h"
+#include "gl_state.h"
 
 // Window dimensions
 const unsigned int SCR_WIDTH = 1280;
@@ -27,30 +54,72 @@ float verticalVelocity = 0.0f;
 float jumpSpeed = 5.0f;
 float groundLevel = 0.0f; // Y position of the ground
 float nonEuclideanFactor = 1.0f; // Controls the strength of non-Euclidean effects
-
-// Timing
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
-
-// Player previous position (for portal crossing detection)
+bool meshMandelbulb = false; // Draw room 1's Mandelbulb as a triangle mesh instead of raymarching it
+bool usePrecomputedVolumes = true; // Sample baked noise and distance volumes instead of evaluating them per fragment
+bool hyperbolicGeometry = false; // Walk room 3 in the hyperboloid model instead of the shrinking-cube approximation
+bool sphericalGeometry = false; // Walk room 8 on the 3-sphere instead of its Euclidean content
+bool geodesicCamera = false; // Move along the geodesics of the room's warped metric instead of straight lines
+bool gpuInstanceCulling = true; // Frustum cull room instances on the GPU for every view before drawing them
+
+// Timing: movement, gravity and portal crossing advance in fixed 120 Hz steps; at most
+// 8 steps (about 66 ms) are simulated per frame
+FixedStepClock simulationClock(1.0f / 120.0f, 8);
+float deltaTime = simulationClock.stepSize();
+
+// Player position before the latest simulation step (for portal crossing detection and
+// render interpolation)
 glm::vec3 prevPosition(0.0f);
 
 // Room Manager managing rooms from 0 to 9
 RoomManager roomManager;
 
+// Worker threads for per-frame content generation
+JobSystem jobSystem;
+
+// Room 3's {p,q} tiling, built before the simulation starts and read-only afterwards, and
+// the player's place in it (simulation thread)
+const int HYPERBOLIC_ROOM = 3;
+HyperbolicTiling hyperbolicTiling;
+HyperbolicCamera hyperbolicCamera;
+
+// Room 8's place on the 3-sphere (simulation thread), at SphericalRenderer's default radius
+const int SPHERICAL_ROOM = 8;
+SphericalCamera sphericalCamera;
+
+// Diagnostics
+bool runBenchmark = false;
+std::atomic<bool> reportRenderStats(false); // Set by the simulation, consumed by the renderer
+
+// Threading: the main thread owns the window and the GL context and only renders; the
+// simulation thread owns the camera and world state and publishes one packet per frame
+InputQueue inputEvents;
+InputSender inputSender(inputEvents);
+TripleBuffer<FramePacket> framePackets;
+std::atomic<bool> simulationRunning(true);
+std::atomic<bool> quitRequested(false);
+
+// Lets the simulation work one frame ahead of the renderer without spinning
+std::mutex pacingMutex;
+std::condition_variable pacingCondition;
+unsigned long long lastAcquiredFrame = 0;
+
 // Function prototypes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow* window, std::vector<Portal*>& portals);
-unsigned int createCube(std::vector<float>& vertices);
-unsigned int createPlane(std::vector<float>& vertices, float size);
-void renderScene(const glm::mat4& view, const glm::mat4& projection, Shader& shader,
-    unsigned int planeVAO, unsigned int cubeVAO, const glm::vec3& portalAOffset,
-    const glm::vec3& portalBOffset, float time, bool applyNonEuclidean = true);
-void renderPortals(std::vector<Portal*>& portals, const glm::mat4& projection,
-    Shader& portalShader, Shader& devShader, unsigned int planeVAO,
-    unsigned int cubeVAO, float time);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void processInput(InputState& input);
+void stepSimulation(const InputState& input, std::vector<Portal*>& portals);
+void simulationLoop(std::vector<Portal*>* portals, const InstanceStream* instanceStream);
+void buildFramePacket(FramePacket& packet, const std::vector<Portal*>& portals, float time, float alpha);
+MeshLibrary::Mesh createCube(MeshLibrary& meshes);
+MeshLibrary::Mesh createPlane(MeshLibrary& meshes, float size);
+void recordScene(const FramePacket& frame, const Shader& shader, const Shader& devSpaceShader,
+    const DevSpace& devSpace, const MeshLibrary& meshes, const MeshLibrary::Mesh& plane,
+    const glm::vec3& portalAOffset, const glm::vec3& portalBOffset, CommandList& out);
+void buildViewLists(const FramePacket& frame, const CommandList& scene, std::vector<ViewCommandList>& viewLists);
+void renderPortals(const std::vector<Portal*>& portals, const FramePacket& frame,
+    const std::vector<ViewCommandList>& viewLists, InstanceCuller& culler);
 
 int main() {
     // Initialize GLFW
@@ -59,6 +128,8 @@ int main() {
         return -1;
     }
     roomManager.initializeRooms();
+    roomManager.setJobSystem(&jobSystem);
+    std::cout << "Job system: " << jobSystem.getThreadCount() << " threads" << std::endl;
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
@@ -80,6 +151,7 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
 
     // Capture mouse
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -94,9 +166,9 @@ int main() {
     }
 
     // Configure global OpenGL state
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glState().setDepthTest(true);
+    glState().setBlend(true);
+    glState().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Print OpenGL version information
     std::cout << "OpenGL version: " << glGetString(GL_VERSION) << std::endl;
@@ -105,7 +177,7 @@ int main() {
     std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
 
     // Set the initial viewport
-    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+    glState().viewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
 
 
 
@@ -114,14 +186,32 @@ int main() {
     Shader devShader("v_basic.glsl", "f_dev.glsl");
     Shader psychShader("v_warping.glsl", "f_psychedelic_dev.glsl");
     Shader roomPsychShader("v_room_warping.glsl", "f_room_psychedelic.glsl");
+    Shader devSpaceShader("v_dev_space.glsl", "f_psychedelic_dev.glsl");
+    Shader roomDevSpaceShader("v_dev_space.glsl", "f_room_psychedelic.glsl");
+    Shader roomInstancedShader("v_room_instanced.glsl", "f_room_psychedelic.glsl");
+    Shader roomFractalShader("v_fractal_hierarchy.glsl", "f_room_psychedelic.glsl");
+    Shader roomSurfaceShader("v_parametric_surface.glsl", "f_room_psychedelic.glsl");
+    Shader roomHyperbolicShader("v_hyperbolic.glsl", "f_room_psychedelic.glsl");
+    Shader roomSphericalShader("v_spherical.glsl", "f_room_psychedelic.glsl");
+    Shader roomParticleShader("v_particle.glsl", "f_room_psychedelic.glsl");
+    Shader roomCulledShader("v_room_culled.glsl", "g_room_culled.glsl", "f_room_psychedelic.glsl");
+    Shader particleUpdateShader("v_particle_update.glsl", std::vector<std::string>{ "outPositionAge", "outVelocitySeed" });
+    Shader instanceCullShader("v_instance_cull.glsl",
+        std::vector<std::string>{ "cullModel0", "cullModel1", "cullModel2", "cullModel3" },
+        "g_instance_cull.glsl");
+    Shader mandelbulbConeShader("v_fullscreen.glsl", "f_mandelbulb_cone.glsl");
+    Shader mandelbulbMarchShader("v_fullscreen.glsl", "f_mandelbulb_march.glsl");
+    Shader mandelbulbCompositeShader("v_fullscreen.glsl", "f_mandelbulb_composite.glsl");
     //Shader frameShader("v_basic.glsl", "f_portal_frame.glsl");
 
-    // Set up vertex data
-    std::vector<float> cubeVertices;
-    unsigned int cubeVAO = createCube(cubeVertices);
+    // Set up vertex data: all static meshes share the library's vertex and index buffers
+    MeshLibrary* meshLibrary = new MeshLibrary();
+    MeshLibrary::Mesh cubeMesh = createCube(*meshLibrary);
+    MeshLibrary::Mesh planeMesh = createPlane(*meshLibrary, 50.0f);
+    PortalGeometry* portalGeometry = new PortalGeometry(*meshLibrary);
 
-    std::vector<float> planeVertices;
-    unsigned int planeVAO = createPlane(planeVertices, 50.0f);
+    // Klein bottle and Mobius strip surfaces, tessellated for the default field of view
+    roomManager.buildSurfaces(*meshLibrary, 0.5f * SCR_HEIGHT / tan(glm::radians(ZOOM) * 0.5f));
 
     // Define the two non-Euclidean spaces
     glm::vec3 portalAOffset(0.0f, 0.0f, 0.0f);
@@ -137,7 +227,7 @@ int main() {
         glm::vec3(0.0f, 1.0f, 0.0f),                  // Up
         2.5f, 4.0f,                                    // Width, Height
         glm::vec4(0.0f, 0.4f, 0.8f, 0.7f),            // Blue edge color (more transparent)
-        SCR_WIDTH, SCR_HEIGHT,
+        *portalGeometry, SCR_WIDTH, SCR_HEIGHT,
         0.2f,                                          // Scale effect - dramatic shrinking (1/3 original size)
         glm::vec3(0.0f, glm::radians(5.0f), 0.0f)     // Slight Y-axis rotation
     );
@@ -149,7 +239,7 @@ int main() {
         glm::vec3(0.0f, 1.0f, 0.0f),                  // Up
         2.5f, 4.0f,                                    // Width, Height
         glm::vec4(1.0f, 0.5f, 0.0f, 0.7f),            // Orange edge color (more transparent)
-        SCR_WIDTH, SCR_HEIGHT,
+        *portalGeometry, SCR_WIDTH, SCR_HEIGHT,
         5.0f,                                          // Scale effect - dramatic enlarging (3x original size)
         glm::vec3(0.0f, glm::radians(-5.0f), 0.0f)    // Slight Y-axis rotation in opposite direction
     );
@@ -160,7 +250,7 @@ int main() {
         glm::vec3(0.0f, 1.0f, 0.0f),                  // Up
         2.5f, 4.0f,                                   // Width, Height
         glm::vec4(0.5f, 0.0f, 0.5f, 0.7f),           // Purple edge color
-        SCR_WIDTH, SCR_HEIGHT,
+        *portalGeometry, SCR_WIDTH, SCR_HEIGHT,
         1.0f,                                         // No scale change
         glm::vec3(glm::radians(90.0f), 0.0f, 0.0f)   // Dramatic 90-degree flip on X axis
     );
@@ -171,7 +261,7 @@ int main() {
         glm::vec3(0.0f, 1.0f, 0.0f),                 // Up
         2.5f, 4.0f,                                   // Width, Height
         glm::vec4(0.5f, 0.0f, 0.5f, 0.7f),           // Matching purple edge color
-        SCR_WIDTH, SCR_HEIGHT,
+        *portalGeometry, SCR_WIDTH, SCR_HEIGHT,
         1.0f,                                         // No scale change
         glm::vec3(0.0f, glm::radians(180.0f), 0.0f)  // 180-degree flip on Y axis (complete reversal)
     );
@@ -186,74 +276,174 @@ int main() {
     portals.push_back(portalC);
     portals.push_back(portalD);
 
+    // Static instance data for the development space objects, animated in the shader
+    DevSpace* devSpace = new DevSpace();
+    devSpace->initialize(*meshLibrary, cubeMesh, portalAOffset, portalBOffset);
+
+    // Room instances stream through a ring of buffer regions, one per frame in turn;
+    // generators on the simulation thread write each packet's matrices straight into its region
+    InstanceStream* instanceStream = new InstanceStream();
+    instanceStream->initialize(*meshLibrary, cubeMesh, FramePacket::INSTANCE_REGIONS);
+
+    // Room instances can instead be culled against each view on the GPU and drawn from the survivors
+    InstanceCuller* instanceCuller = new InstanceCuller();
+    instanceCuller->initialize(instanceCullShader);
+
+    // Instances of the current room that never change are uploaded once per room visit
+    StaticRoomContent staticContent;
+    int staticRoom = -1;
+
+    // Fractal topology is uploaded once; its transforms are composed on the GPU
+    FractalHierarchy* fractalHierarchy = new FractalHierarchy();
+    fractalHierarchy->initialize(*meshLibrary, cubeMesh, 7);
+
+    // Precomputed fbm for the room shaders; the analytic path stays as the high-quality option
+    NoiseVolume* noiseVolume = new NoiseVolume();
+    noiseVolume->initialize(NoiseVolume::defaultSettings(), &jobSystem);
+
+    // Baked Mandelbulb distance estimate around room 1, re-baked in the background as the
+    // power animates
+    MandelbulbVolume* mandelbulbVolume = new MandelbulbVolume();
+    mandelbulbVolume->initialize(MandelbulbVolume::defaultSettings(roomManager.getRoom(1).spawnPosition),
+        &jobSystem, 0.0f);
+
+    // Raymarched Mandelbulb composited over room 1's rasterized scene, marched at half the
+    // framebuffer's size (larger than the window on HiDPI displays)
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    MandelbulbRenderer* mandelbulbRenderer = new MandelbulbRenderer();
+    mandelbulbRenderer->initialize(MandelbulbRenderer::defaultSettings(roomManager.getRoom(1).spawnPosition),
+        framebufferWidth, framebufferHeight);
+
+    // The same bulb as triangles, extracted in the background and streamed in chunk by
+    // chunk into its own mesh arena. The field is mandelbulbDE(p * 0.1) at a fixed power
+    // of 8, in the unscaled units of p.
+    MeshLibrary* isosurfaceMeshes = new MeshLibrary();
+    IsosurfaceMesher* mandelbulbMesh = new IsosurfaceMesher();
+    {
+        IsosurfaceMesher::Settings settings;
+        settings.boxMin = glm::vec3(-15.0f);
+        settings.boxSize = 30.0f;
+        settings.resolution = 64;
+        settings.chunkCells = 16;
+        settings.isoLevel = 0.5f * settings.boxSize / settings.resolution;
+        settings.fieldKey = "mandelbulb power 8";
+        mandelbulbMesh->start(settings, [](const glm::vec3& origin, float spacing, int size, float* out) {
+            // bake() samples texel centres and returns distances in units of p * 0.1
+            MandelbulbVolume::bake(origin - glm::vec3(0.5f * spacing), spacing, size, 8.0f, 0, size, out);
+            for (size_t i = 0, count = (size_t)size * size * size; i < count; i++) out[i] *= 10.0f;
+        }, &jobSystem);
+    }
+
+    // Hyperbolic room: the tiling is cached once, the renderer draws the part around the camera
+    hyperbolicTiling.build(HyperbolicTiling::defaultSettings());
+    HyperbolicRenderer* hyperbolicRenderer = new HyperbolicRenderer();
+    hyperbolicRenderer->initialize(hyperbolicTiling, *meshLibrary, cubeMesh, FramePacket::INSTANCE_REGIONS);
+
+    // Spherical room: static SO(4) instances, animated by one rotation per group
+    SphericalRenderer* sphericalRenderer = new SphericalRenderer();
+    sphericalRenderer->initialize(SphericalRenderer::defaultSettings(), *meshLibrary, cubeMesh);
+
+    // Particle streams and orbiters, simulated on the GPU by transform feedback
+    ParticleSystem* particleSystem = new ParticleSystem();
+    particleSystem->initialize(ParticleSystem::defaultSettings(), *meshLibrary, cubeMesh,
+        particleUpdateShader, roomParticleShader);
+
+    // GPU time of each room's scene, per shading path: [room][0 = analytic, 1 = volumes]
+    GpuTimer sceneTimer;
+    double sceneMilliseconds[10][2] = {};
+    int sceneSamples[10][2] = {};
+
     // Store initial camera position for portal detection
     prevPosition = camera.Position;
 
+    // The scene is recorded once per frame and replayed for the main view and every portal
+    // view; viewLists[0] is the main view, viewLists[1 + i] the view through portal i
+    CommandList sceneCommands;
+    std::vector<ViewCommandList> viewLists;
+
+    // Simulation runs on its own thread from here on; this thread only polls events and renders
+    std::thread simulation(simulationLoop, &portals, instanceStream);
+
     // Render loop
-    while (!glfwWindowShouldClose(window)) {
-        // Calculate delta time
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+    while (!glfwWindowShouldClose(window) && !quitRequested.load()) {
+        glfwPollEvents();
+        inputSender.flush();
 
-        // Process input and check for portal crossing
-        processInput(window, portals);
+        // Pick up the newest packet; wait for events briefly if the simulation is still working
+        if (!framePackets.hasPublished()) {
+            glfwWaitEventsTimeout(0.001);
+            continue;
+        }
 
-        // Create projection matrix
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom),
-            (float)SCR_WIDTH / (float)SCR_HEIGHT,
-            0.1f, 100.0f);
+        framePackets.acquire();
+        const FramePacket& frame = framePackets.readSlot();
+        int region = frame.instanceRegion;
+        advanceFrame(FRAME_RENDER);
+
+        // Release the simulation to start on the next frame while this one is submitted. It
+        // writes that frame's instances into the next region of the ring, last drawn from
+        // INSTANCE_REGIONS - 1 frames ago: only that frame has to be finished on the GPU
+        instanceStream->waitForRegion(FramePacket::instanceRegionOf(frame.frameIndex + 1));
+        {
+            std::lock_guard<std::mutex> lock(pacingMutex);
+            lastAcquiredFrame = frame.frameIndex;
+        }
+        pacingCondition.notify_one();
 
-        // Check current room
-        int currentRoomIndex = roomManager.getCurrentRoomIndex();
+        // Upload isosurface chunks as they finish, in whichever room
+        mandelbulbMesh->update(*isosurfaceMeshes);
 
-        if (currentRoomIndex == 0) {
+        if (frame.roomIndex == 0) {
             // We're in the development space (Room 0) - use normal rendering path
+            sceneCommands.reset();
+            instanceCuller->clear();
+            recordScene(frame, psychShader, devSpaceShader, *devSpace, *meshLibrary, planeMesh,
+                portalAOffset, portalBOffset, sceneCommands);
+            buildViewLists(frame, sceneCommands, viewLists);
 
             // Render portals (with view from other side)
-            renderPortals(portals, projection, portalShader, psychShader, planeVAO, cubeVAO, currentFrame);
+            renderPortals(portals, frame, viewLists, *instanceCuller);
 
             // Clear main framebuffer
             glClearColor(0.03f, 0.03f, 0.05f, 1.0f);  // Very dark blue/purple background
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            // Get view matrix for main camera
-            glm::mat4 view = camera.GetViewMatrix();
-
             // Render the scene from main camera view
-            renderScene(view, projection, psychShader, planeVAO, cubeVAO, portalAOffset, portalBOffset, currentFrame, nonEuclideanFactor > 0.0f);
+            instanceCuller->cull(viewLists[0].getParams());
+            viewLists[0].execute();
 
             // Render portal surfaces with their textures
             portalShader.use();
-            portalShader.setMat4("projection", projection);
-            portalShader.setMat4("view", view);
-            portalShader.setVec3("viewPos", camera.Position);
-            portalShader.setFloat("time", currentFrame);
+            portalShader.setMat4("projection", frame.projection);
+            portalShader.setMat4("view", frame.view);
+            portalShader.setVec3("viewPos", frame.cameraPosition);
+            portalShader.setFloat("time", frame.time);
 
             for (const auto& portal : portals) {
                 // Set model matrix for this portal
-                glm::mat4 model = glm::mat4(1.0f);
-                portalShader.setMat4("model", model);
+                portalShader.setMat4("model", portal->getModelMatrix());
 
                 // Set portal edge color
                 portalShader.setVec4("edgeColor", portal->edgeColor);
 
                 // Bind the portal texture
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, portal->getTextureID());
+                glState().bindTexture2D(0, portal->getTextureID());
                 portalShader.setInt("portalTexture", 0);
 
                 // Render portal surface
-                glBindVertexArray(portal->getVAO());
-                glDrawArrays(GL_TRIANGLES, 0, portal->getVertexCount());
+                const MeshLibrary::Mesh& surface = portal->getSurfaceMesh();
+                glState().bindVertexArray(meshLibrary->getVAO());
+                glDrawElementsBaseVertex(GL_TRIANGLES, surface.indexCount, GL_UNSIGNED_SHORT,
+                    (void*)(surface.firstIndex * sizeof(GLushort)), surface.baseVertex);
 
                 // Render portal frame
                 //frameShader.use();
-                //frameShader.setMat4("projection", projection);
-                //frameShader.setMat4("view", view);
-                //frameShader.setVec3("viewPos", camera.Position);
-                //frameShader.setFloat("time", currentFrame);
-                //portal->renderPortalFrame(frameShader, currentFrame);
+                //frameShader.setMat4("projection", frame.projection);
+                //frameShader.setMat4("view", frame.view);
+                //frameShader.setVec3("viewPos", frame.cameraPosition);
+                //frameShader.setFloat("time", frame.time);
+                //portal->renderPortalFrame(frameShader, frame.time, *meshLibrary);
 
                 // Switch back to portal shader for next portal
                 portalShader.use();
@@ -262,12 +452,27 @@ int main() {
         else {
             // We're in a psychedelic room (1-9)
 
-            // Set up the psychedelic room shader
-            roomPsychShader.use();
-            roomManager.setupRoomShader(roomPsychShader, currentRoomIndex, currentFrame);
+            // Only the Mandelbulb room samples the distance volume; elsewhere it does not bake
+            if (frame.roomIndex == 1) mandelbulbVolume->update(frame.time);
+
+            // Set up every room program with the room's uniforms and volumes
+            Shader* roomShaders[] = {
+                &roomPsychShader, &roomDevSpaceShader, &roomInstancedShader, &roomFractalShader,
+                &roomSurfaceShader, &roomHyperbolicShader, &roomSphericalShader, &roomParticleShader,
+                &roomCulledShader
+            };
+            for (Shader* shader : roomShaders) {
+                shader->use();
+                roomManager.setupRoomShader(*shader, frame.roomIndex, frame.time);
+                noiseVolume->apply(*shader, frame.usePrecomputedVolumes);
+                mandelbulbVolume->apply(*shader, frame.usePrecomputedVolumes);
+            }
+
+            // Step the particles once per frame; every view draws the same state
+            particleSystem->update(particleUpdateShader, roomParticleShader, frame.particleEmitters, frame.time);
 
             // Set clear color based on room
-            const Room& currentRoom = roomManager.getRoom(currentRoomIndex);
+            const Room& currentRoom = roomManager.getRoom(frame.roomIndex);
             glClearColor(
                 currentRoom.ambientColor.r,
                 currentRoom.ambientColor.g,
@@ -276,41 +481,288 @@ int main() {
             );
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            // Get view matrix for main camera
-            glm::mat4 view = camera.GetViewMatrix();
+            if (frame.roomIndex != staticRoom) {
+                roomManager.generateStaticContent(frame.roomIndex, staticContent);
+                instanceStream->uploadStatic(staticContent);
+                staticRoom = frame.roomIndex;
+            }
 
             // Render using the psychedelic shader
-            renderScene(view, projection, roomPsychShader, planeVAO, cubeVAO,
-                portalAOffset, portalBOffset, currentFrame, true);
+            instanceStream->prepare(region, frame.roomContent);
+            sceneCommands.reset();
+            recordScene(frame, roomPsychShader, roomDevSpaceShader, *devSpace, *meshLibrary, planeMesh,
+                portalAOffset, portalBOffset, sceneCommands);
+            instanceCuller->clear();
+            if (frame.gpuInstanceCulling) {
+                instanceStream->addCullBatches(region, frame.roomContent, *instanceCuller);
+                instanceCuller->record(roomCulledShader, sceneCommands);
+            }
+            else {
+                roomManager.recordRoomSpecificContent(roomInstancedShader, *instanceStream, region,
+                    frame.roomContent, sceneCommands);
+            }
+            ViewParams mainView = { frame.view, frame.projection, frame.cameraPosition };
+            roomManager.recordFractalHierarchy(frame.roomIndex, roomFractalShader, *fractalHierarchy,
+                mainView, sceneCommands);
+            roomManager.recordParametricSurface(frame.roomIndex, roomSurfaceShader, *meshLibrary, sceneCommands);
+            if (frame.hyperbolicGeometry) {
+                // The tile isometries are written into the frame's region right away
+                hyperbolicRenderer->waitForRegion(region);
+                hyperbolicRenderer->record(region, roomHyperbolicShader, frame.hyperbolicView, frame.time,
+                    sceneCommands);
+            }
+            if (frame.sphericalGeometry) {
+                sphericalRenderer->record(roomSphericalShader, frame.sphericalView, frame.time, sceneCommands);
+            }
+            particleSystem->record(roomParticleShader, sceneCommands);
+            if (frame.roomIndex == 1 && frame.meshMandelbulb) {
+                const MandelbulbRenderer::Settings& bulb = mandelbulbRenderer->getSettings();
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), bulb.center);
+                model = glm::scale(model, glm::vec3(bulb.scale * 0.1f));
+                mandelbulbMesh->record(roomPsychShader, model, *isosurfaceMeshes, sceneCommands);
+            }
+            buildViewLists(frame, sceneCommands, viewLists);
+
+            sceneTimer.collect([&](int tag, double milliseconds) {
+                sceneMilliseconds[tag / 2][tag % 2] += milliseconds;
+                sceneSamples[tag / 2][tag % 2]++;
+            });
+            sceneTimer.begin(frame.roomIndex * 2 + (frame.usePrecomputedVolumes ? 1 : 0));
+            instanceCuller->cull(mainView);
+            viewLists[0].execute();
+            if (frame.roomIndex == 1 && !frame.meshMandelbulb) {
+                mandelbulbRenderer->render(mandelbulbConeShader, mandelbulbMarchShader, mandelbulbCompositeShader,
+                    mainView, frame.time);
+            }
+            sceneTimer.end();
         }
 
-        // Store current position for next frame's portal detection
-        prevPosition = camera.Position;
+        // The GPU reads this frame's instance and tile regions until the fence passes
+        instanceStream->fenceRegion(region);
+        hyperbolicRenderer->fenceRegion(region);
+
+        if (reportRenderStats.exchange(false)) {
+            instanceStream->reportStats();
+            reportFrameArenaStats();
+            for (int room = 1; room < 10; room++) {
+                if (sceneSamples[room][0] == 0 && sceneSamples[room][1] == 0) continue;
+
+                std::cout << "Room " << room << " scene GPU time:";
+                for (int path = 1; path >= 0; path--) {
+                    std::cout << (path ? " baked volumes " : ", analytic ");
+                    if (sceneSamples[room][path] > 0) {
+                        std::cout << sceneMilliseconds[room][path] / sceneSamples[room][path] << " ms";
+                    }
+                    else {
+                        std::cout << "-";
+                    }
+                }
+                std::cout << std::endl;
+            }
+            mandelbulbMesh->reportStats();
+            hyperbolicRenderer->reportStats();
+            sphericalRenderer->reportStats();
+            particleSystem->reportStats();
+            instanceCuller->reportStats();
+            std::cout << "Mandelbulb volume: " << mandelbulbVolume->getBakeCount() << " keyframes baked, "
+                << mandelbulbVolume->getLateFrames() << " frames waited for a bake" << std::endl;
+            std::cout << "Fractal hierarchy: " << fractalHierarchy->getDrawnNodeCount() << " of "
+                << fractalHierarchy->getNodeCount() << " nodes drawn (depth "
+                << fractalHierarchy->getDepth() << ")" << std::endl;
+            const GLStateCache::Counters& stateChanges = glState().getFrameCounters();
+            std::cout << "GL state changes last frame: " << stateChanges.issued << " issued, "
+                << stateChanges.filtered << " filtered as redundant, " << stateChanges.unitSwitches
+                << " texture unit switches" << std::endl;
+        }
+        glState().endFrame();
 
-        // Swap buffers and poll IO events
+        // Swap buffers
         glfwSwapBuffers(window);
-        glfwPollEvents();
     }
 
+    // Stop the simulation before tearing down what it reads
+    simulationRunning.store(false);
+    {
+        std::lock_guard<std::mutex> lock(pacingMutex);
+    }
+    pacingCondition.notify_one();
+    simulation.join();
+    roomManager.releaseMetricFields();
+
     // Clean up
     for (auto portal : portals) {
         delete portal;
     }
+    delete portalGeometry;
+    delete particleSystem;
+    delete instanceCuller;
+    delete sphericalRenderer;
+    delete hyperbolicRenderer;
+    delete mandelbulbMesh;
+    delete isosurfaceMeshes;
+    delete mandelbulbRenderer;
+    delete mandelbulbVolume;
+    delete noiseVolume;
+    delete fractalHierarchy;
+    delete devSpace;
+    delete instanceStream;
+    delete meshLibrary;
 
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &planeVAO);
     glfwTerminate();
     return 0;
 }
 
-// Process keyboard input and check for portal crossings
-void processInput(GLFWwindow* window, std::vector<Portal*>& portals) {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+// Simulation thread: input, movement, portal physics and content generation
+void simulationLoop(std::vector<Portal*>* portals, const InstanceStream* instanceStream) {
+    InputState input;
+    unsigned long long frameIndex = 0;
+
+    while (simulationRunning.load()) {
+        advanceFrame(FRAME_SIMULATION);
+
+        // Mouse look, toggles and teleports apply once per frame
+        processInput(input);
+
+        // Movement and portal crossing advance in fixed steps
+        float previousFactor = nonEuclideanFactor;
+        int steps = simulationClock.advance(glfwGetTime());
+        for (int step = 0; step < steps; step++) {
+            stepSimulation(input, *portals);
+        }
+        if (nonEuclideanFactor != previousFactor) {
+            std::cout << "Non-Euclidean Factor: " << nonEuclideanFactor << std::endl;
+        }
+
+        float currentFrame = simulationClock.interpolatedTime();
+        if (runBenchmark) {
+            runGenerationBenchmark(roomManager, currentFrame);
+            runTransformBenchmark();
+            runAnimMathBenchmark();
+            if (geodesicCamera) {
+                int roomIndex = roomManager.getCurrentRoomIndex();
+                roomManager.getMetricField(roomIndex).reportStats(roomIndex);
+            }
+            runBenchmark = false;
+        }
+
+        // The renderer waited for this frame's instance region before releasing us
+        FramePacket& packet = framePackets.writeSlot();
+        packet.frameIndex = ++frameIndex;
+        packet.instanceRegion = FramePacket::instanceRegionOf(packet.frameIndex);
+        instanceStream->bindBatch(packet.instanceRegion, packet.roomContent);
+        buildFramePacket(packet, *portals, currentFrame, simulationClock.alpha());
+        framePackets.publish();
+
+        // Stay at most one packet ahead: wait until the renderer has taken this one
+        std::unique_lock<std::mutex> lock(pacingMutex);
+        pacingCondition.wait(lock, [frameIndex]() {
+            return lastAcquiredFrame >= frameIndex || !simulationRunning.load();
+        });
+    }
+}
+
+// Capture camera, portal views and this frame's generated content for the renderer.
+// The camera position is interpolated between the last two simulation steps by alpha;
+// orientation follows the mouse directly and is not interpolated.
+void buildFramePacket(FramePacket& packet, const std::vector<Portal*>& portals, float time, float alpha) {
+    Camera renderCamera = camera;
+    renderCamera.Position = glm::mix(prevPosition, camera.Position, alpha);
+
+    packet.time = time;
+    packet.roomIndex = roomManager.getCurrentRoomIndex();
+    packet.cameraPosition = renderCamera.Position;
+    packet.view = renderCamera.GetViewMatrix();
+    packet.projection = glm::perspective(glm::radians(renderCamera.Zoom),
+        (float)SCR_WIDTH / (float)SCR_HEIGHT,
+        0.1f, 100.0f);
+
+    // The dev space animates on the GPU from these two values
+    packet.applyNonEuclidean = packet.roomIndex > 0 || nonEuclideanFactor > 0.0f;
+    packet.usePrecomputedVolumes = usePrecomputedVolumes;
+    packet.meshMandelbulb = meshMandelbulb;
+    packet.gpuInstanceCulling = gpuInstanceCulling;
+    packet.nonEuclideanFactor = nonEuclideanFactor;
+
+    // In hyperbolic mode the Euclidean camera's motion drives the player through the tiling
+    packet.hyperbolicGeometry = hyperbolicGeometry && packet.roomIndex == HYPERBOLIC_ROOM;
+    if (packet.hyperbolicGeometry) {
+        hyperbolicCamera.update(hyperbolicTiling, renderCamera.Position, groundLevel);
+        packet.hyperbolicView = hyperbolicCamera.getView();
+    }
+    else {
+        hyperbolicCamera.reset();
+    }
+
+    // Likewise on the 3-sphere
+    packet.sphericalGeometry = sphericalGeometry && packet.roomIndex == SPHERICAL_ROOM;
+    if (packet.sphericalGeometry) {
+        sphericalCamera.update(renderCamera.Position, SphericalRenderer::defaultSettings().radius);
+        packet.sphericalView = sphericalCamera.getView();
+    }
+    else {
+        sphericalCamera.reset();
+    }
+
+    // Generate this frame's room content once on the job system; every view reuses it
+    packet.roomContent.clear();
+    packet.particleEmitters.clear();
+    if (packet.roomIndex > 0 && !packet.hyperbolicGeometry && !packet.sphericalGeometry) {
+        roomManager.generateRoomContent(packet.roomIndex, time, packet.roomContent);
+        roomManager.generateParticleEmitters(packet.roomIndex, time, packet.particleEmitters);
+    }
+
+    // For each portal, the view from the perspective of standing at the linked portal
+    packet.portalViews.resize(portals.size());
+    for (size_t i = 0; i < portals.size(); i++) {
+        const Portal* portal = portals[i];
+        PortalViewPacket& portalView = packet.portalViews[i];
+
+        // Only render if portal is potentially visible from current viewpoint
+        portalView.visible = packet.roomIndex == 0 && portal->destination && portal->isVisible(renderCamera);
+        if (!portalView.visible) continue;
+
+        portalView.view = portal->getPortalView(renderCamera);
+        portalView.projection = portal->getPortalProjection(packet.projection);
+    }
+}
+
+// Apply queued input events, mode toggles and room teleports (once per frame)
+void processInput(InputState& input) {
+    // Apply everything the GLFW callbacks recorded since the last frame
+    InputEvent event;
+    while (inputEvents.pop(event)) {
+        if (event.type == InputEvent::KEY) {
+            input.apply(event);
+        }
+        else if (event.type == InputEvent::CURSOR) {
+            float xpos = static_cast<float>(event.x);
+            float ypos = static_cast<float>(event.y);
+
+            if (firstMouse) {
+                lastX = xpos;
+                lastY = ypos;
+                firstMouse = false;
+            }
+
+            float xoffset = xpos - lastX;
+            float yoffset = lastY - ypos; // Reversed since y-coordinates go from bottom to top
+
+            lastX = xpos;
+            lastY = ypos;
+
+            camera.ProcessMouseMovement(xoffset, yoffset);
+        }
+        else if (event.type == InputEvent::SCROLL) {
+            camera.ProcessMouseScroll(static_cast<float>(event.y));
+        }
+    }
+
+    if (input.isDown(GLFW_KEY_ESCAPE))
+        quitRequested.store(true);
 
     // Toggle flight mode when F key is pressed
     static bool fKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
+    if (input.isDown(GLFW_KEY_F)) {
         if (!fKeyPressed) {
             flightMode = !flightMode;
             verticalVelocity = 0.0f; // Reset vertical velocity when toggling
@@ -325,7 +777,7 @@ void processInput(GLFWwindow* window, std::vector<Portal*>& portals) {
     }
 
     static bool nKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS) {
+    if (input.isDown(GLFW_KEY_N)) {
         if (!nKeyPressed) {
             nonEuclideanFactor = nonEuclideanFactor > 0.0f ? 0.0f : 1.0f;
             nKeyPressed = true;
@@ -338,38 +790,112 @@ void processInput(GLFWwindow* window, std::vector<Portal*>& portals) {
         nKeyPressed = false;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-        nonEuclideanFactor += 0.05f;
-        nonEuclideanFactor = glm::min(nonEuclideanFactor, 2.0f);
-        std::cout << "Non-Euclidean Factor: " << nonEuclideanFactor << std::endl;
+    // Switch the room shaders between the baked volumes and analytic noise and distance with V
+    static bool vKeyPressed = false;
+    if (input.isDown(GLFW_KEY_V)) {
+        if (!vKeyPressed) {
+            usePrecomputedVolumes = !usePrecomputedVolumes;
+            vKeyPressed = true;
+
+            std::cout << "Noise and distance field: " << (usePrecomputedVolumes ? "baked volumes" : "analytic") << std::endl;
+        }
     }
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-        nonEuclideanFactor -= 0.05f;
-        nonEuclideanFactor = glm::max(nonEuclideanFactor, 0.0f);
-        std::cout << "Non-Euclidean Factor: " << nonEuclideanFactor << std::endl;
+    else {
+        vKeyPressed = false;
     }
 
-    // Store current position before movement
-    glm::vec3 preMovementPos = camera.Position;
+    // Switch room 1's Mandelbulb between raymarching and the extracted mesh with M
+    static bool mKeyPressed = false;
+    if (input.isDown(GLFW_KEY_M)) {
+        if (!mKeyPressed) {
+            meshMandelbulb = !meshMandelbulb;
+            mKeyPressed = true;
 
-    // Horizontal movement - same for both modes
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        camera.ProcessKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        camera.ProcessKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        camera.ProcessKeyboard(RIGHT, deltaTime);
+            std::cout << "Mandelbulb: " << (meshMandelbulb ? "triangle mesh" : "raymarched") << std::endl;
+        }
+    }
+    else {
+        mKeyPressed = false;
+    }
+
+    // Switch room 3 between the hyperbolic tiling and its Euclidean approximation with H
+    static bool hKeyPressed = false;
+    if (input.isDown(GLFW_KEY_H)) {
+        if (!hKeyPressed) {
+            hyperbolicGeometry = !hyperbolicGeometry;
+            hKeyPressed = true;
+
+            std::cout << "Room 3: " << (hyperbolicGeometry ? "hyperbolic tiling" : "Euclidean approximation") << std::endl;
+        }
+    }
+    else {
+        hKeyPressed = false;
+    }
+
+    // Switch room instances between GPU culling per view and drawing them all with K
+    static bool kKeyPressed = false;
+    if (input.isDown(GLFW_KEY_K)) {
+        if (!kKeyPressed) {
+            gpuInstanceCulling = !gpuInstanceCulling;
+            kKeyPressed = true;
+
+            std::cout << "Room instances: " << (gpuInstanceCulling ? "GPU culled per view" : "all drawn") << std::endl;
+        }
+    }
+    else {
+        kKeyPressed = false;
+    }
+
+    // Switch room 8 between the 3-sphere and its Euclidean content with G
+    static bool gKeyPressed = false;
+    if (input.isDown(GLFW_KEY_G)) {
+        if (!gKeyPressed) {
+            sphericalGeometry = !sphericalGeometry;
+            gKeyPressed = true;
+
+            std::cout << "Room 8: " << (sphericalGeometry ? "spherical space" : "Euclidean content") << std::endl;
+        }
+    }
+    else {
+        gKeyPressed = false;
+    }
+
+    // Switch between straight and geodesic movement through the rooms' warp with C
+    static bool cKeyPressed = false;
+    if (input.isDown(GLFW_KEY_C)) {
+        if (!cKeyPressed) {
+            geodesicCamera = !geodesicCamera;
+            cKeyPressed = true;
+
+            std::cout << "Camera: " << (geodesicCamera ? "geodesic" : "straight") << " movement" << std::endl;
+        }
+    }
+    else {
+        cKeyPressed = false;
+    }
+
+    // Run the generation, transform and math benchmarks and report render counters when B is pressed
+    static bool bKeyPressed = false;
+    if (input.isDown(GLFW_KEY_B)) {
+        if (!bKeyPressed) {
+            runBenchmark = true;
+            reportRenderStats.store(true);
+            bKeyPressed = true;
+        }
+    }
+    else {
+        bKeyPressed = false;
+    }
 
     for (int key = GLFW_KEY_0; key <= GLFW_KEY_9; key++) {
-        if (glfwGetKey(window, key) == GLFW_PRESS) {
+        if (input.isDown(key)) {
             static bool keyPressed[10] = { false };
             int roomIndex = key - GLFW_KEY_0;
 
             if (!keyPressed[roomIndex] && roomIndex < roomManager.getRoomCount()) {
                 roomManager.teleportToRoom(roomIndex, camera, nonEuclideanFactor,
                     flightMode, verticalVelocity);
+                prevPosition = camera.Position; // Don't interpolate across the teleport
                 keyPressed[roomIndex] = true;
             }
         }
@@ -383,15 +909,55 @@ void processInput(GLFWwindow* window, std::vector<Portal*>& portals) {
         }
     }
 
+}
+
+// Advance movement, gravity and portal crossing by one fixed step
+void stepSimulation(const InputState& input, std::vector<Portal*>& portals) {
+    // Non-Euclidean factor changes at 3 units per second (0.05 per frame at 60 FPS)
+    if (input.isDown(GLFW_KEY_UP)) {
+        nonEuclideanFactor += 3.0f * deltaTime;
+        nonEuclideanFactor = glm::min(nonEuclideanFactor, 2.0f);
+    }
+    if (input.isDown(GLFW_KEY_DOWN)) {
+        nonEuclideanFactor -= 3.0f * deltaTime;
+        nonEuclideanFactor = glm::max(nonEuclideanFactor, 0.0f);
+    }
+
+    // Store current position before movement
+    glm::vec3 preMovementPos = camera.Position;
+    prevPosition = camera.Position;
+
+    // Horizontal movement - same for both modes
+    if (input.isDown(GLFW_KEY_W))
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (input.isDown(GLFW_KEY_S))
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (input.isDown(GLFW_KEY_A))
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (input.isDown(GLFW_KEY_D))
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
     // Vertical movement (depends on mode)
     if (flightMode) {
         // Flight mode - direct control
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+        if (input.isDown(GLFW_KEY_SPACE))
             camera.ProcessKeyboard(UP, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
+        if (input.isDown(GLFW_KEY_LEFT_CONTROL))
             camera.ProcessKeyboard(DOWN, deltaTime);
     }
-    else {
+
+    // Geodesic camera: replay the key movement as a step through the room's metric, which
+    // bends the path and turns the view with it. Gravity stays Euclidean.
+    glm::vec3 keyMovement = camera.Position - preMovementPos;
+    if (geodesicCamera && glm::dot(keyMovement, keyMovement) > 0.0f) {
+        const MetricField& metric = roomManager.getMetricField(roomManager.getCurrentRoomIndex());
+        glm::vec3 front = camera.Front;
+        camera.Position = preMovementPos;
+        metric.step(camera.Position, front, keyMovement);
+        camera.SetFront(front);
+    }
+
+    if (!flightMode) {
         // Walking mode - gravity and jumping
 
         // Apply gravity
@@ -406,7 +972,7 @@ void processInput(GLFWwindow* window, std::vector<Portal*>& portals) {
             verticalVelocity = 0.0f;
 
             // Jump when on ground
-            if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
+            if (input.isDown(GLFW_KEY_SPACE)) {
                 verticalVelocity = jumpSpeed;
             }
         }
@@ -418,47 +984,37 @@ void processInput(GLFWwindow* window, std::vector<Portal*>& portals) {
             // Transform camera through the portal
             portal->transformCamera(camera);
 
-            // Update prevPosition to avoid repeated teleportations
+            // Snap the interpolation start so the render doesn't sweep across the jump
             prevPosition = camera.Position;
-            break; // Only cross one portal per frame
+            break; // Only cross one portal per step
         }
     }
 }
 
 // Handle window resize
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
+    glState().viewport(0, 0, width, height);
 }
 
 // Mouse movement callback
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
-    float xpos = static_cast<float>(xposIn);
-    float ypos = static_cast<float>(yposIn);
-
-    if (firstMouse) {
-        lastX = xpos;
-        lastY = ypos;
-        firstMouse = false;
-    }
-
-    float xoffset = xpos - lastX;
-    float yoffset = lastY - ypos; // Reversed since y-coordinates go from bottom to top
-
-    lastX = xpos;
-    lastY = ypos;
-
-    camera.ProcessMouseMovement(xoffset, yoffset);
+    inputSender.cursor(xposIn, yposIn);
 }
 
 // Mouse scroll callback
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+    inputSender.scroll(xoffset, yoffset);
+}
+
+// Keyboard callback
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    inputSender.key(key, action);
 }
 
 // Create a cube with normals and texture coordinates
-unsigned int createCube(std::vector<float>& vertices) {
+MeshLibrary::Mesh createCube(MeshLibrary& meshes) {
     // Define cube vertices (position, normal, tex coords)
-    vertices = {
+    std::vector<float> vertices = {
         // positions          // normals           // texture coords
         // Front face
         -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f, 0.0f,
@@ -509,36 +1065,16 @@ unsigned int createCube(std::vector<float>& vertices) {
          -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
     };
 
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Texture coord attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    return VAO;
+    // Shared corners of each face collapse to 24 indexed vertices
+    return meshes.add(vertices);
 }
 
 // Create a ground plane
-unsigned int createPlane(std::vector<float>& vertices, float size) {
+MeshLibrary::Mesh createPlane(MeshLibrary& meshes, float size) {
     float halfSize = size / 2.0f;
 
     // Define plane vertices (position, normal, tex coords)
-    vertices = {
+    std::vector<float> vertices = {
         // positions            // normals           // texture coords
         -halfSize, 0.0f, -halfSize,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f,
          halfSize, 0.0f, -halfSize,  0.0f, 1.0f, 0.0f,  size, 0.0f,
@@ -549,333 +1085,75 @@ unsigned int createPlane(std::vector<float>& vertices, float size) {
         -halfSize, 0.0f, -halfSize,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f
     };
 
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Texture coord attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    return VAO;
-}
-
-glm::vec3 applyNonEuclideanTransformation(const glm::vec3& position, float time) {
-    // Distance from origin in xz plane
-    float dist = glm::length(glm::vec2(position.x, position.z));
-
-    // Base position
-    glm::vec3 newPos = position;
-
-    // 1. Space expansion/contraction: spaces become larger/smaller than they appear
-    // Areas far from origin are compressed, areas near origin are expanded
-    if (dist > 5.0f) {
-        float compressionFactor = 1.0f - 0.1f * nonEuclideanFactor * (dist - 5.0f) / 10.0f;
-        compressionFactor = glm::max(compressionFactor, 0.5f); // Limit compression
-
-        // Apply compression to distance from origin
-        glm::vec2 dirXZ = glm::normalize(glm::vec2(position.x, position.z));
-        newPos.x = dirXZ.x * dist * compressionFactor;
-        newPos.z = dirXZ.y * dist * compressionFactor;
-    }
-
-    // 2. Impossible spaces: inside is larger than outside
-    // Create subtle spatial distortions that intensify with distance
-    float warpFactor = sin(dist * 0.2f + time * 0.3f) * 0.2f * nonEuclideanFactor;
-    newPos.y += warpFactor * position.y;
-
-    // 3. Non-Euclidean corridors: turning right 4 times doesn't bring you back to start
-    // Apply subtle rotation to create a hyperbolic-like space
-    float angle = atan2(position.z, position.x);
-    float rotAmount = sin(angle * 4.0f + time * 0.1f) * 0.05f * nonEuclideanFactor;
-    float rotatedX = position.x * cos(rotAmount) - position.z * sin(rotAmount);
-    float rotatedZ = position.x * sin(rotAmount) + position.z * cos(rotAmount);
-    newPos.x = glm::mix(newPos.x, rotatedX, 0.5f);
-    newPos.z = glm::mix(newPos.z, rotatedZ, 0.5f);
-
-    return newPos;
+    return meshes.add(vertices);
 }
 
-// Render the scene with two distinct areas
-void renderScene(const glm::mat4& view, const glm::mat4& projection, Shader& shader,
-    unsigned int planeVAO, unsigned int cubeVAO, const glm::vec3& portalAOffset,
-    const glm::vec3& portalBOffset, float time, bool applyNonEuclidean) {
+// Record the scene with two distinct areas; only view and projection differ between views
+void recordScene(const FramePacket& frame, const Shader& shader, const Shader& devSpaceShader,
+    const DevSpace& devSpace, const MeshLibrary& meshes, const MeshLibrary::Mesh& plane,
+    const glm::vec3& portalAOffset, const glm::vec3& portalBOffset, CommandList& out) {
 
-    shader.use();
-    shader.setMat4("projection", projection);
-    shader.setMat4("view", view);
-    shader.setVec3("viewPos", camera.Position);
-    shader.setFloat("time", time);
+    out.setFloat(shader, "time", frame.time);
 
     // Render ground plane in area A - no non-Euclidean effect on ground for stability
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, portalAOffset);
-    shader.setMat4("model", model);
-    glBindVertexArray(planeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    out.setMat4(shader, "model", model);
+    out.setDepthCenter(portalAOffset);
+    out.drawIndexed(shader, meshes.getVAO(), GL_TRIANGLES, plane.firstIndex, plane.indexCount, plane.baseVertex);
 
     // Render ground plane in area B
     model = glm::mat4(1.0f);
     model = glm::translate(model, portalBOffset);
-    shader.setMat4("model", model);
-    glBindVertexArray(planeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    // Render cubes in area A with non-Euclidean transformations
-    for (int i = -2; i <= 2; i++) {
-        for (int j = -2; j <= 2; j++) {
-            if (i == 0 && j == 0) continue; // Skip center
-
-            glm::vec3 basePos = portalAOffset + glm::vec3(i * 2.0f, 0.5f, j * 2.0f);
-            glm::vec3 transformedPos = basePos;
-
-            if (applyNonEuclidean) {
-                // Apply non-Euclidean transformation to object position
-                transformedPos = applyNonEuclideanTransformation(basePos, time);
-            }
-
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, transformedPos);
+    out.setMat4(shader, "model", model);
+    out.setDepthCenter(portalBOffset);
+    out.drawIndexed(shader, meshes.getVAO(), GL_TRIANGLES, plane.firstIndex, plane.indexCount, plane.baseVertex);
 
-            // Add some rotation based on position for more dynamic effect
-            if (applyNonEuclidean) {
-                float rotAngle = sin(time * 0.5f + i * 0.7f + j * 0.5f) * 20.0f * nonEuclideanFactor;
-                model = glm::rotate(model, glm::radians(rotAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-            }
-
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
-
-    // Render cubes in area B - apply different non-Euclidean transformations
-    for (int i = -2; i <= 2; i++) {
-        for (int j = -2; j <= 2; j++) {
-            if (i == 0 && j == 0) continue; // Skip center
-
-            glm::vec3 basePos = portalBOffset + glm::vec3(i * 2.0f, 0.5f, j * 2.0f);
-            glm::vec3 transformedPos = basePos;
-
-            if (applyNonEuclidean) {
-                // Apply a different non-Euclidean transformation to create contrast
-                float dist = glm::length(glm::vec2(basePos.x - portalBOffset.x, basePos.z - portalBOffset.z));
-
-                // Spiral distortion
-                float angle = atan2(basePos.z - portalBOffset.z, basePos.x - portalBOffset.x);
-                angle += sin(dist * 0.5f) * 0.3f * nonEuclideanFactor;
-                float newX = dist * cos(angle);
-                float newZ = dist * sin(angle);
-
-                transformedPos.x = portalBOffset.x + newX;
-                transformedPos.z = portalBOffset.z + newZ;
-
-                // Height distortion
-                transformedPos.y += sin(dist * 0.8f + time * 0.6f) * 0.4f * nonEuclideanFactor;
-            }
+    // Development space objects: one instanced draw, animated in the vertex shader
+    devSpace.record(devSpaceShader, frame.nonEuclideanFactor, frame.applyNonEuclidean, frame.time, out);
+}
 
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, transformedPos);
+// Resolve the recorded scene for the main view and every visible portal view in parallel
+void buildViewLists(const FramePacket& frame, const CommandList& scene, std::vector<ViewCommandList>& viewLists) {
+    viewLists.resize(frame.portalViews.size() + 1);
 
-            // Add some distortion to the cubes themselves
-            if (applyNonEuclidean) {
-                float scaleX = 1.0f + sin(time * 0.3f + i * 0.6f) * 0.2f * nonEuclideanFactor;
-                float scaleY = 1.0f + cos(time * 0.4f + j * 0.5f) * 0.2f * nonEuclideanFactor;
-                float scaleZ = 1.0f + sin(time * 0.5f + (i + j) * 0.4f) * 0.2f * nonEuclideanFactor;
-                model = glm::scale(model, glm::vec3(scaleX, scaleY, scaleZ));
+    jobSystem.parallelFor(0, (int)viewLists.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            ViewParams params;
+            params.viewPos = frame.cameraPosition; // Portal views are lit from the player's position too
 
-                float rotAngle = cos(time * 0.4f + i * 0.5f + j * 0.3f) * 30.0f * nonEuclideanFactor;
-                model = glm::rotate(model, glm::radians(rotAngle), glm::vec3(0.0f, 1.0f, 0.0f));
+            if (i == 0) {
+                params.view = frame.view;
+                params.projection = frame.projection;
             }
-
-            shader.setMat4("model", model);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
-
-    // Add some walls in area A with non-Euclidean bend
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, portalAOffset + glm::vec3(0.0f, 2.0f, -10.0f));
-
-    if (applyNonEuclidean) {
-        // Create a curved wall that should be straight in Euclidean space
-        for (int i = -10; i <= 10; i++) {
-            float x = i * 1.0f;
-
-            // Calculate curved wall position
-            float z = -10.0f;
-            float bend = sin(x * 0.2f + time * 0.2f) * 2.0f * nonEuclideanFactor;
-
-            glm::mat4 wallSection = glm::mat4(1.0f);
-            wallSection = glm::translate(wallSection, portalAOffset + glm::vec3(x, 2.0f, z + bend));
-
-            // Rotate to follow curve
-            float rotAngle = cos(x * 0.2f + time * 0.2f) * 15.0f * nonEuclideanFactor;
-            wallSection = glm::rotate(wallSection, glm::radians(rotAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-
-            wallSection = glm::scale(wallSection, glm::vec3(1.0f, 4.0f, 0.2f));
-            shader.setMat4("model", wallSection);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
-    else {
-        // Straight wall if non-Euclidean effects are disabled
-        model = glm::scale(model, glm::vec3(20.0f, 4.0f, 0.2f));
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-    }
-
-    // Add some walls in area B with different non-Euclidean properties
-    if (applyNonEuclidean) {
-        // Create a wall that seems to fold into itself (impossible in Euclidean space)
-        for (int i = -10; i <= 10; i++) {
-            float x = i * 1.0f;
-
-            // Create a wall that folds into the 4th dimension (visually)
-            float z = 10.0f;
-            float fold = sin(x * 0.3f + time * 0.3f) * 3.0f * nonEuclideanFactor;
-            float yOffset = cos(x * 0.3f + time * 0.15f) * 1.0f * nonEuclideanFactor;
-
-            glm::mat4 wallSection = glm::mat4(1.0f);
-            wallSection = glm::translate(wallSection, portalBOffset + glm::vec3(x, 2.0f + yOffset, z - fold));
-
-            // Create twisting effect
-            float twistAngle = sin(x * 0.2f + time * 0.25f) * 40.0f * nonEuclideanFactor;
-            wallSection = glm::rotate(wallSection, glm::radians(twistAngle), glm::vec3(0.0f, 0.0f, 1.0f));
-
-            // Vary the scale to enhance the non-Euclidean feel
-            float scaleY = 4.0f + sin(x * 0.4f + time * 0.2f) * 1.0f * nonEuclideanFactor;
-            wallSection = glm::scale(wallSection, glm::vec3(1.0f, scaleY, 0.2f));
-
-            shader.setMat4("model", wallSection);
-            glBindVertexArray(cubeVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
-    }
-    else {
-        // Straight wall if non-Euclidean effects are disabled
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, portalBOffset + glm::vec3(0.0f, 2.0f, 10.0f));
-        model = glm::scale(model, glm::vec3(20.0f, 4.0f, 0.2f));
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-    }
-
-    // Add floating objects with non-Euclidean movement patterns
-    float currentTime = time;
-    for (int i = 0; i < 10; i++) {
-        // Base values
-        float angle = i * (2.0f * 3.14159f / 10.0f) + currentTime * 0.2f;
-        float radius = 8.0f + sin(currentTime * 0.5f + i * 0.5f) * 2.0f;
-        float height = 2.0f + sin(currentTime * 0.3f + i * 0.4f) * 1.5f;
-
-        // Area A floating object
-        glm::vec3 basePos = portalAOffset + glm::vec3(sin(angle) * radius, height, cos(angle) * radius);
-        glm::vec3 transformedPos = basePos;
-
-        if (applyNonEuclidean) {
-            // Apply non-Euclidean transformation to orbit
-            // This makes objects follow impossible trajectories
-            float distortion = sin(i * 0.7f + currentTime * 0.4f) * nonEuclideanFactor;
-            float distortedAngle = angle + distortion;
-
-            // Klein bottle-inspired trajectory (objects seem to pass through themselves)
-            if (distortedAngle > 3.14159f && distortedAngle < 2.0f * 3.14159f) {
-                radius *= (1.0f - (distortedAngle - 3.14159f) / 3.14159f * 0.5f * nonEuclideanFactor);
+            else {
+                const PortalViewPacket& portalView = frame.portalViews[i - 1];
+                if (!portalView.visible) continue;
+                params.view = portalView.view;
+                params.projection = portalView.projection;
             }
 
-            transformedPos = portalAOffset + glm::vec3(
-                sin(distortedAngle) * radius,
-                height * (1.0f + cos(distortedAngle * 2.0f) * 0.3f * nonEuclideanFactor),
-                cos(distortedAngle) * radius
-            );
+            viewLists[i].build(scene, params);
         }
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, transformedPos);
-        model = glm::rotate(model, currentTime + i,
-            glm::vec3(sin(i * 0.5f), cos(i * 0.3f), sin(i * 0.7f)));
-        float scale = 0.5f + sin(currentTime * 0.6f + i) * 0.2f;
-        model = glm::scale(model, glm::vec3(scale));
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        // Area B floating object with different non-Euclidean patterns
-        basePos = portalBOffset + glm::vec3(sin(angle + 3.14159f) * radius, height * 1.2f, cos(angle + 3.14159f) * radius);
-        transformedPos = basePos;
-
-        if (applyNonEuclidean) {
-            // Create hyperbolic-inspired orbits
-            float loopFactor = sin(currentTime * 0.3f + i * 0.5f) * nonEuclideanFactor;
-
-            // This creates figure-8 patterns that shouldn't be possible in normal space
-            transformedPos = portalBOffset + glm::vec3(
-                sin(angle * 2.0f) * radius * (0.5f + 0.5f * cos(angle)),
-                height * (1.0f + sin(angle * 3.0f) * 0.4f * nonEuclideanFactor),
-                cos(angle) * radius * (1.0f + loopFactor * sin(angle * 2.0f))
-            );
-        }
-
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, transformedPos);
-        model = glm::rotate(model, currentTime * 0.8f + i,
-            glm::vec3(cos(i * 0.4f), sin(i * 0.6f), cos(i * 0.5f)));
-        scale = 0.6f + cos(currentTime * 0.5f + i) * 0.2f;
-        model = glm::scale(model, glm::vec3(scale));
-        shader.setMat4("model", model);
-        glBindVertexArray(cubeVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-    }
-    int currentRoom = roomManager.getCurrentRoomIndex();
-    if (currentRoom > 0) {
-        roomManager.renderRoomSpecificContent(currentRoom, shader, cubeVAO, time);
-    }
+    });
 }
 
 // Render what's visible through each portal
-void renderPortals(std::vector<Portal*>& portals, const glm::mat4& projection,
-    Shader& portalShader, Shader& sceneShader, unsigned int planeVAO,
-    unsigned int cubeVAO, float time) {
-
-    // For each portal, render the scene from the perspective of standing at the linked portal
-    for (const auto& portal : portals) {
-        if (!portal->destination) continue;
+void renderPortals(const std::vector<Portal*>& portals, const FramePacket& frame,
+    const std::vector<ViewCommandList>& viewLists, InstanceCuller& culler) {
 
-        // Only render if portal is potentially visible from current viewpoint
-        if (!portal->isVisible(camera)) continue;
+    // Views were computed by the simulation; portals it found invisible are skipped
+    for (size_t i = 0; i < portals.size(); i++) {
+        if (!frame.portalViews[i].visible) continue;
 
         // Begin rendering to this portal's framebuffer
-        portal->beginPortalRender();
-
-        // Calculate the view matrix as if looking through the portal
-        glm::mat4 portalView = portal->getPortalView(camera);
-
-        // Get potentially adjusted projection matrix for the portal view
-        glm::mat4 portalProjection = portal->getPortalProjection(projection);
+        portals[i]->beginPortalRender();
 
-        // Render the scene from the portal's perspective
-        renderScene(portalView, portalProjection, sceneShader, planeVAO, cubeVAO,
-            glm::vec3(0.0f), glm::vec3(20.0f, 0.0f, 0.0f), time, nonEuclideanFactor > 0.0f);
+        // Replay the scene from the portal's perspective, with the instances it can see
+        culler.cull(viewLists[i + 1].getParams());
+        viewLists[i + 1].execute();
 
         // End rendering to portal framebuffer
-        portal->endPortalRender();
+        portals[i]->endPortalRender();
     }
 }